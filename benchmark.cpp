@@ -11,6 +11,7 @@
 #include <shared_mutex>
 #include <atomic>
 #include <numeric>
+#include <sstream>
 
 #include "tktrie.h"
 
@@ -204,6 +205,86 @@ BenchRow bench_notfound_st(const std::vector<uint64_t>& keys, const std::vector<
     return r;
 }
 
+// find_batch in groups of 64 keys; MAP/UMAP find them one at a time
+BenchRow bench_find_batch_st(const std::vector<uint64_t>& keys) {
+    static constexpr size_t GROUP = 64;
+    BenchRow r;
+    
+    int64_trie<int> trie;
+    std::map<uint64_t, int> m;
+    std::unordered_map<uint64_t, int> um;
+    um.reserve(keys.size());
+    
+    for (auto k : keys) {
+        trie.insert({static_cast<int64_t>(k), static_cast<int>(k)});
+        m.insert({k, static_cast<int>(k)});
+        um.insert({k, static_cast<int>(k)});
+    }
+    std::vector<int64_t> tkeys(keys.begin(), keys.end());
+    std::vector<std::optional<int>> out(GROUP);
+    
+    volatile size_t cnt = 0;
+    r.tktrie = time_op_ns([&]() {
+        size_t c = 0;
+        for (size_t i = 0; i < tkeys.size(); i += GROUP) {
+            size_t n = std::min(GROUP, tkeys.size() - i);
+            c += trie.find_batch(std::span<const int64_t>(tkeys.data() + i, n), out);
+        }
+        cnt = c;
+    }, keys.size());
+    
+    r.map = time_op_ns([&]() {
+        size_t c = 0;
+        for (auto k : keys) c += (m.find(k) != m.end());
+        cnt = c;
+    }, keys.size());
+    
+    r.umap = time_op_ns([&]() {
+        size_t c = 0;
+        for (auto k : keys) c += (um.find(k) != um.end());
+        cnt = c;
+    }, keys.size());
+    
+    return r;
+}
+
+// Full in-order scan (UMAP: unordered); times are ns per element visited
+BenchRow bench_scan_st(const std::vector<uint64_t>& keys) {
+    BenchRow r;
+    
+    int64_trie<int> trie;
+    std::map<uint64_t, int> m;
+    std::unordered_map<uint64_t, int> um;
+    um.reserve(keys.size());
+    
+    for (auto k : keys) {
+        trie.insert({static_cast<int64_t>(k), static_cast<int>(k)});
+        m.insert({k, static_cast<int>(k)});
+        um.insert({k, static_cast<int>(k)});
+    }
+    
+    volatile size_t cnt = 0;
+    r.tktrie = time_op_ns([&]() {
+        size_t c = 0;
+        for (auto it = trie.begin(); it != trie.end(); ++it) c += it.value();
+        cnt = c;
+    }, keys.size());
+    
+    r.map = time_op_ns([&]() {
+        size_t c = 0;
+        for (const auto& kv : m) c += kv.second;
+        cnt = c;
+    }, keys.size());
+    
+    r.umap = time_op_ns([&]() {
+        size_t c = 0;
+        for (const auto& kv : um) c += kv.second;
+        cnt = c;
+    }, keys.size());
+    
+    return r;
+}
+
 BenchRow bench_insert_st(const std::vector<uint64_t>& keys) {
     BenchRow r;
     
@@ -230,6 +311,79 @@ BenchRow bench_insert_st(const std::vector<uint64_t>& keys) {
     return r;
 }
 
+// insert_batch in groups of 64 pairs; MAP/UMAP insert them one at a time
+BenchRow bench_insert_batch_st(const std::vector<uint64_t>& keys) {
+    static constexpr size_t GROUP = 64;
+    BenchRow r;
+    std::vector<std::pair<int64_t, int>> tkv;
+    for (auto k : keys) tkv.emplace_back(static_cast<int64_t>(k), static_cast<int>(k));
+    
+    {
+        int64_trie<int> trie;
+        r.tktrie = time_op_ns([&]() {
+            for (size_t i = 0; i < tkv.size(); i += GROUP) {
+                size_t n = std::min(GROUP, tkv.size() - i);
+                trie.insert_batch(std::span<const std::pair<int64_t, int>>(tkv.data() + i, n));
+            }
+        }, keys.size());
+    }
+    {
+        std::map<uint64_t, int> m;
+        r.map = time_op_ns([&]() {
+            for (auto k : keys) m.insert({k, static_cast<int>(k)});
+        }, keys.size());
+    }
+    {
+        std::unordered_map<uint64_t, int> um;
+        um.reserve(keys.size());
+        r.umap = time_op_ns([&]() {
+            for (auto k : keys) um.insert({k, static_cast<int>(k)});
+        }, keys.size());
+    }
+    
+    return r;
+}
+
+// Loading an empty container from unsorted pairs in one call
+BenchRow bench_bulk_load_st(const std::vector<uint64_t>& keys) {
+    BenchRow r;
+    std::vector<std::pair<int64_t, int>> tkv;
+    std::vector<std::pair<uint64_t, int>> kv;
+    for (auto k : keys) {
+        tkv.emplace_back(static_cast<int64_t>(k), static_cast<int>(k));
+        kv.emplace_back(k, static_cast<int>(k));
+    }
+    
+    {
+        int64_trie<int> trie;
+        r.tktrie = time_op_ns([&]() { trie.bulk_insert(tkv.begin(), tkv.end()); }, keys.size());
+    }
+    {
+        std::map<uint64_t, int> m;
+        r.map = time_op_ns([&]() { m.insert(kv.begin(), kv.end()); }, keys.size());
+    }
+    {
+        std::unordered_map<uint64_t, int> um;
+        r.umap = time_op_ns([&]() { um.insert(kv.begin(), kv.end()); }, keys.size());
+    }
+    
+    return r;
+}
+
+// Loading an empty container from a saved trie; map/umap as BULK LOAD
+BenchRow bench_load_st(const std::vector<uint64_t>& keys) {
+    BenchRow r = bench_bulk_load_st(keys);
+    std::stringstream saved;
+    {
+        int64_trie<int> trie;
+        for (auto k : keys) trie.insert({static_cast<int64_t>(k), static_cast<int>(k)});
+        trie.save(saved);
+    }
+    int64_trie<int> trie;
+    r.tktrie = time_op_ns([&]() { trie.load(saved); }, keys.size());
+    return r;
+}
+
 BenchRow bench_erase_st(const std::vector<uint64_t>& keys) {
     BenchRow r;
     
@@ -630,6 +784,175 @@ BenchRow bench_erase_mt(const std::vector<uint64_t>& keys, int num_threads) {
     return r;
 }
 
+// =============================================================================
+// Read scaling: every thread finds every key (fixed work per thread)
+// =============================================================================
+
+template <typename Container, typename Find>
+double bench_read_scaling_generic(const Container& c, const std::vector<uint64_t>& keys,
+                                  int num_threads, Find find) {
+    std::vector<std::thread> threads;
+    std::atomic<bool> go{false};
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            volatile size_t hits = 0;
+            size_t n = keys.size(), off = (n / num_threads) * t;
+            for (size_t i = 0; i < n; ++i) hits = hits + find(c, keys[(i + off) % n]);
+        });
+    }
+    auto start = high_resolution_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& th : threads) th.join();
+    return duration_cast<nanoseconds>(high_resolution_clock::now() - start).count() /
+           static_cast<double>(keys.size() * num_threads);
+}
+
+BenchRow bench_read_scaling_mt(const std::vector<uint64_t>& keys, int num_threads) {
+    BenchRow r;
+    
+    {
+        concurrent_int64_trie<int> trie;
+        for (auto k : keys) trie.insert({static_cast<int64_t>(k), static_cast<int>(k)});
+        r.tktrie = bench_read_scaling_generic(trie, keys, num_threads,
+            [](const auto& c, uint64_t k) { return c.contains(static_cast<int64_t>(k)); });
+    }
+    {
+        guarded_map<uint64_t, int> gm;
+        for (auto k : keys) gm.insert(k, static_cast<int>(k));
+        r.map = bench_read_scaling_generic(gm, keys, num_threads,
+            [](const auto& c, uint64_t k) { return c.find(k); });
+    }
+    {
+        guarded_unordered_map<uint64_t, int> gum;
+        for (auto k : keys) gum.insert(k, static_cast<int>(k));
+        r.umap = bench_read_scaling_generic(gum, keys, num_threads,
+            [](const auto& c, uint64_t k) { return c.find(k); });
+    }
+    
+    return r;
+}
+
+// =============================================================================
+// Write scaling: each thread inserts then erases its own slice of the keys
+// =============================================================================
+
+template <typename Container, typename Insert, typename Erase>
+double bench_write_scaling_generic(Container& c, const std::vector<uint64_t>& keys,
+                                   int num_threads, Insert insert, Erase erase) {
+    std::vector<std::thread> threads;
+    std::atomic<bool> go{false};
+    auto chunk = keys.size() / num_threads;
+    for (int t = 0; t < num_threads; ++t) {
+        size_t b = t * chunk, e = (t == num_threads-1) ? keys.size() : (t+1)*chunk;
+        threads.emplace_back([&, b, e]() {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (size_t i = b; i < e; ++i) insert(c, keys[i]);
+            for (size_t i = b; i < e; ++i) erase(c, keys[i]);
+        });
+    }
+    auto start = high_resolution_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& th : threads) th.join();
+    return duration_cast<nanoseconds>(high_resolution_clock::now() - start).count() /
+           static_cast<double>(keys.size() * 2);
+}
+
+template <typename Trie, bool COMBINED = false>
+BenchRow bench_write_scaling_mt(const std::vector<uint64_t>& keys, int num_threads) {
+    BenchRow r;
+    
+    {
+        Trie trie;
+        r.tktrie = bench_write_scaling_generic(trie, keys, num_threads,
+            [](auto& c, uint64_t k) {
+                if constexpr (COMBINED) c.insert_combined({static_cast<int64_t>(k), static_cast<int>(k)});
+                else c.insert({static_cast<int64_t>(k), static_cast<int>(k)});
+            },
+            [](auto& c, uint64_t k) {
+                if constexpr (COMBINED) c.erase_combined(static_cast<int64_t>(k));
+                else c.erase(static_cast<int64_t>(k));
+            });
+    }
+    {
+        guarded_map<uint64_t, int> gm;
+        r.map = bench_write_scaling_generic(gm, keys, num_threads,
+            [](auto& c, uint64_t k) { c.insert(k, static_cast<int>(k)); },
+            [](auto& c, uint64_t k) { c.erase(k); });
+    }
+    {
+        guarded_unordered_map<uint64_t, int> gum;
+        r.umap = bench_write_scaling_generic(gum, keys, num_threads,
+            [](auto& c, uint64_t k) { c.insert(k, static_cast<int>(k)); },
+            [](auto& c, uint64_t k) { c.erase(k); });
+    }
+    
+    return r;
+}
+
+// =============================================================================
+// Find tail latency: readers time each find while one writer churns the trie
+// =============================================================================
+
+struct LatencyRow {
+    double p50;
+    double p99;
+    double p999;
+    double max;
+};
+
+LatencyRow bench_find_latency_mt(const std::vector<uint64_t>& keys, int num_readers,
+                                 reclaim_policy policy) {
+    static constexpr size_t FINDS_PER_READER = 50000;
+    static constexpr size_t POLL_EVERY = 1024;  // MANUAL: writer's poll() cadence
+    
+    concurrent_int64_trie<int> trie;
+    trie.set_reclaim_policy(policy);
+    for (auto k : keys) trie.insert({static_cast<int64_t>(k), static_cast<int>(k)});
+    
+    std::atomic<bool> go{false}, stop{false};
+    std::thread writer([&]() {
+        while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+        // Erase and reinsert a sliding window: every pair retires nodes
+        for (size_t i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+            int64_t k = static_cast<int64_t>(keys[i % keys.size()]);
+            trie.erase(k);
+            trie.insert({k, static_cast<int>(k)});
+            if (policy == reclaim_policy::MANUAL && i % POLL_EVERY == 0) trie.poll();
+        }
+    });
+    
+    std::vector<std::vector<uint32_t>> samples(num_readers);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < num_readers; ++t) {
+        readers.emplace_back([&, t]() {
+            auto& out = samples[t];
+            out.reserve(FINDS_PER_READER);
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            size_t n = keys.size(), off = (n / num_readers) * t;
+            for (size_t i = 0; i < FINDS_PER_READER; ++i) {
+                int64_t k = static_cast<int64_t>(keys[(i * 7 + off) % n]);
+                auto start = steady_clock::now();
+                auto it = trie.find(k);
+                auto end = steady_clock::now();
+                volatile bool hit = it.valid();
+                (void)hit;
+                out.push_back(static_cast<uint32_t>(duration_cast<nanoseconds>(end - start).count()));
+            }
+        });
+    }
+    go.store(true, std::memory_order_release);
+    for (auto& th : readers) th.join();
+    stop.store(true, std::memory_order_relaxed);
+    writer.join();
+    
+    std::vector<uint32_t> all;
+    for (auto& s : samples) all.insert(all.end(), s.begin(), s.end());
+    std::sort(all.begin(), all.end());
+    auto pct = [&](double p) { return static_cast<double>(all[static_cast<size_t>(p * (all.size() - 1))]); };
+    return {pct(0.50), pct(0.99), pct(0.999), static_cast<double>(all.back())};
+}
+
 // =============================================================================
 // Output helpers
 // =============================================================================
@@ -644,6 +967,21 @@ void print_row(const std::string& op, const BenchRow& r) {
               << std::setw(6) << r.umap_vs() << "x |\n";
 }
 
+void print_latency_row(const std::string& policy, const LatencyRow& r) {
+    std::cout << "| " << std::left << std::setw(20) << policy << " | "
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(8) << r.p50 << " | "
+              << std::setw(8) << r.p99 << " | "
+              << std::setw(8) << r.p999 << " | "
+              << std::setw(10) << r.max << " |\n";
+}
+
+LatencyRow average_latency_rows(std::vector<LatencyRow>& rows) {
+    std::vector<double> p50, p99, p999, mx;
+    for (auto& r : rows) { p50.push_back(r.p50); p99.push_back(r.p99); p999.push_back(r.p999); mx.push_back(r.max); }
+    return {trimmed_mean(p50), trimmed_mean(p99), trimmed_mean(p999), trimmed_mean(mx)};
+}
+
 BenchRow average_rows(std::vector<BenchRow>& rows) {
     std::vector<double> t, m, u;
     for (auto& r : rows) { t.push_back(r.tktrie); m.push_back(r.map); u.push_back(r.umap); }
@@ -677,18 +1015,28 @@ int main() {
         std::cout << "| Operation            | TKTRIE   | MAP      | MAP vs | UMAP     | UMAP vs |\n";
         std::cout << "|----------------------|----------|----------|--------|----------|---------|\n";
         
-        std::vector<BenchRow> find_r, notfound_r, insert_r, erase_r;
+        std::vector<BenchRow> find_r, batch_r, notfound_r, insert_r, ibatch_r, bulk_r, load_r, erase_r, scan_r;
         for (int i = 0; i < ITERATIONS; ++i) {
             find_r.push_back(bench_find_st(keys));
+            batch_r.push_back(bench_find_batch_st(keys));
             notfound_r.push_back(bench_notfound_st(keys, missing));
             insert_r.push_back(bench_insert_st(keys));
+            ibatch_r.push_back(bench_insert_batch_st(keys));
+            bulk_r.push_back(bench_bulk_load_st(keys));
+            load_r.push_back(bench_load_st(keys));
             erase_r.push_back(bench_erase_st(keys));
+            scan_r.push_back(bench_scan_st(keys));
         }
         
         print_row("FIND", average_rows(find_r));
+        print_row("FIND BATCH(64)", average_rows(batch_r));
         print_row("NOT-FOUND", average_rows(notfound_r));
         print_row("INSERT", average_rows(insert_r));
+        print_row("INSERT BATCH(64)", average_rows(ibatch_r));
+        print_row("BULK LOAD", average_rows(bulk_r));
+        print_row("LOAD (SAVED)", average_rows(load_r));
         print_row("ERASE", average_rows(erase_r));
+        print_row("SCAN", average_rows(scan_r));
         std::cout << "\n";
     }
     
@@ -725,5 +1073,84 @@ int main() {
         }
     }
     
+    // =========================================================================
+    // READ SCALING (THREADED=true)
+    // =========================================================================
+    
+    std::cout << "## Read Scaling (THREADED=true)\n\n";
+    std::cout << "Every thread finds every random key; times are wall ns / total finds, "
+              << "so a flat column means reads stopped scaling.\n\n";
+    std::cout << "| Operation            | TKTRIE   | MAP      | MAP vs | UMAP     | UMAP vs |\n";
+    std::cout << "|----------------------|----------|----------|--------|----------|---------|\n";
+    
+    for (int threads : {1, 4, 8, 16, 24, 32, 48, 64}) {
+        std::vector<BenchRow> scale_r;
+        for (int i = 0; i < ITERATIONS; ++i) {
+            scale_r.push_back(bench_read_scaling_mt(rnd_keys, threads));
+        }
+        print_row("FIND x" + std::to_string(threads) + " threads", average_rows(scale_r));
+    }
+    std::cout << "\n";
+    
+    // =========================================================================
+    // WRITE SCALING (THREADED=true)
+    // =========================================================================
+    
+    std::cout << "## Write Scaling (THREADED=true)\n\n";
+    std::cout << "Threads insert then erase disjoint slices of the random keys; times are "
+              << "wall ns / total writes, so falling times mean writers commit in parallel. "
+              << "SHARDED rows run sharded_int64_trie (16 shards) in the TKTRIE column; "
+              << "COMBINED rows use the flat-combining insert_combined/erase_combined.\n\n";
+    std::cout << "| Operation            | TKTRIE   | MAP      | MAP vs | UMAP     | UMAP vs |\n";
+    std::cout << "|----------------------|----------|----------|--------|----------|---------|\n";
+    
+    for (int threads : {1, 2, 4, 8, 16}) {
+        std::vector<BenchRow> scale_r;
+        for (int i = 0; i < ITERATIONS; ++i) {
+            scale_r.push_back(bench_write_scaling_mt<concurrent_int64_trie<int>>(rnd_keys, threads));
+        }
+        print_row("WRITE x" + std::to_string(threads) + " threads", average_rows(scale_r));
+    }
+    // TKTRIE column: sharded_int64_trie, 16 shards by leading key byte
+    for (int threads : {1, 2, 4, 8, 16}) {
+        std::vector<BenchRow> scale_r;
+        for (int i = 0; i < ITERATIONS; ++i) {
+            scale_r.push_back(bench_write_scaling_mt<sharded_int64_trie<int>>(rnd_keys, threads));
+        }
+        print_row("SHARDED x" + std::to_string(threads) + " threads", average_rows(scale_r));
+    }
+    // TKTRIE column: concurrent_int64_trie through insert_combined/erase_combined
+    for (int threads : {1, 2, 4, 8, 16}) {
+        std::vector<BenchRow> scale_r;
+        for (int i = 0; i < ITERATIONS; ++i) {
+            scale_r.push_back(bench_write_scaling_mt<concurrent_int64_trie<int>, true>(rnd_keys, threads));
+        }
+        print_row("COMBINED x" + std::to_string(threads) + " threads", average_rows(scale_r));
+    }
+    std::cout << "\n";
+    
+    // =========================================================================
+    // FIND TAIL LATENCY (THREADED=true)
+    // =========================================================================
+    
+    std::cout << "## Find Tail Latency (THREADED=true)\n\n";
+    std::cout << "4 readers time each find of a random key while 1 writer erases and "
+              << "reinserts keys; times are ns per find by percentile. INLINE readers "
+              << "may pay for reclamation, BACKGROUND hands it to a reclaimer thread, "
+              << "MANUAL has the writer call poll() every 1024 pairs.\n\n";
+    std::cout << "| Policy               | P50      | P99      | P999     | MAX        |\n";
+    std::cout << "|----------------------|----------|----------|----------|------------|\n";
+    
+    for (auto [name, policy] : {std::pair{"INLINE", reclaim_policy::INLINE},
+                                std::pair{"BACKGROUND", reclaim_policy::BACKGROUND},
+                                std::pair{"MANUAL", reclaim_policy::MANUAL}}) {
+        std::vector<LatencyRow> lat_r;
+        for (int i = 0; i < ITERATIONS; ++i) {
+            lat_r.push_back(bench_find_latency_mt(rnd_keys, 4, policy));
+        }
+        print_latency_row(name, average_latency_rows(lat_r));
+    }
+    std::cout << "\n";
+    
     return 0;
 }
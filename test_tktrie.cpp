@@ -1,9 +1,17 @@
+#include <algorithm>
 #include <iostream>
 #include <cassert>
+#include <cmath>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <thread>
 #include <random>
+#include <sstream>
+#include <stdexcept>
+#include <atomic>
+#include <tuple>
 
 #include "tktrie.h"
 #include "tktrie_core.h"
@@ -151,6 +159,14 @@ void test_int_trie() {
     assert(trie.find(INT32_MAX).value() == "max");
     assert(trie.find(INT32_MIN).value() == "min");
     
+    // Emptying the trie, or leaving the root one child, must keep full-length keys readable
+    for (int32_t k : {42, -1, 0, INT32_MAX}) assert(trie.erase(k));
+    assert(trie.find(INT32_MIN).value() == "min");
+    assert(trie.erase(INT32_MIN));
+    assert(trie.empty());
+    trie.insert({0, "zero"});
+    assert(trie.find(0).value() == "zero");
+    
     std::cout << "  PASSED\n";
 }
 
@@ -185,6 +201,116 @@ void test_copy_move() {
     std::cout << "  PASSED\n";
 }
 
+template <typename Trie>
+void check_node_reuse() {
+    Trie trie;
+
+    // Erasing a child beside an EOS value, then reinserting through recycled nodes
+    trie.insert({"accc", 1});
+    trie.insert({"ac", 2});
+    assert(trie.erase("accc"));
+    assert(trie.find("ac").value() == 2);
+    assert(trie.insert({"accc", 3}).second);
+    assert(trie.find("accc").value() == 3);
+    assert(trie.erase("accc"));
+    assert(trie.erase("ac"));
+    assert(trie.empty());
+
+    // Erasing both children of an interior must collapse it
+    trie.insert({"dcaba", 1});
+    trie.insert({"dcabc", 2});
+    trie.insert({"dd", 3});
+    assert(trie.erase("dcabc"));
+    assert(trie.erase("dcaba"));
+    auto it = trie.begin();
+    assert(it != trie.end() && it.key() == "dd");
+    ++it;
+    assert(it == trie.end());
+
+    // Churn so freed blocks are handed out again
+    for (int round = 0; round < 4; ++round) {
+        for (int i = 0; i < 500; ++i) trie.insert({"k" + std::to_string(i * 7), i});
+        for (int i = 0; i < 500; i += 2) assert(trie.erase("k" + std::to_string(i * 7)));
+        for (int i = 1; i < 500; i += 2) assert(trie.find("k" + std::to_string(i * 7)).value() == i);
+        for (int i = 1; i < 500; i += 2) assert(trie.erase("k" + std::to_string(i * 7)));
+    }
+    assert(trie.size() == 1);
+
+    // A moved-from trie keeps working with its fresh pools
+    Trie moved(std::move(trie));
+    assert(moved.contains("dd"));
+    trie.insert({"again", 4});
+    assert(trie.find("again").value() == 4);
+}
+
+// Stateful (no default constructor): counts the bytes it has outstanding
+template <typename U>
+struct counting_allocator {
+    using value_type = U;
+    std::atomic<long>* outstanding;
+
+    explicit counting_allocator(std::atomic<long>* o) noexcept : outstanding(o) {}
+    template <typename V>
+    counting_allocator(const counting_allocator<V>& o) noexcept : outstanding(o.outstanding) {}
+
+    U* allocate(size_t n) {
+        *outstanding += static_cast<long>(n * sizeof(U));
+        return std::allocator<U>().allocate(n);
+    }
+    void deallocate(U* p, size_t n) noexcept {
+        *outstanding -= static_cast<long>(n * sizeof(U));
+        std::allocator<U>().deallocate(p, n);
+    }
+    template <typename V>
+    bool operator==(const counting_allocator<V>& o) const noexcept { return outstanding == o.outstanding; }
+};
+
+template <bool THREADED>
+void check_slab_allocator() {
+    using trie_t = tktrie<std::string, int, THREADED, counting_allocator<uint64_t>>;
+    std::atomic<long> outstanding{0};
+    {
+        trie_t trie{counting_allocator<uint64_t>(&outstanding)};
+        assert(trie.get_allocator().outstanding == &outstanding);
+        auto fill = [&trie](int base) {
+            for (int i = 0; i < 2000; ++i) trie.insert({"k" + std::to_string(base + i), i});
+            for (int i = 0; i < 2000; i += 2) trie.erase("k" + std::to_string(base + i));
+        };
+        if constexpr (THREADED) {
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 4; ++t) threads.emplace_back(fill, t * 10000);
+            for (auto& th : threads) th.join();
+            assert(trie.size() == 4000);
+        } else {
+            fill(0);
+            assert(trie.size() == 1000);
+        }
+        assert(outstanding > 0);
+
+        trie_t copy(trie);
+        assert(copy.get_allocator() == trie.get_allocator());
+        copy.clear();
+
+        // clear() returns every slab chunk; the trie is usable afterwards
+        trie.clear();
+        assert(outstanding == 0);
+        fill(0);
+        assert(trie.find("k1").value() == 1);
+    }
+    assert(outstanding == 0);
+}
+
+void test_node_reuse() {
+    std::cout << "Testing node slab reuse...\n";
+
+    check_node_reuse<string_trie<int>>();
+    check_node_reuse<concurrent_string_trie<int>>();
+    check_slab_allocator<false>();
+    check_slab_allocator<true>();
+
+    std::cout << "  PASSED\n";
+}
+
 void test_concurrent_basic() {
     std::cout << "Testing concurrent trie basic operations...\n";
     
@@ -256,6 +382,1892 @@ void test_concurrent_multithread() {
     std::cout << "  PASSED\n";
 }
 
+void test_many_readers() {
+    std::cout << "Testing EBR with more readers than cores and tries...\n";
+    
+    // More concurrent readers than the old 16 fixed slots, with a writer churning
+    concurrent_int64_trie<int> trie;
+    for (int64_t i = 0; i < 1000; ++i) trie.insert({i, static_cast<int>(i)});
+    
+    std::atomic<bool> stop{false};
+    std::atomic<int> bad{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 32; ++t) {
+        threads.emplace_back([&]() {
+            while (!stop.load()) {
+                for (int64_t i = 0; i < 1000; i += 7) {
+                    auto it = trie.find(i);
+                    if (!it.valid() || it.value() != static_cast<int>(i)) bad.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (int round = 0; round < 50; ++round) {
+        for (int64_t i = 1000; i < 1200; ++i) trie.insert({i, 0});
+        for (int64_t i = 1000; i < 1200; ++i) trie.erase(i);
+    }
+    stop.store(true);
+    for (auto& t : threads) t.join();
+    assert(bad.load() == 0);
+    assert(trie.size() == 1000);
+    
+    // One thread reading more tries than its record cache holds
+    std::vector<concurrent_string_trie<int>> tries(20);
+    for (size_t i = 0; i < tries.size(); ++i) tries[i].insert({"k", static_cast<int>(i)});
+    threads.clear();
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&]() {
+            for (int round = 0; round < 100; ++round) {
+                for (size_t i = 0; i < tries.size(); ++i) {
+                    if (tries[i].find("k").value() != static_cast<int>(i)) bad.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    assert(bad.load() == 0);
+    
+    std::cout << "  PASSED\n";
+}
+
+void test_optimistic_reads() {
+    std::cout << "Testing optimistic reads against in-place writes...\n";
+    
+    // Every prefix is a key: lookups walk deeper than a read path records
+    concurrent_string_trie<int> trie;
+    std::string deep;
+    for (int i = 1; i <= 100; ++i) {
+        deep.push_back('a');
+        trie.insert({deep, i});
+    }
+    assert(trie.find(deep).value() == 100);
+    assert(trie.contains(deep.substr(0, 70)));
+    
+    // Writers flip EOS values and leaf entries beside keys the readers check
+    std::atomic<bool> stop{false};
+    std::atomic<int> bad{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&]() {
+            std::string k;
+            while (!stop.load()) {
+                k.clear();
+                for (int i = 1; i <= 100; i += 3) {
+                    k.resize(i, 'a');
+                    auto it = trie.find(k);
+                    if (!it.valid() || it.value() != i) bad.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (int round = 0; round < 100; ++round) {
+        std::string k;
+        for (int i = 1; i <= 100; ++i) {
+            k.push_back('a');
+            trie.insert({k + "b", -i});
+            trie.insert({k + "c", -i});
+        }
+        k.clear();
+        for (int i = 1; i <= 100; ++i) {
+            k.push_back('a');
+            trie.erase(k + "b");
+            trie.erase(k + "c");
+        }
+    }
+    stop.store(true);
+    for (auto& t : threads) t.join();
+    assert(bad.load() == 0);
+    assert(trie.size() == 100);
+    
+    std::cout << "  PASSED\n";
+}
+
+void test_concurrent_writers() {
+    std::cout << "Testing concurrent writers on shared nodes...\n";
+    
+    // Interleaved keys make writers split, grow and shrink the same nodes.
+    // A lost commit shows up about once in hundreds of runs, so run many.
+    for (int rep = 0; rep < 1000; ++rep) {
+        concurrent_string_trie<int> trie;
+        const int num_threads = 8;
+        std::atomic<int> bad{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int round = 0; round < 20; ++round) {
+                    for (int i = t; i < 400; i += num_threads) {
+                        std::string key = "w" + std::to_string(i % 37) + "_" + std::to_string(i);
+                        if (!trie.insert({key, i}).second) bad.fetch_add(1);
+                        if (!trie.contains(key)) bad.fetch_add(1);
+                    }
+                    for (int i = t; i < 400; i += num_threads) {
+                        if (i % 3 == 0) continue;
+                        std::string key = "w" + std::to_string(i % 37) + "_" + std::to_string(i);
+                        if (!trie.erase(key)) bad.fetch_add(1);
+                        if (trie.contains(key)) bad.fetch_add(1);
+                    }
+                    for (int i = t; i < 400; i += num_threads) {
+                        if (i % 3 != 0) continue;
+                        std::string key = "w" + std::to_string(i % 37) + "_" + std::to_string(i);
+                        if (!trie.erase(key)) bad.fetch_add(1);
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        assert(bad.load() == 0);
+        assert(trie.empty());
+        assert(trie.begin() == trie.end());
+    }
+    
+    std::cout << "  PASSED\n";
+}
+
+void test_sharded_trie() {
+    std::cout << "Testing sharded trie...\n";
+    
+    // Keys spread over every leading byte, so all shards are populated
+    sharded_int64_trie<int64_t> trie;
+    std::vector<int64_t> keys;
+    for (int i = 0; i < 512; ++i) {
+        keys.push_back(static_cast<int64_t>(static_cast<uint64_t>(i) * 0x0081020408102041ULL));
+    }
+    for (size_t s = 0; s < trie.shard_count(); ++s) assert(trie.shard_at(s).empty());
+    
+    const int num_threads = 4;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (size_t i = t; i < keys.size(); i += num_threads) {
+                assert(trie.insert({keys[i], keys[i]}).second);
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    assert(trie.size() == keys.size());
+    for (size_t s = 0; s < trie.shard_count(); ++s) assert(!trie.shard_at(s).empty());
+    
+    // Iteration is ordered across shard boundaries, both directions
+    std::vector<int64_t> sorted = keys;
+    std::sort(sorted.begin(), sorted.end());
+    size_t idx = 0;
+    for (auto it = trie.begin(); it != trie.end(); ++it) {
+        assert(it.key() == sorted[idx]);
+        assert(it.value() == sorted[idx]);
+        ++idx;
+    }
+    assert(idx == sorted.size());
+    for (auto it = trie.rbegin(); it != trie.rend(); ++it) assert(it.key() == sorted[--idx]);
+    
+    auto it = trie.find(sorted[100]);
+    assert(it.valid() && it.value() == sorted[100]);
+    ++it;
+    assert(it.key() == sorted[101]);
+    --it; --it;
+    assert(it.key() == sorted[99]);
+    
+    assert(!trie.insert({keys[0], 0}).second);
+    for (size_t i = 0; i < keys.size(); i += 2) assert(trie.erase(keys[i]));
+    for (size_t i = 0; i < keys.size(); ++i) assert(trie.contains(keys[i]) == (i % 2 == 1));
+    assert(trie.size() == keys.size() / 2);
+    
+    trie.clear();
+    assert(trie.empty());
+    assert(trie.begin() == trie.end());
+    
+    std::cout << "  PASSED\n";
+}
+
+// Copy-constructing a negative one throws (assignment doesn't)
+struct throw_on_copy {
+    int64_t v = 0;
+    throw_on_copy() = default;
+    explicit throw_on_copy(int64_t x) : v(x) {}
+    throw_on_copy(const throw_on_copy& o) : v(o.v) {
+        if (v < 0) throw std::runtime_error("copy");
+    }
+    throw_on_copy(throw_on_copy&&) noexcept = default;
+    throw_on_copy& operator=(const throw_on_copy&) = default;
+};
+
+void test_combined_writers() {
+    std::cout << "Testing flat-combining writers...\n";
+    
+    // Combined and direct writers on the same trie, same key ranges
+    concurrent_int64_trie<int> trie;
+    const int num_threads = 8;
+    const int per_thread = 500;
+    std::atomic<int> bad{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            bool combined = (t % 4) != 3;
+            for (int round = 0; round < 3; ++round) {
+                for (int i = 0; i < per_thread; ++i) {
+                    int64_t k = static_cast<int64_t>(i) * num_threads + t;
+                    auto res = combined ? trie.insert_combined({k, static_cast<int>(k)})
+                                        : trie.insert({k, static_cast<int>(k)});
+                    if (!res.second || res.first.key() != k) bad.fetch_add(1);
+                    if (combined && trie.insert_combined({k, 0}).second) bad.fetch_add(1);
+                }
+                for (int i = 0; i < per_thread; i += 2) {
+                    int64_t k = static_cast<int64_t>(i) * num_threads + t;
+                    bool erased = combined ? trie.erase_combined(k) : trie.erase(k);
+                    if (!erased || trie.contains(k)) bad.fetch_add(1);
+                }
+                for (int i = 0; i < per_thread; i += 2) {
+                    int64_t k = static_cast<int64_t>(i) * num_threads + t;
+                    trie.insert({k, static_cast<int>(k)});
+                }
+                if (round < 2) {
+                    for (int i = 0; i < per_thread; ++i) {
+                        if (!trie.erase_combined(static_cast<int64_t>(i) * num_threads + t)) bad.fetch_add(1);
+                    }
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    assert(bad.load() == 0);
+    assert(trie.size() == static_cast<size_t>(num_threads * per_thread));
+    int64_t expect = 0;
+    for (auto it = trie.begin(); it != trie.end(); ++it) {
+        assert(it.key() == expect);
+        assert(it.value() == expect);
+        ++expect;
+    }
+    assert(expect == num_threads * per_thread);
+    assert(!trie.erase_combined(-1));
+    
+    {
+        // A throwing op is handed back to its poster; the lock and the rest
+        // of the batch are not left behind
+        concurrent_int64_trie<throw_on_copy> ftrie;
+        std::atomic<int> thrown{0};
+        std::vector<std::thread> posters;
+        for (int t = 0; t < 4; ++t) {
+            posters.emplace_back([&, t]() {
+                for (int64_t i = 0; i < 200; ++i) {
+                    int64_t k = i * 4 + t;
+                    try {
+                        ftrie.insert_combined({k, throw_on_copy{k % 10 == 0 ? -1 : 1}});
+                    } catch (const std::runtime_error&) {
+                        thrown.fetch_add(1);
+                    }
+                }
+            });
+        }
+        for (auto& p : posters) p.join();
+        assert(thrown.load() == 80);
+        assert(ftrie.size() == 720);
+        assert(ftrie.insert({-5, throw_on_copy{1}}).second);
+        assert(ftrie.erase_combined(-5));
+    }
+    
+    std::cout << "  PASSED\n";
+}
+
+void test_reclaim_policy() {
+    std::cout << "Testing reclamation policies...\n";
+    
+    // Each insert/erase of a lone key retires its leaf
+    auto churn = [](concurrent_int64_trie<int>& trie, int rounds) {
+        for (int r = 0; r < rounds; ++r) {
+            for (int64_t k = 0; k < 100; ++k) trie.insert({k * 1000 + r, r});
+            for (int64_t k = 0; k < 100; ++k) trie.erase(k * 1000 + r);
+        }
+    };
+    
+    {
+        concurrent_int64_trie<int> trie;
+        trie.set_reclaim_policy(reclaim_policy::MANUAL);
+        assert(trie.get_reclaim_policy() == reclaim_policy::MANUAL);
+        churn(trie, 50);
+        size_t before = trie.retired_count();
+        assert(before > 1000);
+        trie.poll();
+        assert(trie.retired_count() < before / 10);
+        assert(trie.empty());
+    }
+    
+    {
+        concurrent_int64_trie<int> trie;
+        trie.set_reclaim_policy(reclaim_policy::BACKGROUND);
+        std::atomic<bool> stop{false};
+        std::thread reader([&]() {
+            while (!stop.load()) trie.contains(42);
+        });
+        churn(trie, 50);
+        stop.store(true);
+        reader.join();
+        // Writers only wake the reclaimer; give it a few periods to catch up
+        churn(trie, 1);
+        for (int i = 0; i < 200 && trie.retired_count() >= 1000; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        assert(trie.retired_count() < 1000);
+        // Switching back to INLINE parks the reclaimer; writers free again
+        trie.set_reclaim_policy(reclaim_policy::INLINE);
+        churn(trie, 50);
+        assert(trie.retired_count() < 1000);
+    }
+    
+    std::cout << "  PASSED\n";
+}
+
+void test_zero_copy_reads() {
+    std::cout << "Testing zero-copy reads (find_ref/visit)...\n";
+    
+    const std::string big(200, 'x');
+    {
+        string_trie<std::string> trie;
+        trie.insert({"a", big + "a"});
+        trie.insert({"ab", big + "ab"});  // "a" becomes an EOS value
+        trie.insert({"abc", big + "abc"});
+        
+        auto g = trie.find_ref("ab");
+        assert(g);
+        assert(*g == big + "ab");
+        assert(g->size() == big.size() + 2);
+        assert(!trie.find_ref("zz"));
+        
+        const std::string* seen = nullptr;
+        assert(trie.visit("a", [&](const std::string& v) { seen = &v; }));
+        assert(seen && *seen == big + "a");
+        assert(!trie.visit("abcd", [](const std::string&) { assert(false); }));
+    }
+    {
+        // Inline THREADED values are copied into the guard
+        concurrent_int64_trie<int> trie;
+        trie.insert({7, 70});
+        int got = 0;
+        assert(trie.visit(7, [&](int v) { got = v; }));
+        assert(got == 70);
+        assert(!trie.find_ref(8));
+    }
+    {
+        // The guard keeps an erased value alive until it is released
+        concurrent_string_trie<std::string> trie;
+        trie.insert({"k1", big + "1"});
+        trie.insert({"k2", big + "2"});
+        trie.set_reclaim_policy(reclaim_policy::MANUAL);
+        auto g = trie.find_ref("k1");
+        assert(g);
+        assert(trie.erase("k1"));
+        trie.poll();
+        assert(*g == big + "1");
+        g.release();
+        assert(!g);
+        trie.poll();
+    }
+    {
+        // Readers pin values while writers erase and reinsert them
+        concurrent_string_trie<std::string> trie;
+        const int num_keys = 200;
+        auto val = [&](int i) { return big + std::to_string(i); };
+        for (int i = 0; i < num_keys; ++i) trie.insert({"key" + std::to_string(i), val(i)});
+        std::atomic<bool> stop{false};
+        std::atomic<int> bad{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 3; ++t) {
+            threads.emplace_back([&, t]() {
+                std::mt19937 rng(t);
+                while (!stop.load()) {
+                    int i = static_cast<int>(rng() % num_keys);
+                    trie.visit("key" + std::to_string(i), [&](const std::string& v) {
+                        if (v != val(i)) bad.fetch_add(1);
+                    });
+                }
+            });
+        }
+        for (int round = 0; round < 20; ++round) {
+            for (int i = round % 2; i < num_keys; i += 2) trie.erase("key" + std::to_string(i));
+            for (int i = round % 2; i < num_keys; i += 2) trie.insert({"key" + std::to_string(i), val(i)});
+        }
+        stop.store(true);
+        for (auto& t : threads) t.join();
+        assert(bad.load() == 0);
+        assert(trie.size() == static_cast<size_t>(num_keys));
+    }
+    
+    std::cout << "  PASSED\n";
+}
+
+void test_insert_or_assign() {
+    std::cout << "Testing insert_or_assign/upsert...\n";
+    
+    {
+        string_trie<std::string> trie;
+        auto [it, inserted] = trie.insert_or_assign("a", "1");
+        assert(inserted && it.value() == "1");
+        trie.insert({"ab", "2"});   // "a" becomes EOS
+        trie.insert({"abc", "3"});
+        trie.insert({"abd", "4"});  // multi-entry leaf
+        for (auto* k : {"a", "ab", "abc", "abd"}) {
+            auto res = trie.insert_or_assign(k, std::string(k) + "!");
+            assert(!res.second && res.first.value() == std::string(k) + "!");
+        }
+        for (auto* k : {"a", "ab", "abc", "abd"}) assert(trie.find(k).value() == std::string(k) + "!");
+        assert(trie.size() == 4);
+        
+        assert(!trie.upsert("abc", [](const std::string* old) { return *old + "?"; }));
+        assert(trie.find("abc").value() == "abc!?");
+        assert(trie.upsert("zz", [](const std::string* old) { assert(!old); return std::string("new"); }));
+        assert(trie.find("zz").value() == "new");
+    }
+    {
+        // Fixed-length keys in every leaf node type
+        int64_trie<int> trie;
+        for (int64_t i = 0; i < 300; ++i) trie.insert({i, 0});
+        for (int64_t i = 0; i < 300; ++i) assert(!trie.insert_or_assign(i, static_cast<int>(i)).second);
+        for (int64_t i = 0; i < 300; ++i) assert(trie.find(i).value() == i);
+        assert(trie.size() == 300);
+    }
+    {
+        // Counters: concurrent upserts of shared keys must not lose updates
+        concurrent_int64_trie<int> trie;
+        const int num_threads = 4;
+        const int per_thread = 2000;
+        const int num_keys = 37;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < per_thread; ++i) {
+                    int64_t k = (i * 7 + t) % num_keys;
+                    trie.upsert(k, [](const int* old) { return old ? *old + 1 : 1; });
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        int total = 0;
+        for (auto it = trie.begin(); it != trie.end(); ++it) total += it.value();
+        assert(total == num_threads * per_thread);
+        assert(trie.size() == static_cast<size_t>(num_keys));
+    }
+    {
+        // Heap values replaced under readers pinning them
+        concurrent_string_trie<std::string> trie;
+        const std::string big(100, 'v');
+        for (int i = 0; i < 50; ++i) trie.insert({"k" + std::to_string(i), big});
+        std::atomic<bool> stop{false};
+        std::atomic<int> bad{0};
+        std::thread reader([&]() {
+            while (!stop.load()) {
+                for (int i = 0; i < 50; ++i) {
+                    trie.visit("k" + std::to_string(i), [&](const std::string& v) {
+                        if (v.size() != big.size()) bad.fetch_add(1);
+                    });
+                }
+            }
+        });
+        for (int round = 0; round < 200; ++round) {
+            for (int i = 0; i < 50; ++i) {
+                trie.insert_or_assign("k" + std::to_string(i), std::string(big.size(), static_cast<char>('a' + round % 26)));
+            }
+        }
+        stop.store(true);
+        reader.join();
+        assert(bad.load() == 0);
+        assert(trie.size() == 50);
+        assert(trie.find("k7").value() == std::string(big.size(), static_cast<char>('a' + 199 % 26)));
+    }
+    {
+        // Update-only workloads retire values but no nodes: they still drain
+        concurrent_string_trie<std::string> trie;
+        trie.set_reclaim_policy(reclaim_policy::MANUAL);
+        const std::string big(100, 'u');
+        for (int i = 0; i < 20; ++i) trie.insert({"k" + std::to_string(i), big});
+        for (int round = 0; round < 100; ++round) {
+            for (int i = 0; i < 20; ++i) trie.insert_or_assign("k" + std::to_string(i), big);
+        }
+        assert(trie.retired_count() >= 2000);
+        trie.poll();
+        assert(trie.retired_count() == 0);
+
+        trie.set_reclaim_policy(reclaim_policy::INLINE);
+        for (int round = 0; round < 100; ++round) {
+            for (int i = 0; i < 20; ++i) trie.upsert("k" + std::to_string(i), [](const std::string* v) { return *v; });
+        }
+        assert(trie.retired_count() < 2 * concurrent_string_trie<std::string>::EBR_MIN_RETIRED);
+        assert(trie.size() == 20);
+    }
+
+    std::cout << "  PASSED\n";
+}
+
+// Counts how values reach the trie
+struct tracked_value {
+    static inline int constructs = 0;
+    static inline int copies = 0;
+    static inline int moves = 0;
+    static void reset() { constructs = copies = moves = 0; }
+
+    std::string s;
+    tracked_value() = default;
+    tracked_value(const std::string& a, int n) : s(a + std::to_string(n)) { ++constructs; }
+    tracked_value(const tracked_value& o) : s(o.s) { ++copies; }
+    tracked_value(tracked_value&& o) noexcept : s(std::move(o.s)) { ++moves; }
+    tracked_value& operator=(const tracked_value& o) { s = o.s; ++copies; return *this; }
+    tracked_value& operator=(tracked_value&& o) noexcept { s = std::move(o.s); ++moves; return *this; }
+};
+
+void test_emplace() {
+    std::cout << "Testing emplace/try_emplace...\n";
+    
+    {
+        string_trie<tracked_value> trie;
+        tracked_value::reset();
+        auto [it, inserted] = trie.try_emplace("a", "v", 1);
+        assert(inserted && it.value().s == "v1");
+        // Built once in its box; the only copy is the returned iterator's
+        assert(tracked_value::constructs == 1 && tracked_value::copies == 1);
+        
+        tracked_value::reset();
+        auto res = trie.try_emplace("a", "w", 2);
+        assert(!res.second && res.first.value().s == "v1");
+        assert(tracked_value::constructs == 0);
+        
+        string_trie<tracked_value> other;
+        tracked_value::reset();
+        assert(other.insert({"b", tracked_value("x", 3)}).second);
+        assert(tracked_value::constructs == 1 && tracked_value::copies == 1);
+        
+        assert(trie.insert({"ab", tracked_value("x", 3)}).second);  // "a" becomes EOS
+        assert(trie.emplace("abc", tracked_value("y", 4)).second);
+        assert(trie.emplace(std::piecewise_construct, std::forward_as_tuple("abd"),
+                            std::forward_as_tuple("z", 5)).second);
+        assert(!trie.emplace("abc", tracked_value("q", 0)).second);
+        assert(trie.size() == 4);
+        assert(trie.find("a").value().s == "v1");
+        assert(trie.find("ab").value().s == "x3");
+        assert(trie.find("abc").value().s == "y4");
+        assert(trie.find("abd").value().s == "z5");
+    }
+    {
+        // Inline values take the same path
+        int64_trie<int> trie;
+        for (int64_t i = 0; i < 300; ++i) assert(trie.try_emplace(i, static_cast<int>(i * 2)).second);
+        for (int64_t i = 0; i < 300; ++i) assert(!trie.try_emplace(i, -1).second);
+        for (int64_t i = 0; i < 300; ++i) assert(trie.find(i).value() == i * 2);
+    }
+    {
+        // Adopted boxes survive discarded speculation and retries
+        concurrent_string_trie<std::string> trie;
+        const int num_threads = 4;
+        const int per_thread = 1500;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < per_thread; ++i) {
+                    std::string k = "key" + std::to_string(i * num_threads + t);
+                    if (i % 2) trie.try_emplace(k, 40, static_cast<char>('a' + t));
+                    else trie.insert({k, std::string(40, static_cast<char>('a' + t))});
+                    trie.try_emplace("shared" + std::to_string(i % 64), 8, 's');
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        assert(trie.size() == static_cast<size_t>(num_threads * per_thread + 64));
+        for (int t = 0; t < num_threads; ++t) {
+            for (int i = 0; i < per_thread; ++i) {
+                auto it = trie.find("key" + std::to_string(i * num_threads + t));
+                assert(it.valid() && it.value() == std::string(40, static_cast<char>('a' + t)));
+            }
+        }
+    }
+    {
+        sharded_string_trie<std::string, 4> trie;
+        assert(trie.try_emplace("k", 3, 'x').second);
+        assert(!trie.try_emplace("k", 3, 'y').second);
+        assert(trie.emplace("m", "v").second);
+        assert(trie.find("k").value() == "xxx" && trie.find("m").value() == "v");
+    }
+    
+    std::cout << "  PASSED\n";
+}
+
+// Move-only values: node clones and iterators share the value's box
+template <typename Trie, typename MakeKey>
+void check_move_only(MakeKey make_key) {
+    using ptr = std::unique_ptr<int>;
+    Trie trie;
+    const int n = 2000;  // Enough to grow, split and shrink every node kind
+    for (int i = 0; i < n; ++i) {
+        if (i % 3 == 0) assert(trie.try_emplace(make_key(i), std::make_unique<int>(i)).second);
+        else if (i % 3 == 1) assert(trie.emplace(make_key(i), std::make_unique<int>(i)).second);
+        else assert(trie.insert({make_key(i), std::make_unique<int>(i)}).second);
+    }
+    auto [kept, inserted] = trie.try_emplace(make_key(7), std::make_unique<int>(-1));
+    assert(!inserted && *kept.value() == 7);
+    for (int i = 0; i < n; ++i) assert(*trie.find(make_key(i)).value() == i);
+
+    size_t count = 0;
+    for (auto it = trie.begin(); it != trie.end(); ++it) {
+        assert(*it.value() == *trie.find(it.key()).value());
+        ++count;
+    }
+    assert(count == static_cast<size_t>(n));
+
+    // An iterator keeps its value alive past the erase, and across the
+    // restructuring the later erases and overwrites cause
+    auto held = trie.find(make_key(1));
+    for (int i = 0; i < n; i += 2) assert(trie.erase(make_key(i)));
+    assert(!trie.upsert(make_key(1), [](const ptr* old) { return std::make_unique<int>(**old + 1000); }));
+    assert(trie.upsert(make_key(0), [](const ptr* old) { return std::make_unique<int>(old ? -1 : 0); }));
+    for (int i = 1; i < n; i += 2) assert(trie.erase(make_key(i)));
+    assert(*held.value() == 1);
+    assert(trie.size() == 1 && *trie.find(make_key(0)).value() == 0);
+    trie.clear();
+    assert(trie.empty() && *held.value() == 1);
+}
+
+void test_move_only_values() {
+    std::cout << "Testing move-only values...\n";
+
+    check_move_only<string_trie<std::unique_ptr<int>>>([](int i) { return "k" + std::to_string(i); });
+    check_move_only<int64_trie<std::unique_ptr<int>>>([](int i) { return static_cast<int64_t>(i) * 7; });
+    check_move_only<concurrent_string_trie<std::unique_ptr<int>>>([](int i) { return "k" + std::to_string(i); });
+    check_move_only<concurrent_int64_trie<std::unique_ptr<int>>>([](int i) { return static_cast<int64_t>(i) * 7; });
+    {
+        sharded_string_trie<std::unique_ptr<int>, 4> trie;
+        assert(trie.try_emplace("a", std::make_unique<int>(1)).second);
+        assert(trie.emplace("z", std::make_unique<int>(2)).second);
+        int sum = 0;
+        for (auto it = trie.begin(); it != trie.end(); ++it) sum += *it.value();
+        assert(sum == 3);
+    }
+    {
+        // Writers racing readers: clones share boxes the readers still hold
+        concurrent_string_trie<std::unique_ptr<int>> trie;
+        const int num_threads = 4;
+        const int per_thread = 1500;
+        std::atomic<bool> done{false};
+        std::thread reader([&]() {
+            while (!done.load()) {
+                for (auto it = trie.begin(); it != trie.end(); ++it) {
+                    assert(*it.value() >= 0);
+                }
+            }
+        });
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < per_thread; ++i) {
+                    int v = i * num_threads + t;
+                    trie.try_emplace("key" + std::to_string(v), std::make_unique<int>(v));
+                    if (i % 4 == 3) trie.erase("key" + std::to_string(v - 2 * num_threads));
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        done.store(true);
+        reader.join();
+        assert(trie.size() == static_cast<size_t>(num_threads * (per_thread - per_thread / 4)));
+        for (auto it = trie.begin(); it != trie.end(); ++it) {
+            assert("key" + std::to_string(*it.value()) == it.key());
+        }
+    }
+
+    std::cout << "  PASSED\n";
+}
+
+// The trie holds exactly the oracle's entries: walks its iterators both ways
+template <typename Trie, typename Key, typename V>
+void check_against_oracle(const Trie& trie, const std::map<Key, V>& oracle) {
+    assert(trie.size() == oracle.size());
+    auto mit = oracle.begin();
+    for (auto it = trie.begin(); it != trie.end(); ++it, ++mit) {
+        assert(mit != oracle.end());
+        assert(it.key() == mit->first && it.value() == mit->second);
+    }
+    assert(mit == oracle.end());
+    auto rmit = oracle.rbegin();
+    for (auto it = trie.rbegin(); it != trie.rend(); ++it, ++rmit) {
+        assert(rmit != oracle.rend());
+        assert(it.key() == rmit->first && it.value() == rmit->second);
+    }
+    assert(rmit == oracle.rend());
+}
+
+// A trie and a std::map kept in step by the randomized tests
+template <typename Trie, typename Key>
+struct oracle_fixture {
+    std::mt19937 rng;
+    Trie trie;
+    std::map<Key, int> oracle;
+
+    explicit oracle_fixture(unsigned seed) : rng(seed) {}
+
+    // Both keep the first value inserted for a key
+    bool insert(const Key& k, int v) {
+        bool added = oracle.emplace(k, v).second;
+        bool inserted = trie.insert({k, v}).second;
+        assert(inserted == added);
+        return added;
+    }
+
+    bool erase(const Key& k) {
+        bool had = oracle.erase(k) == 1;
+        bool erased = trie.erase(k);
+        assert(erased == had);
+        return had;
+    }
+
+    void check() const { check_against_oracle(trie, oracle); }
+};
+
+template <typename Trie>
+void check_cursor_strings() {
+    std::mt19937 rng(13);
+    Trie trie;
+    std::map<std::string, int> oracle;
+    // Short keys over a small alphabet: plenty of EOS values, shared prefixes
+    // and every node type
+    for (int i = 0; i < 3000; ++i) {
+        std::string k;
+        int len = static_cast<int>(rng() % 7);
+        for (int j = 0; j < len; ++j) k.push_back(static_cast<char>("abcz\x01\xff"[rng() % 6]));
+        trie.insert({k, i});
+        oracle.emplace(k, i);
+    }
+    for (int i = 0; i < 300; ++i) {
+        std::string k(1 + rng() % 60, static_cast<char>('a' + rng() % 3));  // Deeper than the inline frames
+        trie.insert({k, i});
+        oracle.emplace(k, i);
+    }
+    check_against_oracle(trie, oracle);
+
+    // Mixed ++/-- from the middle
+    auto it = trie.find(oracle.begin()->first);
+    auto mit = oracle.begin();
+    for (int i = 0; i < 2000; ++i) {
+        if (rng() % 3 == 0 && mit != oracle.begin()) {
+            --it;
+            --mit;
+        } else if (std::next(mit) != oracle.end()) {
+            ++it;
+            ++mit;
+        }
+        assert(it.valid() && it.key() == mit->first && it.value() == mit->second);
+    }
+
+    // Erasing around a live iterator: it re-seeks from its cached key
+    it = trie.begin();
+    mit = oracle.begin();
+    while (it != trie.end()) {
+        std::string k = it.key();
+        assert(k == mit->first);
+        ++mit;
+        if (rng() % 2) {
+            trie.erase(k);
+            mit = std::next(oracle.find(k));
+            oracle.erase(k);
+        }
+        ++it;
+    }
+    assert(mit == oracle.end());
+    check_against_oracle(trie, oracle);
+
+    // Inserting behind and ahead of a live iterator
+    it = trie.begin();
+    std::advance(it, static_cast<long>(oracle.size() / 2));
+    std::string mid = it.key();
+    trie.insert({mid + "zz", -1});
+    oracle.emplace(mid + "zz", -1);
+    trie.insert({"", -2});
+    oracle.emplace("", -2);
+    ++it;
+    assert(it.key() == std::next(oracle.find(mid))->first);
+    check_against_oracle(trie, oracle);
+
+    // Clearing under an iterator leaves it with nothing to step to
+    it = trie.begin();
+    trie.clear();
+    ++it;
+    assert(it == trie.end());
+}
+
+void test_cursor_iteration() {
+    std::cout << "Testing cursor iteration...\n";
+    
+    check_cursor_strings<string_trie<int>>();
+    check_cursor_strings<concurrent_string_trie<int>>();
+    {
+        std::mt19937 rng(7);
+        int64_trie<int> trie;
+        std::map<int64_t, int> oracle;
+        for (int i = 0; i < 5000; ++i) {
+            int64_t k = static_cast<int64_t>(rng() % 20000) - 10000;
+            if (i % 3 == 0) k *= 1000003;
+            trie.insert({k, i});
+            oracle.emplace(k, i);
+        }
+        check_against_oracle(trie, oracle);
+        for (auto it = oracle.begin(); it != oracle.end();) {
+            if (rng() % 2) {
+                trie.erase(it->first);
+                it = oracle.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        check_against_oracle(trie, oracle);
+    }
+    {
+        // Scans see every stable key, in order, while writers churn others
+        concurrent_int32_trie<int> trie;
+        for (int32_t i = 0; i < 4000; i += 2) trie.insert({i, i});
+        std::atomic<bool> stop{false};
+        std::thread writer([&]() {
+            std::mt19937 rng(1);
+            while (!stop.load()) {
+                int32_t k = static_cast<int32_t>(rng() % 2000) * 2 + 1;
+                if (rng() % 2) trie.insert({k, k});
+                else trie.erase(k);
+            }
+        });
+        for (int round = 0; round < 20; ++round) {
+            int32_t prev = -1;
+            int32_t next_even = 0;
+            for (auto it = trie.begin(); it != trie.end(); ++it) {
+                int32_t k = it.key();
+                assert(k > prev && it.value() == k);
+                if (k % 2 == 0) {
+                    assert(k == next_even);
+                    next_even += 2;
+                }
+                prev = k;
+            }
+            assert(next_even == 4000);
+        }
+        stop.store(true);
+        writer.join();
+    }
+    
+    std::cout << "  PASSED\n";
+}
+
+template <typename Trie>
+void check_prefix_scan() {
+    std::mt19937 rng(14);
+    Trie trie;
+    std::map<std::string, int> oracle;
+    const char* parts[] = {"cpu", "mem", "disk", "c", "", "\xff"};
+    for (int i = 0; i < 2000; ++i) {
+        std::string k;
+        int depth = 1 + static_cast<int>(rng() % 4);
+        for (int d = 0; d < depth; ++d) {
+            k += parts[rng() % 6];
+            if (rng() % 2) k += std::to_string(rng() % 20);
+            if (d + 1 < depth) k += '.';
+        }
+        trie.insert({k, i});
+        oracle.emplace(k, i);
+    }
+    std::vector<std::string> prefixes = {"", "c", "cpu", "cpu.", "cpu1", "mem.disk", "zzz", "\xff", "\xff\xff"};
+    for (int i = 0; i < 200; ++i) {
+        auto it = oracle.begin();
+        std::advance(it, static_cast<long>(rng() % oracle.size()));
+        prefixes.push_back(it->first.substr(0, rng() % (it->first.size() + 1)));
+    }
+    for (const auto& p : prefixes) {
+        std::vector<std::pair<std::string, int>> want;
+        for (auto it = oracle.lower_bound(p); it != oracle.end() && it->first.starts_with(p); ++it) {
+            want.emplace_back(*it);
+        }
+        std::vector<std::pair<std::string, int>> got;
+        trie.for_each_with_prefix(p, [&](std::string_view k, const int& v) { got.emplace_back(k, v); });
+        assert(got == want);
+        
+        got.clear();
+        auto range = trie.prefix_range(p);
+        for (auto it = range.begin(); it != range.end(); ++it) got.emplace_back(it.key(), it.value());
+        assert(got == want);
+        assert(range.empty() == want.empty());
+    }
+}
+
+void test_prefix_scan() {
+    std::cout << "Testing prefix scans...\n";
+    
+    check_prefix_scan<string_trie<int>>();
+    check_prefix_scan<concurrent_string_trie<int>>();
+    {
+        // Values are visited in place
+        string_trie<std::string> trie;
+        trie.insert({"a/1", std::string(100, '1')});
+        trie.insert({"a/2", std::string(100, '2')});
+        trie.insert({"b/1", std::string(100, '3')});
+        std::vector<const std::string*> seen;
+        trie.for_each_with_prefix("a/", [&](std::string_view, const std::string& v) { seen.push_back(&v); });
+        assert(seen.size() == 2);
+        auto g = trie.find_ref("a/2");
+        assert(seen[1] == &*g);
+        
+        const auto& ctrie = trie;
+        int n = 0;
+        for (const auto& [k, v] : ctrie.prefix_range("b")) n += k == "b/1" && v[0] == '3';
+        assert(n == 1);
+    }
+    {
+        // The end is a bound, not a position: writes after the call can't
+        // move the walk past the prefix
+        string_trie<int> trie;
+        for (const char* k : {"a1", "a2", "c"}) trie.insert({k, 1});
+        auto range = trie.prefix_range("a");
+        trie.insert({"b", 2});   // Sorts before the old end position "c"
+        trie.erase("c");         // The old end position goes away
+        std::vector<std::string> got;
+        for (auto& kv : range) got.push_back(kv.first);
+        assert((got == std::vector<std::string>{"a1", "a2"}));
+        assert(trie.prefix_range("b").begin()->second == 2);
+        assert(trie.prefix_range("zz").empty());
+        
+        auto [lo, hi] = trie.equal_range("a1");
+        assert(hi.valid() && hi.key() == "a2");  // Still upper_bound's position
+        trie.erase("a2");
+        int n = 0;
+        for (auto it = lo; it != hi; ++it) ++n;
+        assert(n == 1);
+    }
+    {
+        // Scans under concurrent writers see every stable key in the subtree
+        concurrent_string_trie<int> trie;
+        for (int i = 0; i < 500; ++i) trie.insert({"app/" + std::to_string(i), i});
+        std::atomic<bool> stop{false};
+        std::thread writer([&]() {
+            std::mt19937 rng(3);
+            while (!stop.load()) {
+                std::string k = (rng() % 2 ? "app/x" : "apq/") + std::to_string(rng() % 500);
+                if (rng() % 2) trie.insert({k, -1});
+                else trie.erase(k);
+            }
+        });
+        for (int round = 0; round < 50; ++round) {
+            int stable = 0;
+            std::string prev;
+            trie.for_each_with_prefix("app/", [&](std::string_view k, const int& v) {
+                assert(k.starts_with("app/") && std::string(k) > prev);
+                prev = k;
+                if (v >= 0) ++stable;
+            });
+            assert(stable == 500);
+        }
+        stop.store(true);
+        writer.join();
+    }
+    {
+        sharded_string_trie<int, 4> trie;
+        for (const char* k : {"a1", "a2", "b1", "\xf0z"}) trie.insert({k, 1});
+        int n = 0;
+        trie.for_each_with_prefix("a", [&](std::string_view, const int&) { ++n; });
+        assert(n == 2);
+        n = 0;
+        trie.for_each_with_prefix("", [&](std::string_view, const int&) { ++n; });
+        assert(n == 4);
+    }
+    
+    std::cout << "  PASSED\n";
+}
+
+template <typename Trie, typename Key>
+void check_bounds() {
+    std::mt19937 rng(15);
+    Trie trie;
+    std::map<Key, int> oracle;
+    auto rand_key = [&]() -> Key {
+        if constexpr (std::is_same_v<Key, std::string>) {
+            std::string k;
+            for (int i = 0, n = static_cast<int>(rng() % 5); i < n; ++i) k += static_cast<char>("ab\xff"[rng() % 3]);
+            return k;
+        } else {
+            return static_cast<Key>(static_cast<int>(rng() % 2000) - 1000);
+        }
+    };
+    for (int i = 0; i < 500; ++i) {
+        Key k = rand_key();
+        trie.insert({k, i});
+        oracle.emplace(k, i);
+    }
+    const Trie& ctrie = trie;
+    for (int i = 0; i < 500; ++i) {
+        Key k = rand_key();
+        auto lo = trie.lower_bound(k);
+        auto olo = oracle.lower_bound(k);
+        assert(lo.valid() == (olo != oracle.end()));
+        if (lo.valid()) assert(lo.key() == olo->first && lo.value() == olo->second);
+        auto hi = ctrie.upper_bound(k);
+        auto ohi = oracle.upper_bound(k);
+        assert(hi.valid() == (ohi != oracle.end()));
+        if (hi.valid()) assert(hi.key() == ohi->first);
+        auto [a, b] = trie.equal_range(k);
+        assert((a != b) == oracle.contains(k));
+        
+        Key k2 = rand_key();
+        size_t limit = rng() % 3 ? SIZE_MAX : rng() % 10;
+        std::vector<std::pair<Key, int>> want;
+        for (auto it = oracle.lower_bound(k); k < k2 && it != oracle.end() && it->first < k2 && want.size() < limit; ++it) {
+            want.emplace_back(*it);
+        }
+        std::vector<std::pair<Key, int>> got;
+        size_t n = trie.scan(k, k2, [&](const Key& key, const int& v) { got.emplace_back(key, v); }, limit);
+        assert(n == got.size() && got == want);
+    }
+}
+
+void test_bounds_and_scan() {
+    std::cout << "Testing lower_bound/upper_bound/scan...\n";
+    
+    check_bounds<int64_trie<int>, int64_t>();
+    check_bounds<concurrent_int32_trie<int>, int32_t>();
+    check_bounds<string_trie<int>, std::string>();
+    {
+        // Reverse iterators from a bound walk down
+        int64_trie<int> trie;
+        for (int64_t i = 0; i < 100; i += 10) trie.insert({i, static_cast<int>(i)});
+        auto it = trie.lower_bound(35);
+        assert(it.key() == 40);
+        --it;
+        assert(it.key() == 30);
+        assert(!trie.lower_bound(91).valid());
+        assert(trie.upper_bound(-5).key() == 0);
+    }
+    {
+        sharded_int32_trie<int, 4> trie;
+        std::map<int32_t, int> oracle;
+        for (int32_t i = -3000000; i < 3000000; i += 7919) {
+            trie.insert({i * 331, i});
+            oracle.emplace(i * 331, i);
+        }
+        for (int32_t k : {INT32_MIN, -5, 0, 12345, 1 << 30}) {
+            auto it = trie.lower_bound(k);
+            auto oit = oracle.lower_bound(k);
+            assert(it.valid() == (oit != oracle.end()));
+            if (it.valid()) assert(it.key() == oit->first);
+        }
+        std::vector<int32_t> got;
+        trie.scan(-100000000, 100000000, [&](const int32_t& k, const int&) { got.push_back(k); });
+        std::vector<int32_t> want;
+        for (auto it = oracle.lower_bound(-100000000); it != oracle.lower_bound(100000000); ++it) want.push_back(it->first);
+        assert(got == want);
+        assert(trie.scan(-100000000, 100000000, [](const int32_t&, const int&) {}, 3) == 3);
+    }
+    
+    std::cout << "  PASSED\n";
+}
+
+template <typename Trie, typename Key, typename MakeKey>
+void check_batch_lookup(MakeKey make_key) {
+    oracle_fixture<Trie, Key> f(16);
+    for (int i = 0; i < 3000; i += 2) f.insert(make_key(i), i);
+    for (size_t n : {0, 1, 15, 16, 17, 300}) {
+        std::vector<Key> keys;
+        for (size_t i = 0; i < n; ++i) keys.push_back(make_key(static_cast<int>(f.rng() % 3200)));
+        std::vector<std::optional<int>> vals(n, 7);
+        std::unique_ptr<bool[]> present(new bool[n + 1]);
+        size_t hits = f.trie.find_batch(keys, vals);
+        assert(f.trie.contains_batch(keys, std::span<bool>(present.get(), n)) == hits);
+        size_t want = 0;
+        for (size_t i = 0; i < n; ++i) {
+            auto o = f.oracle.find(keys[i]);
+            bool found = o != f.oracle.end();
+            assert(vals[i].has_value() == found && present[i] == found);
+            if (found) {
+                assert(*vals[i] == o->second);
+                ++want;
+            }
+        }
+        assert(hits == want);
+    }
+}
+
+void test_batch_lookup() {
+    std::cout << "Testing find_batch/contains_batch...\n";
+    
+    check_batch_lookup<int64_trie<int>, int64_t>([](int i) { return static_cast<int64_t>(i) * 7919; });
+    check_batch_lookup<concurrent_int32_trie<int>, int32_t>([](int i) { return i - 1500; });
+    check_batch_lookup<string_trie<int>, std::string>([](int i) { return "k/" + std::to_string(i); });
+    check_batch_lookup<concurrent_string_trie<int>, std::string>([](int i) { return std::string(i % 7, 'x') + std::to_string(i); });
+    {
+        // Empty trie, and non-inline values
+        string_trie<std::string> trie;
+        std::vector<std::string> keys = {"a", "b"};
+        std::vector<std::optional<std::string>> vals(2);
+        assert(trie.find_batch(keys, vals) == 0 && !vals[0] && !vals[1]);
+        trie.insert({"b", std::string(100, 'b')});
+        assert(trie.find_batch(keys, vals) == 1 && !vals[0] && *vals[1] == std::string(100, 'b'));
+    }
+    {
+        // Keys that stay put are always found while writers churn the others
+        concurrent_int64_trie<int64_t> trie;
+        for (int64_t i = 0; i < 2000; ++i) trie.insert({i * 2, i});
+        std::atomic<bool> stop{false};
+        std::thread writer([&]() {
+            std::mt19937 rng(5);
+            while (!stop.load()) {
+                int64_t k = static_cast<int64_t>(rng() % 2000) * 2 + 1;
+                if (rng() % 2) trie.insert({k, -1});
+                else trie.erase(k);
+            }
+        });
+        std::vector<int64_t> keys;
+        for (int64_t i = 0; i < 256; ++i) keys.push_back(i * 14);
+        std::vector<std::optional<int64_t>> vals(keys.size());
+        for (int round = 0; round < 200; ++round) {
+            assert(trie.find_batch(keys, vals) == keys.size());
+            for (size_t i = 0; i < keys.size(); ++i) assert(*vals[i] == keys[i] / 2);
+        }
+        stop.store(true);
+        writer.join();
+    }
+    
+    std::cout << "  PASSED\n";
+}
+
+// Every node type at every level: runs of 1, 2, 5, 20 and 100 siblings
+template <typename Trie, typename Key, typename MakeKey>
+void check_bulk_load(MakeKey make_key) {
+    oracle_fixture<Trie, Key> f(17);
+    std::vector<std::pair<Key, int>> kvs;
+    for (int i = 0; i < 5000; ++i) kvs.emplace_back(make_key(f.rng), i);
+    for (const auto& [k, v] : kvs) f.insert(k, v);  // First of duplicates wins
+    const auto& oracle = f.oracle;
+    
+    Trie unsorted;
+    assert(unsorted.bulk_insert(kvs.begin(), kvs.end()) == oracle.size());
+    Trie sorted;
+    assert(sorted.build_from_sorted(oracle.begin(), oracle.end()) == oracle.size());
+    
+    for (Trie* t : {&unsorted, &sorted}) {
+        check_against_oracle(*t, oracle);
+        // A loaded trie takes writes like one built by insert()
+        size_t n = 0;
+        for (const auto& [k, v] : oracle) {
+            if (n++ % 3 == 0) {
+                assert(t->erase(k));
+            } else {
+                assert(!t->insert({k, -1}).second);
+            }
+        }
+        for (const auto& [k, v] : oracle) t->insert({k, v});
+        for (const auto& [k, v] : oracle) assert(t->find(k).value() == v);
+        assert(t->size() == f.trie.size());
+    }
+}
+
+void test_bulk_load() {
+    std::cout << "Testing build_from_sorted/bulk_insert...\n";
+    
+    static const int fan[] = {1, 2, 5, 20, 100};
+    check_bulk_load<int64_trie<int>, int64_t>([](std::mt19937& rng) {
+        int64_t k = 0;
+        for (int b = 0; b < 8; ++b) k = (k << 8) | static_cast<int64_t>(rng() % fan[(b + rng() % 2) % 5]);
+        return rng() % 2 ? k : -k;
+    });
+    check_bulk_load<concurrent_int32_trie<int>, int32_t>([](std::mt19937& rng) {
+        return static_cast<int32_t>(rng() % 20000) - 10000;
+    });
+    check_bulk_load<string_trie<int>, std::string>([](std::mt19937& rng) {
+        std::string k;
+        for (int i = 0, n = static_cast<int>(rng() % 6); i < n; ++i) {
+            k += static_cast<char>('a' + rng() % fan[rng() % 5]);
+            if (rng() % 4 == 0) k += "shared/";
+        }
+        return k;
+    });
+    check_bulk_load<concurrent_string_trie<int>, std::string>([](std::mt19937& rng) {
+        return std::to_string(rng() % 3000);
+    });
+    {
+        // Non-empty target: merged in, existing values kept
+        int64_trie<int> trie;
+        trie.insert({5, 50});
+        std::vector<std::pair<int64_t, int>> kvs = {{1, 1}, {5, 5}, {9, 9}};
+        assert(trie.build_from_sorted(kvs.begin(), kvs.end()) == 2);
+        assert(trie.size() == 3 && trie.find(5).value() == 50);
+        assert(trie.bulk_insert(kvs.begin(), kvs.begin()) == 0);
+    }
+    {
+        // Readers of the empty trie see the loaded one appear whole
+        concurrent_int64_trie<int64_t> trie;
+        std::vector<std::pair<int64_t, int64_t>> kvs;
+        for (int64_t i = 0; i < 20000; ++i) kvs.emplace_back(i * 3, i);
+        std::atomic<bool> stop{false};
+        std::thread reader([&]() {
+            while (!stop.load()) {
+                size_t n = trie.size();
+                if (trie.contains(300)) assert(trie.contains(59997));
+                assert(n == 0 || n == kvs.size());
+            }
+        });
+        assert(trie.build_from_sorted(kvs.begin(), kvs.end()) == kvs.size());
+        stop.store(true);
+        reader.join();
+        for (int64_t i = 0; i < 20000; i += 7) assert(trie.find(i * 3).value() == i);
+    }
+    
+    std::cout << "  PASSED\n";
+}
+
+// Random batches of inserts and erases against std::map
+template <typename Trie, typename Key, typename MakeKey>
+void check_insert_erase_batch(MakeKey make_key) {
+    oracle_fixture<Trie, Key> f(18);
+    for (int round = 0; round < 40; ++round) {
+        std::vector<std::pair<Key, int>> kvs;
+        for (int i = 0, n = static_cast<int>(f.rng() % 400); i < n; ++i) kvs.emplace_back(make_key(f.rng), round * 1000 + i);
+        size_t added = 0;
+        for (const auto& [k, v] : kvs) added += f.oracle.emplace(k, v).second;
+        assert(f.trie.insert_batch(kvs) == added);
+        
+        std::vector<Key> keys;
+        for (int i = 0, n = static_cast<int>(f.rng() % 300); i < n; ++i) keys.push_back(make_key(f.rng));
+        size_t removed = 0;
+        for (const Key& k : keys) removed += f.oracle.erase(k);
+        assert(f.trie.erase_batch(keys) == removed);
+        f.check();
+    }
+}
+
+void test_insert_erase_batch() {
+    std::cout << "Testing insert_batch/erase_batch...\n";
+    
+    check_insert_erase_batch<int64_trie<int>, int64_t>([](std::mt19937& rng) {
+        return static_cast<int64_t>(rng() % 4000) * (rng() % 2 ? 1 : 1000003);
+    });
+    check_insert_erase_batch<concurrent_int32_trie<int>, int32_t>([](std::mt19937& rng) {
+        return static_cast<int32_t>(rng() % 3000) - 1500;
+    });
+    check_insert_erase_batch<string_trie<int>, std::string>([](std::mt19937& rng) {
+        std::string k;
+        for (int i = 0, n = static_cast<int>(rng() % 5); i < n; ++i) k += static_cast<char>('a' + rng() % 12);
+        return k;
+    });
+    check_insert_erase_batch<concurrent_string_trie<int>, std::string>([](std::mt19937& rng) {
+        return std::to_string(rng() % 2000);
+    });
+    {
+        // A binary leaf and a binary interior node each grow to full in one batch
+        string_trie<int> trie;
+        trie.insert({"ka", 0});
+        trie.insert({"kb", 0});
+        trie.insert({"x/a", 0});
+        trie.insert({"x/b/", 0});
+        std::vector<std::pair<std::string, int>> kvs;
+        for (int c = 0; c < 256; ++c) {
+            kvs.emplace_back(std::string("k") + static_cast<char>(c), c);
+            kvs.emplace_back(std::string("x/") + static_cast<char>(c) + "/", c);
+        }
+        kvs.emplace_back("x/", 1);
+        assert(trie.insert_batch(kvs) == 2 * 256 - 3 + 1);
+        assert(trie.find("ka").value() == 0 && trie.find("kz").value() == 'z');
+        assert(trie.find("x/b/").value() == 0 && trie.find("x/c/").value() == 'c');
+        assert(trie.find("x/").value() == 1 && trie.find("x/a").value() == 0);
+        assert(trie.size() == 2 * 256 + 2);
+        assert(trie.insert_batch(kvs) == 0);
+    }
+    {
+        // Readers see each key either before or after its batch
+        concurrent_int64_trie<int64_t> trie;
+        for (int64_t i = 0; i < 20000; i += 2) trie.insert({i, i});
+        std::atomic<bool> stop{false};
+        std::thread reader([&]() {
+            std::mt19937 rng(3);
+            while (!stop.load()) {
+                int64_t k = static_cast<int64_t>(rng() % 20000);
+                auto it = trie.find(k);
+                assert(!it.valid() || it.value() == k);
+                if (k % 2 == 0 && k % 6 != 0) assert(it.valid());
+            }
+        });
+        for (int64_t base = 0; base < 20000; base += 1000) {
+            std::vector<std::pair<int64_t, int64_t>> kvs;
+            std::vector<int64_t> gone;
+            for (int64_t i = base + 1; i < base + 1000; i += 2) kvs.emplace_back(i, i);
+            for (int64_t i = (base + 5) / 6 * 6; i < base + 1000; i += 6) gone.push_back(i);
+            assert(trie.insert_batch(kvs) == kvs.size());
+            assert(trie.erase_batch(gone) == gone.size());
+        }
+        stop.store(true);
+        reader.join();
+        assert(trie.size() == 20000 - (20000 + 5) / 6);
+    }
+    
+    std::cout << "  PASSED\n";
+}
+
+// Erase random [lo, hi) ranges, checking the rest against std::map
+template <typename Trie, typename Key, typename MakeKey>
+void check_erase_range(MakeKey make_key) {
+    oracle_fixture<Trie, Key> f(19);
+    auto& oracle = f.oracle;
+    for (int round = 0; round < 60; ++round) {
+        for (int i = 0, n = static_cast<int>(f.rng() % 600); i < n; ++i) f.insert(make_key(f.rng), i);
+        Key lo = make_key(f.rng), hi = make_key(f.rng);
+        if (hi < lo) std::swap(lo, hi);
+        size_t expect = std::distance(oracle.lower_bound(lo), oracle.lower_bound(hi));
+        oracle.erase(oracle.lower_bound(lo), oracle.lower_bound(hi));
+        assert(f.trie.erase_range(lo, hi) == expect);
+        f.check();
+    }
+}
+
+void test_erase_range() {
+    std::cout << "Testing erase_prefix/erase_range...\n";
+    
+    check_erase_range<int64_trie<int>, int64_t>([](std::mt19937& rng) {
+        return static_cast<int64_t>(rng() % 5000) * (rng() % 3 ? 1 : 65537) - 2000;
+    });
+    check_erase_range<concurrent_int32_trie<int>, int32_t>([](std::mt19937& rng) {
+        return static_cast<int32_t>(rng() % 4000) - 2000;
+    });
+    check_erase_range<string_trie<int>, std::string>([](std::mt19937& rng) {
+        std::string k;
+        for (int i = 0, n = static_cast<int>(rng() % 5); i < n; ++i) k += static_cast<char>('a' + rng() % 10);
+        return k;
+    });
+    check_erase_range<concurrent_string_trie<int>, std::string>([](std::mt19937& rng) {
+        return std::to_string(rng() % 3000);
+    });
+    {
+        string_trie<int> trie;
+        for (const char* k : {"", "a", "t/1/x", "t/1/y", "t/1", "t/10", "t/2/x", "t\xff", "u"}) trie.insert({k, 1});
+        assert(trie.erase_prefix("t/1/") == 2);
+        assert(trie.erase_prefix("t/1") == 2);
+        assert(trie.erase_prefix("q") == 0);
+        assert(trie.size() == 5 && trie.contains("t/2/x") && trie.contains("t\xff") && trie.contains(""));
+        assert(trie.erase_prefix("t") == 2);
+        assert(trie.erase_prefix("") == 3 && trie.empty());
+        trie.insert({"back", 2});
+        assert(trie.find("back").value() == 2 && trie.size() == 1);
+    }
+    {
+        sharded_int32_trie<int, 4> trie;
+        for (int32_t i = -500; i < 500; ++i) trie.insert({i, i});
+        assert(trie.erase_range(-100, 300) == 400);
+        assert(trie.size() == 600 && trie.contains(-101) && !trie.contains(0) && trie.contains(300));
+        sharded_string_trie<int, 4> strs;
+        for (const char* k : {"a/1", "a/2", "b/1", "\xf0/1"}) strs.insert({k, 1});
+        assert(strs.erase_prefix("a/") == 2 && strs.size() == 2);
+        assert(strs.erase_prefix("") == 2 && strs.empty());
+    }
+    {
+        // Expiring time buckets while readers check the survivors
+        concurrent_int64_trie<int64_t> trie;
+        for (int64_t i = 0; i < 40000; ++i) trie.insert({i, i});
+        std::atomic<int64_t> expired{0};
+        std::atomic<bool> stop{false};
+        std::thread reader([&]() {
+            std::mt19937 rng(4);
+            while (!stop.load()) {
+                int64_t k = static_cast<int64_t>(rng() % 40000);
+                auto it = trie.find(k);
+                // k's bucket is erased only after expired reaches it
+                if (k >= expired.load() + 1000) assert(it.valid() && it.value() == k);
+                if (it.valid()) assert(it.value() == k);
+            }
+        });
+        for (int64_t lo = 0; lo < 40000; lo += 1000) {
+            assert(trie.erase_range(lo, lo + 1000) == 1000);
+            expired.store(lo + 1000);
+        }
+        stop.store(true);
+        reader.join();
+        assert(trie.empty());
+    }
+    
+    std::cout << "  PASSED\n";
+}
+
+// Each query's answer against the longest of its prefixes in a std::map
+template <typename Trie>
+void check_longest_prefix_match() {
+    std::mt19937 rng(20);
+    auto make = [&](int max_len) {
+        std::string k;
+        for (int i = 0, n = static_cast<int>(rng() % max_len); i < n; ++i) k += static_cast<char>('a' + rng() % 3);
+        return k;
+    };
+    Trie trie;
+    std::map<std::string, int> oracle;
+    for (int i = 0; i < 400; ++i) {
+        std::string k = make(8);
+        if (oracle.emplace(k, i).second) trie.insert({k, i});
+    }
+    for (int i = 0; i < 3000; ++i) {
+        std::string q = make(12);
+        auto it = trie.longest_prefix_match(q);
+        size_t len = q.size() + 1;
+        while (len-- > 0 && !oracle.count(q.substr(0, len))) {}
+        if (len == std::string::npos) {
+            assert(!it.valid());
+        } else {
+            assert(it.valid() && it.key() == q.substr(0, len) && it.value() == oracle[q.substr(0, len)]);
+        }
+    }
+}
+
+void test_longest_prefix_match() {
+    std::cout << "Testing longest_prefix_match...\n";
+    
+    {
+        string_trie<int> trie;
+        for (const char* k : {"/api", "/api/v1", "/api/v1/users", "/static"}) trie.insert({k, static_cast<int>(std::string_view(k).size())});
+        assert(trie.longest_prefix_match("/api/v1/users/42").key() == "/api/v1/users");
+        assert(trie.longest_prefix_match("/api/v2").key() == "/api");
+        assert(trie.longest_prefix_match("/api").value() == 4);
+        assert(!trie.longest_prefix_match("/ap").valid());
+        trie.insert({"", 0});
+        assert(trie.longest_prefix_match("/ap").key().empty());
+        const auto& ctrie = trie;
+        assert(ctrie.longest_prefix_match("/static/app.js").value() == 7);
+    }
+    check_longest_prefix_match<string_trie<int>>();
+    check_longest_prefix_match<concurrent_string_trie<int>>();
+    {
+        // Bit-granular routes: one '0'/'1' byte per bit of the prefix
+        auto bits = [](uint32_t addr, int n) {
+            std::string s;
+            for (int i = 0; i < n; ++i) s += (addr >> (31 - i)) & 1 ? '1' : '0';
+            return s;
+        };
+        string_trie<int> routes;
+        routes.insert({bits(0x0A000000, 8), 1});   // 10.0.0.0/8
+        routes.insert({bits(0x0A010000, 16), 2});  // 10.1.0.0/16
+        routes.insert({bits(0x0A010180, 25), 3});  // 10.1.1.128/25
+        routes.insert({bits(0, 0), 0});            // default
+        assert(routes.longest_prefix_match(bits(0x0A0101C8, 32)).value() == 3);
+        assert(routes.longest_prefix_match(bits(0x0A010164, 32)).value() == 2);
+        assert(routes.longest_prefix_match(bits(0x0A7F0001, 32)).value() == 1);
+        assert(routes.longest_prefix_match(bits(0xC0A80001, 32)).value() == 0);
+    }
+    {
+        sharded_string_trie<int, 4> trie;
+        trie.insert({"", 0});
+        trie.insert({"\xf0/a", 1});
+        assert(trie.longest_prefix_match("\xf0/a/b").value() == 1);
+        assert(trie.longest_prefix_match("\xf0/b").value() == 0);
+    }
+    {
+        // Readers always find at least the stable shorter key, never a torn answer
+        concurrent_string_trie<int> trie;
+        trie.insert({"net/", 4});
+        std::atomic<bool> stop{false};
+        std::thread reader([&]() {
+            while (!stop.load()) {
+                auto it = trie.longest_prefix_match("net/10/1/x");
+                assert(it.valid() && it.value() == static_cast<int>(it.key().size()));
+            }
+        });
+        for (int i = 0; i < 3000; ++i) {
+            trie.insert({"net/10", 6});
+            trie.insert({"net/10/1", 8});
+            trie.erase("net/10");
+            trie.erase("net/10/1");
+        }
+        stop.store(true);
+        reader.join();
+    }
+    
+    std::cout << "  PASSED\n";
+}
+
+// An aggregate key: tenant, then timestamp, then sequence number
+struct event_key {
+    uint32_t tenant;
+    int64_t ts;
+    uint16_t seq;
+    static constexpr auto trie_key_fields = std::tuple{&event_key::tenant, &event_key::ts, &event_key::seq};
+    auto operator<=>(const event_key&) const = default;
+};
+
+void test_composite_keys() {
+    std::cout << "Testing composite keys...\n";
+    
+    using event_tuple = std::tuple<uint32_t, int64_t, uint16_t>;
+    static_assert(TrieKey<std::string> && TrieKey<int16_t> && TrieKey<event_tuple> && TrieKey<event_key>);
+    static_assert(!TrieKey<std::vector<int>> && !TrieKey<std::pair<std::string, int>>);
+    static_assert(tktrie<event_tuple, int>::FIXED_LEN == 14 && tktrie<event_key, int>::FIXED_LEN == 14);
+    static_assert(tktrie<std::pair<int32_t, std::pair<uint8_t, int8_t>>, int>::FIXED_LEN == 6);
+    
+    auto make_tuple_key = [](std::mt19937& rng) {
+        return event_tuple(rng() % 4, static_cast<int64_t>(rng() % 600) - 300, static_cast<uint16_t>(rng() % 3 * 0x7fff));
+    };
+    check_erase_range<tktrie<event_tuple, int>, event_tuple>(make_tuple_key);
+    check_erase_range<tktrie<event_tuple, int, true>, event_tuple>(make_tuple_key);
+    check_bulk_load<tktrie<std::pair<int32_t, uint8_t>, int>, std::pair<int32_t, uint8_t>>([](std::mt19937& rng) {
+        return std::pair<int32_t, uint8_t>(static_cast<int32_t>(rng() % 3000) - 1500, static_cast<uint8_t>(rng()));
+    });
+    check_insert_erase_batch<tktrie<event_key, int, true>, event_key>([](std::mt19937& rng) {
+        return event_key{static_cast<uint32_t>(rng() % 3), static_cast<int64_t>(rng() % 2000) - 1000, static_cast<uint16_t>(rng() % 2)};
+    });
+    {
+        // One tenant's events, in time order, from a range scan
+        tktrie<event_key, int> trie;
+        for (uint32_t t = 0; t < 3; ++t) {
+            for (int64_t ts = -50; ts < 50; ++ts) trie.insert({{t, ts * 1000, static_cast<uint16_t>(ts & 7)}, static_cast<int>(ts)});
+        }
+        std::vector<int> seen;
+        trie.scan({1, INT64_MIN, 0}, {2, INT64_MIN, 0}, [&](const event_key& k, const int& v) {
+            assert(k.tenant == 1 && k.ts == v * 1000);
+            seen.push_back(v);
+        });
+        assert(seen.size() == 100 && std::is_sorted(seen.begin(), seen.end()) && seen.front() == -50);
+        assert(trie.lower_bound({2, 0, 0}).key() == (event_key{2, 0, 0}));
+        assert(trie.erase_range({0, INT64_MIN, 0}, {1, 0, 0}) == 150 && trie.size() == 150);
+    }
+    
+    std::cout << "  PASSED\n";
+}
+
+void test_float_and_int128_keys() {
+    std::cout << "Testing float/double and 128-bit keys...\n";
+    
+    static_assert(tktrie<double, int>::FIXED_LEN == 8 && tktrie<float, int>::FIXED_LEN == 4);
+    check_bounds<tktrie<double, int>, double>();
+    check_erase_range<tktrie<double, int>, double>([](std::mt19937& rng) {
+        double d = std::ldexp(static_cast<double>(rng() % 1000) + 0.25, static_cast<int>(rng() % 80) - 40);
+        return rng() % 2 ? -d : d;
+    });
+    check_erase_range<tktrie<float, int, true>, float>([](std::mt19937& rng) {
+        return static_cast<float>(static_cast<int>(rng() % 4000) - 2000) / 16.0f;
+    });
+    {
+        tktrie<double, int> prices;
+        const double inf = std::numeric_limits<double>::infinity();
+        for (double p : {1.5, -0.25, 0.0, 99.99, -inf, inf, 1e-300, -1e300, 0.1}) prices.insert({p, 1});
+        assert(!prices.insert({-0.0, 2}).second && prices.contains(-0.0));
+        std::vector<double> seen;
+        for (auto it = prices.begin(); it != prices.end(); ++it) seen.push_back(it.key());
+        assert(seen.size() == 9 && std::is_sorted(seen.begin(), seen.end()));
+        assert(seen.front() == -inf && seen.back() == inf && !std::signbit(seen[3]));
+        assert(prices.lower_bound(0.05).key() == 0.1 && prices.upper_bound(1.5).key() == 99.99);
+        size_t n = prices.scan(0.0, 2.0, [](const double&, const int&) {});
+        assert(n == 4);  // 0, 1e-300, 0.1, 1.5
+    }
+#ifdef KTRIE_HAS_INT128
+    using u128 = unsigned __int128;
+    static_assert(tktrie<u128, int>::FIXED_LEN == 16 && tktrie<__int128, int>::FIXED_LEN == 16);
+    check_bounds<tktrie<__int128, int>, __int128>();
+    check_erase_range<tktrie<u128, int, true>, u128>([](std::mt19937& rng) {
+        return (static_cast<u128>(rng() % 8) << 120) | (static_cast<u128>(rng() % 5) << 64) | (rng() % 300);
+    });
+    {
+        // IPv6 /48 blocks come back whole and in address order
+        auto addr = [](uint64_t hi, uint64_t lo) { return (static_cast<u128>(hi) << 64) | lo; };
+        tktrie<u128, int> routes;
+        for (uint64_t site = 0; site < 4; ++site) {
+            for (uint64_t host = 0; host < 100; ++host) {
+                routes.insert({addr(0x20010db800000000ull | site << 16, host * 0x0100000000000001ull), static_cast<int>(site)});
+            }
+        }
+        u128 block = addr(0x20010db800020000ull, 0);
+        u128 prev = 0;
+        size_t n = routes.scan(block, block + (static_cast<u128>(1) << 80), [&](const u128& k, const int& site) {
+            assert(site == 2 && k >= prev);
+            prev = k;
+        });
+        assert(n == 100 && routes.erase_range(block, block + (static_cast<u128>(1) << 80)) == 100);
+        assert(routes.size() == 300 && routes.lower_bound(block).value() == 3);
+    }
+#endif
+    
+    std::cout << "  PASSED\n";
+}
+
+template <typename Trie>
+constexpr bool finds_views = requires(Trie& t, std::string_view v) { t.find(v); };
+
+template <typename Trie>
+void check_key_views() {
+    std::mt19937 rng(23);
+    Trie trie;
+    std::map<std::string, int> oracle;
+    auto make = [&]() {
+        std::string k;
+        for (int i = 0, n = static_cast<int>(rng() % 6); i < n; ++i) k += "ab/\xff"[rng() % 4];
+        return k;
+    };
+    for (int i = 0; i < 400; ++i) {
+        std::string k = make();
+        if (oracle.emplace(k, i).second) trie.insert({k, i});
+    }
+    const Trie& ctrie = trie;
+    for (int i = 0; i < 2000; ++i) {
+        // The view points into a larger buffer, as a parser's would
+        std::string buf = "<" + make() + ">";
+        std::string_view v = std::string_view(buf).substr(1, buf.size() - 2);
+        std::string k(v);
+        assert(trie.contains(v) == trie.contains(k));
+        assert(ctrie.find(v) == ctrie.find(k));
+        auto it = trie.find(v);
+        if (it.valid()) assert(it.key_bytes() == v && it.value() == oracle[k]);
+        int seen = -1;
+        assert(trie.visit(v, [&](const int& x) { seen = x; }) == oracle.count(k));
+        if (auto g = trie.find_ref(v)) assert(*g == seen);
+        assert(trie.lower_bound(v) == trie.lower_bound(k) && ctrie.upper_bound(v) == ctrie.upper_bound(k));
+        assert(trie.equal_range(v) == trie.equal_range(k));
+        auto bytes = std::as_bytes(std::span<const char>(k.data(), k.size()));
+        assert(trie.contains(bytes) == oracle.count(k));
+        if (rng() % 4 == 0) {
+            assert(trie.erase(v) == (oracle.erase(k) == 1));
+            assert(!trie.contains(v));
+        }
+    }
+    assert(trie.size() == oracle.size());
+}
+
+void test_heterogeneous_lookup() {
+    std::cout << "Testing string_view/const char*/byte-span lookups...\n";
+    
+    static_assert(finds_views<string_trie<int>> && !finds_views<int64_trie<int>>);
+    check_key_views<string_trie<int>>();
+    check_key_views<concurrent_string_trie<int>>();
+    {
+        string_trie<int> trie;
+        for (const char* k : {"GET /a", "GET /b", "POST /a", "PUT /c"}) trie.insert({k, 1});
+        const char* packet = "GET /b HTTP/1.1";
+        std::string_view method(packet, 6);
+        assert(trie.contains(method) && trie.find(method).key_bytes() == "GET /b");
+        assert(trie.contains("PUT /c") && !trie.contains("PUT"));
+        std::vector<unsigned char> raw = {'P', 'O', 'S', 'T', ' ', '/', 'a'};
+        assert(trie.find(raw).valid());
+        size_t n = trie.scan(std::string_view("GET"), "GET\xff", [](const std::string& k, const int&) {
+            assert(k.starts_with("GET "));
+        });
+        assert(n == 2);
+        std::vector<std::string_view> views = {"GET /a", "nope", "PUT /c"};
+        std::vector<std::optional<int>> vals(views.size());
+        assert(trie.find_batch(views, vals) == 2 && !vals[1]);
+        std::unique_ptr<bool[]> present(new bool[views.size()]);
+        assert(trie.contains_batch(views, std::span<bool>(present.get(), views.size())) == 2);
+        assert(trie.erase_batch(views) == 2 && trie.size() == 2);
+        assert(trie.erase_range("A", std::string_view("Z")) == 2 && trie.empty());
+    }
+    {
+        sharded_string_trie<int, 4> trie;
+        for (const char* k : {"a", "b", "\xf0", "\xf1"}) trie.insert({k, 1});
+        std::string_view v("\xf0!", 1);
+        assert(trie.contains(v) && trie.find(v).key_bytes() == "\xf0");
+        assert(trie.lower_bound("c").key() == "\xf0" && trie.upper_bound(v).key() == "\xf1");
+        assert(trie.scan("a", std::string_view("\xf1"), [](const std::string&, const int&) {}) == 3);
+        assert(trie.erase(v) && trie.erase_range("a", "c") == 2 && trie.size() == 1);
+    }
+    
+    std::cout << "  PASSED\n";
+}
+
+void test_byte_array_keys() {
+    std::cout << "Testing fixed-length byte-array keys...\n";
+    
+    using sha_prefix = std::array<uint8_t, 20>;
+    using mac = std::array<std::byte, 6>;
+    static_assert(bytes_trie<20, int>::FIXED_LEN == 20 && tktrie<mac, int>::FIXED_LEN == 6);
+    static_assert(bytes_trie<32, int>::FIXED_LEN == 32 && !TrieKey<std::array<int8_t, 4>>);
+    
+    // Few distinct bytes, so long shared prefixes and skips of every length
+    auto make_hash = [](std::mt19937& rng) {
+        sha_prefix h{};
+        for (auto& b : h) b = static_cast<uint8_t>(rng() % 13 < 11 ? 0 : 0xF0 + rng() % 3);
+        h[19] = static_cast<uint8_t>(rng());
+        return h;
+    };
+    check_erase_range<bytes_trie<20, int>, sha_prefix>(make_hash);
+    check_insert_erase_batch<concurrent_bytes_trie<20, int>, sha_prefix>(make_hash);
+    check_bulk_load<tktrie<mac, int>, mac>([](std::mt19937& rng) {
+        mac m;
+        for (auto& b : m) b = static_cast<std::byte>(rng() % 4 ? 0x00 : rng());
+        return m;
+    });
+    {
+        bytes_trie<32, int> digests;
+        std::array<uint8_t, 32> lo{}, hi{};
+        hi.fill(0xFF);
+        for (int i = 0; i < 256; ++i) {
+            std::array<uint8_t, 32> d{};
+            d[0] = static_cast<uint8_t>(i);
+            d[31] = static_cast<uint8_t>(255 - i);
+            digests.insert({d, i});
+        }
+        assert(digests.find(hi).valid() == false && digests.lower_bound(lo).value() == 0);
+        assert(digests.rbegin().key()[0] == 0xFF && digests.rbegin().value() == 255);
+        std::array<uint8_t, 32> mid{};
+        mid[0] = 0x80;
+        assert(digests.erase_range(lo, mid) == 128 && digests.begin().value() == 128);
+    }
+    
+    std::cout << "  PASSED\n";
+}
+
+template <typename Trie>
+void check_same_contents(const Trie& a, const Trie& b) {
+    assert(a.size() == b.size());
+    auto it = b.begin();
+    for (auto ia = a.begin(); ia != a.end(); ++ia, ++it) {
+        assert(it.valid() && it.key_bytes() == ia.key_bytes() && it.value() == ia.value());
+    }
+    assert(!it.valid());
+}
+
+template <typename Trie, typename Key, typename MakeKey>
+void check_save_load(MakeKey make_key, size_t n) {
+    oracle_fixture<Trie, Key> f(25);
+    for (size_t i = 0; i < n; ++i) f.insert(make_key(f.rng), static_cast<int>(i));
+    for (size_t i = 0; i < n / 4; ++i) f.erase(make_key(f.rng));
+    std::stringstream ss;
+    assert(f.trie.save(ss));
+    Trie loaded;
+    loaded.insert({make_key(f.rng), -1});  // Replaced by the load
+    assert(loaded.load(ss));
+    check_against_oracle(loaded, f.oracle);
+    // A loaded trie takes writes like any other
+    for (size_t i = 0; i < n / 2; ++i) {
+        Key k = make_key(f.rng);
+        if (f.rng() % 2) {
+            assert(f.erase(k) == loaded.erase(k));
+        } else {
+            assert(f.insert(k, 7) == loaded.insert({k, 7}).second);
+        }
+    }
+    f.check();
+    check_against_oracle(loaded, f.oracle);
+}
+
+// Values as decimal text, to exercise a caller-supplied codec
+struct decimal_codec {
+    static void write(tktrie_writer& w, const int& v) { tktrie_codec<std::string>::write(w, std::to_string(v)); }
+    static bool read(tktrie_reader& r, int& v) {
+        std::string s;
+        if (!tktrie_codec<std::string>::read(r, s) || s.empty()) return false;
+        v = std::stoi(s);
+        return true;
+    }
+};
+
+void test_save_load() {
+    std::cout << "Testing save/load...\n";
+    
+    auto rand_string = [](std::mt19937& rng) {
+        std::string k;
+        for (int i = 0, n = static_cast<int>(rng() % 8); i < n; ++i) k += static_cast<char>(rng() % 4 ? 'a' + rng() % 4 : rng());
+        return k;
+    };
+    check_save_load<string_trie<int>, std::string>(rand_string, 5000);
+    check_save_load<concurrent_string_trie<int>, std::string>(rand_string, 5000);
+    check_save_load<int64_trie<int>, int64_t>([](std::mt19937& rng) { return static_cast<int64_t>(rng() % 100000) - 50000; }, 20000);
+    check_save_load<concurrent_int32_trie<int>, int32_t>([](std::mt19937& rng) { return static_cast<int32_t>(rng()); }, 20000);
+    check_save_load<bytes_trie<20, int>, std::array<uint8_t, 20>>([](std::mt19937& rng) {
+        std::array<uint8_t, 20> h{};
+        h[0] = static_cast<uint8_t>(rng() % 3);
+        h[19] = static_cast<uint8_t>(rng());
+        return h;
+    }, 2000);
+    {
+        string_trie<std::string> docs, back;
+        for (int i = 0; i < 300; ++i) docs.insert({"doc/" + std::to_string(i), std::string(i, 'x')});
+        docs.insert({"", "root"});
+        std::stringstream ss;
+        assert(docs.save(ss) && back.load(ss));
+        check_same_contents(docs, back);
+        
+        // Empty tries round-trip, and a stream holds tries back to back
+        string_trie<int> empty_s, strs;
+        int64_trie<int> empty_i, ints;
+        strs.insert({"x", 1});
+        ints.insert({5, 5});
+        std::stringstream two;
+        assert(empty_s.save(two) && empty_i.save(two));
+        assert(strs.load(two) && strs.empty() && ints.load(two) && ints.empty());
+        ints.insert({6, 6});
+        assert(ints.size() == 1 && ints.find(6).valid());
+    }
+    {
+        int64_trie<int> trie, back;
+        for (int64_t i = 0; i < 1000; ++i) trie.insert({i * 7919, static_cast<int>(i)});
+        std::stringstream ss;
+        assert(trie.save(ss, decimal_codec{}) && back.load(ss, decimal_codec{}));
+        check_same_contents(trie, back);
+        
+        // Short or corrupt streams fail and leave the trie as it was
+        std::string bytes;
+        {
+            std::stringstream full;
+            trie.save(full);
+            bytes = full.str();
+        }
+        for (size_t len = 0; len < bytes.size(); len += 1 + len / 8) {
+            std::stringstream cut(bytes.substr(0, len));
+            assert(!back.load(cut) && cut.fail());
+            assert(back.size() == 1000 && back.find(7919).value() == 1);
+        }
+        std::mt19937 rng(26);
+        for (int i = 0; i < 300; ++i) {
+            std::string bad = bytes;
+            bad[rng() % bad.size()] ^= static_cast<char>(1 + rng() % 255);
+            std::stringstream ss2(bad);
+            int32_trie<int> narrow;
+            std::stringstream ss3(bytes);
+            assert(!narrow.load(ss3));
+            if (back.load(ss2)) {
+                size_t n = 0;
+                for (auto it = back.begin(); it != back.end(); ++it) ++n;
+                assert(n == back.size());
+            }
+            std::stringstream good(bytes);
+            assert(back.load(good) && back.size() == 1000);
+        }
+    }
+    {
+        // A snapshot taken while writers run is some consistent state
+        concurrent_int64_trie<int64_t> trie;
+        for (int64_t i = 0; i < 20000; ++i) trie.insert({i, i});
+        std::atomic<bool> stop{false};
+        std::thread writer([&]() {
+            for (int64_t i = 20000; !stop.load(); ++i) {
+                trie.insert({i, i});
+                trie.erase(i - 20000);
+            }
+        });
+        for (int round = 0; round < 20; ++round) {
+            std::stringstream ss;
+            assert(trie.save(ss));
+            concurrent_int64_trie<int64_t> snap;
+            // Between a writer's insert and its erase there are 20001 keys
+            assert(snap.load(ss) && (snap.size() == 20000 || snap.size() == 20001));
+            for (auto it = snap.begin(); it != snap.end(); ++it) assert(it.key() == it.value());
+        }
+        stop.store(true);
+        writer.join();
+    }
+    {
+        // load retires the old tree: readers racing it see old or new values
+        concurrent_string_trie<std::string> src;
+        for (int i = 0; i < 500; ++i) src.insert({"k" + std::to_string(i), "new"});
+        std::stringstream ss;
+        assert(src.save(ss));
+        const std::string bytes = ss.str();
+        concurrent_string_trie<std::string> trie;
+        for (int i = 0; i < 500; ++i) trie.insert({"k" + std::to_string(i), "old"});
+        std::atomic<bool> stop{false};
+        std::atomic<int> bad{0};
+        std::thread reader([&]() {
+            for (int i = 0; !stop.load(); i = (i + 1) % 500) {
+                auto it = trie.find("k" + std::to_string(i));
+                if (!it.valid() || (it.value() != "old" && it.value() != "new")) bad.fetch_add(1);
+            }
+        });
+        for (int round = 0; round < 20; ++round) {
+            std::stringstream in(bytes);
+            assert(trie.load(in) && trie.size() == 500);
+        }
+        stop.store(true);
+        reader.join();
+        assert(bad.load() == 0);
+    }
+    
+    std::cout << "  PASSED\n";
+}
+
 int main() {
     std::cout << "=== TKTRIE TEST SUITE ===\n\n";
     
@@ -264,8 +2276,32 @@ int main() {
     test_many_keys();
     test_int_trie();
     test_copy_move();
+    test_node_reuse();
     test_concurrent_basic();
     test_concurrent_multithread();
+    test_many_readers();
+    test_optimistic_reads();
+    test_concurrent_writers();
+    test_sharded_trie();
+    test_combined_writers();
+    test_reclaim_policy();
+    test_zero_copy_reads();
+    test_insert_or_assign();
+    test_emplace();
+    test_move_only_values();
+    test_cursor_iteration();
+    test_prefix_scan();
+    test_bounds_and_scan();
+    test_batch_lookup();
+    test_bulk_load();
+    test_insert_erase_batch();
+    test_erase_range();
+    test_longest_prefix_match();
+    test_composite_keys();
+    test_float_and_int128_keys();
+    test_heterogeneous_lookup();
+    test_byte_array_keys();
+    test_save_load();
     
     std::cout << "\n=== ALL TESTS PASSED ===\n";
     return 0;
@@ -1,9 +1,19 @@
 #pragma once
 
+#include <bitset>
+#include <concepts>
+#include <cstddef>
 #include <cstring>
+#include <exception>
+#include <iosfwd>
+#include <iterator>
+#include <limits>
 #include <mutex>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -26,15 +36,32 @@ struct tktrie_traits<std::string> {
     static std::string from_bytes(std::string_view b) { return std::string(b); }
 };
 
-template <typename T> requires std::is_integral_v<T>
+// Integer key types: the standard ones, plus __int128 and unsigned __int128,
+// which strict -std=c++20 does not count as integral
+template <typename T>
+struct trie_unsigned { using type = std::make_unsigned_t<T>; };
+#ifdef KTRIE_HAS_INT128
+template <> struct trie_unsigned<__int128> { using type = unsigned __int128; };
+template <> struct trie_unsigned<unsigned __int128> { using type = unsigned __int128; };
+#endif
+
+template <typename T>
+concept trie_integer = std::is_integral_v<T>
+#ifdef KTRIE_HAS_INT128
+    || std::is_same_v<T, __int128> || std::is_same_v<T, unsigned __int128>
+#endif
+    ;
+
+template <typename T> requires trie_integer<T>
 struct tktrie_traits<T> {
     static constexpr size_t FIXED_LEN = sizeof(T);  // Fixed length
-    using unsigned_t = std::make_unsigned_t<T>;
+    using unsigned_t = typename trie_unsigned<T>::type;
     using bytes_t = std::array<char, sizeof(T)>;
+    static constexpr bool SIGNED = T(-1) < T(0);
     
     static bytes_t to_bytes(T k) noexcept {
         unsigned_t sortable;
-        if constexpr (std::is_signed_v<T>)
+        if constexpr (SIGNED)
             sortable = static_cast<unsigned_t>(k) ^ (unsigned_t{1} << (sizeof(T) * 8 - 1));
         else
             sortable = k;
@@ -47,28 +74,225 @@ struct tktrie_traits<T> {
         unsigned_t be;
         std::memcpy(&be, b.data(), sizeof(T));
         unsigned_t sortable = from_big_endian(be);
-        if constexpr (std::is_signed_v<T>)
+        if constexpr (SIGNED)
             return static_cast<T>(sortable ^ (unsigned_t{1} << (sizeof(T) * 8 - 1)));
         else
             return static_cast<T>(sortable);
     }
 };
 
+// Fixed-width binary keys (hash prefixes, MAC addresses, object ids): the
+// bytes as they are, which compare as unsigned bytes just as std::array of
+// uint8_t or std::byte does. Up to 256 bytes (skip_string's length byte).
+template <typename B>
+concept trie_key_byte = std::is_same_v<B, uint8_t> || std::is_same_v<B, std::byte>;
+
+template <trie_key_byte B, size_t N> requires (N > 0 && N <= 256)
+struct tktrie_traits<std::array<B, N>> {
+    static constexpr size_t FIXED_LEN = N;
+    using bytes_t = std::array<char, N>;
+
+    static bytes_t to_bytes(const std::array<B, N>& k) noexcept {
+        bytes_t result;
+        std::memcpy(result.data(), k.data(), N);
+        return result;
+    }
+    static std::array<B, N> from_bytes(std::string_view b) {
+        std::array<B, N> k;
+        std::memcpy(k.data(), b.data(), N);
+        return k;
+    }
+};
+
+// IEEE-754 floats: negatives flip every bit, so larger magnitudes sort lower,
+// and the rest flip only the sign bit, which orders the bit patterns as the
+// values. -0.0 is stored as +0.0, since they compare equal; NaNs sort past
+// the infinities and should not be used as keys.
+template <typename T> requires std::is_floating_point_v<T> && std::numeric_limits<T>::is_iec559 &&
+                               (sizeof(T) == 4 || sizeof(T) == 8)
+struct tktrie_traits<T> {
+    static constexpr size_t FIXED_LEN = sizeof(T);
+    using bits_t = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+    using bytes_t = std::array<char, sizeof(T)>;
+    static constexpr bits_t SIGN = bits_t{1} << (sizeof(T) * 8 - 1);
+
+    static bytes_t to_bytes(T k) noexcept {
+        bits_t bits = std::bit_cast<bits_t>(k == T(0) ? T(0) : k);
+        return tktrie_traits<bits_t>::to_bytes(bits & SIGN ? ~bits : bits | SIGN);
+    }
+    static T from_bytes(std::string_view b) {
+        bits_t bits = tktrie_traits<bits_t>::from_bytes(b);
+        return std::bit_cast<T>(bits & SIGN ? bits ^ SIGN : ~bits);
+    }
+};
+
+// A key type the trie can index. to_bytes() encodes a key so that comparing
+// encodings as unsigned bytes orders keys as Key's operator< does, which is
+// the order iteration, bounds and range operations follow. FIXED_LEN is the
+// width of every encoding, or 0 for variable-length keys; fixed-length keys
+// never end at an interior node, so their tries carry no EOS values and keep
+// skips inline in the node.
+template <typename Key>
+concept TrieKey = requires(const Key& k, std::string_view b) {
+    { tktrie_traits<Key>::FIXED_LEN } -> std::convertible_to<size_t>;
+    { tktrie_traits<Key>::to_bytes(k).data() } -> std::convertible_to<const char*>;
+    { tktrie_traits<Key>::to_bytes(k).size() } -> std::convertible_to<size_t>;
+    { tktrie_traits<Key>::from_bytes(b) } -> std::convertible_to<Key>;
+};
+
+// A string key given as its bytes, for lookups that should not build a
+// std::string: std::string_view, C strings, and byte spans (or anything
+// converting to std::span<const std::byte> or std::span<const unsigned char>)
+template <typename K, typename Key>
+concept trie_key_view = !std::is_same_v<std::remove_cvref_t<K>, Key> &&
+    (std::convertible_to<const K&, std::string_view> || std::convertible_to<const K&, std::span<const std::byte>> ||
+     std::convertible_to<const K&, std::span<const unsigned char>>);
+
+template <typename K>
+std::string_view trie_key_bytes(const K& key) noexcept {
+    if constexpr (std::convertible_to<const K&, std::string_view>) {
+        return std::string_view(key);
+    } else if constexpr (std::convertible_to<const K&, std::span<const std::byte>>) {
+        std::span<const std::byte> b(key);
+        return {reinterpret_cast<const char*>(b.data()), b.size()};
+    } else {
+        std::span<const unsigned char> b(key);
+        return {reinterpret_cast<const char*>(b.data()), b.size()};
+    }
+}
+
+// A TrieKey of one width, usable as a component of a composite key
+template <typename Key>
+concept FixedTrieKey = TrieKey<Key> && (tktrie_traits<Key>::FIXED_LEN > 0);
+
+// Composite keys: the components' encodings concatenated, most significant
+// first. Each has one width, so no separator is needed and byte order is
+// the components' lexicographic order, as std::tuple compares.
+template <FixedTrieKey... Parts>
+struct tktrie_composite_traits {
+    static constexpr size_t FIXED_LEN = (tktrie_traits<Parts>::FIXED_LEN + ...);
+    // skip_string keeps its length in one byte
+    static_assert(FIXED_LEN <= 256, "composite keys encode to at most 256 bytes");
+    using bytes_t = std::array<char, FIXED_LEN>;
+
+    static bytes_t to_bytes(const Parts&... parts) noexcept {
+        bytes_t result;
+        char* out = result.data();
+        ((out = put(out, tktrie_traits<Parts>::to_bytes(parts))), ...);
+        return result;
+    }
+    // make(part0, part1, ...) from the decoded components
+    template <typename Make>
+    static auto from_bytes(std::string_view b, Make&& make) {
+        return decode(b, make, std::index_sequence_for<Parts...>{});
+    }
+
+private:
+    static constexpr std::array<size_t, sizeof...(Parts)> OFFSETS = [] {
+        std::array<size_t, sizeof...(Parts)> at{};
+        size_t widths[] = {tktrie_traits<Parts>::FIXED_LEN...};
+        for (size_t i = 1; i < at.size(); ++i) at[i] = at[i - 1] + widths[i - 1];
+        return at;
+    }();
+
+    template <typename Bytes>
+    static char* put(char* out, const Bytes& kb) noexcept {
+        std::memcpy(out, kb.data(), kb.size());
+        return out + kb.size();
+    }
+    template <typename Make, size_t... I>
+    static auto decode(std::string_view b, Make& make, std::index_sequence<I...>) {
+        return make(tktrie_traits<Parts>::from_bytes(b.substr(OFFSETS[I], tktrie_traits<Parts>::FIXED_LEN))...);
+    }
+};
+
+template <FixedTrieKey A, FixedTrieKey B>
+struct tktrie_traits<std::pair<A, B>> {
+    using parts = tktrie_composite_traits<A, B>;
+    static constexpr size_t FIXED_LEN = parts::FIXED_LEN;
+    using bytes_t = typename parts::bytes_t;
+
+    static bytes_t to_bytes(const std::pair<A, B>& k) noexcept { return parts::to_bytes(k.first, k.second); }
+    static std::pair<A, B> from_bytes(std::string_view b) {
+        return parts::from_bytes(b, [](A a, B c) { return std::pair<A, B>(std::move(a), std::move(c)); });
+    }
+};
+
+template <FixedTrieKey... Ts>
+struct tktrie_traits<std::tuple<Ts...>> {
+    using parts = tktrie_composite_traits<Ts...>;
+    static constexpr size_t FIXED_LEN = parts::FIXED_LEN;
+    using bytes_t = typename parts::bytes_t;
+
+    static bytes_t to_bytes(const std::tuple<Ts...>& k) noexcept {
+        return std::apply([](const Ts&... p) { return parts::to_bytes(p...); }, k);
+    }
+    static std::tuple<Ts...> from_bytes(std::string_view b) {
+        return parts::from_bytes(b, [](Ts... p) { return std::tuple<Ts...>(std::move(p)...); });
+    }
+};
+
+// Aggregates opt in by listing their key fields, most significant first:
+//   struct order_key {
+//       uint32_t tenant; int64_t ts; uint16_t seq;
+//       static constexpr auto trie_key_fields =
+//           std::tuple{&order_key::tenant, &order_key::ts, &order_key::seq};
+//   };
+// Fields left out of trie_key_fields are not stored and come back default.
+template <typename Key>
+concept AggregateTrieKey = std::is_default_constructible_v<Key> && requires { Key::trie_key_fields; };
+
+template <typename Field> struct trie_field;
+template <typename Field, typename Owner>
+struct trie_field<Field Owner::*> { using type = Field; };
+
+template <typename Key, typename Fields = std::remove_cvref_t<decltype(Key::trie_key_fields)>>
+struct tktrie_aggregate_parts;
+template <typename Key, typename... Members>
+struct tktrie_aggregate_parts<Key, std::tuple<Members...>> {
+    using type = tktrie_composite_traits<typename trie_field<Members>::type...>;
+};
+
+template <AggregateTrieKey Key>
+struct tktrie_traits<Key> {
+    using parts = typename tktrie_aggregate_parts<Key>::type;
+    static constexpr size_t FIXED_LEN = parts::FIXED_LEN;
+    using bytes_t = typename parts::bytes_t;
+
+    static bytes_t to_bytes(const Key& k) noexcept {
+        return std::apply([&](auto... field) { return parts::to_bytes(k.*field...); }, Key::trie_key_fields);
+    }
+    static Key from_bytes(std::string_view b) {
+        return parts::from_bytes(b, [](auto... p) {
+            Key k{};
+            std::apply([&](auto... field) { ((k.*field = std::move(p)), ...); }, Key::trie_key_fields);
+            return k;
+        });
+    }
+};
+
 // Forward declarations
-template <typename Key, typename T, bool THREADED, typename Allocator, bool CONST, bool REVERSE>
-class tktrie_iterator_impl;
+template <typename Key, typename T, bool THREADED, typename Allocator>
+class tktrie;
 
-// =============================================================================
-// RETIRE_ENTRY - External wrapper for retired nodes
-// =============================================================================
+// save/load streams and value codecs (see tktrie_serialize.h)
+class tktrie_writer;
+class tktrie_reader;
+template <typename T> struct tktrie_codec;
 
-template <typename NodePtr>
-struct retire_entry {
-    NodePtr node;
-    uint64_t epoch;
-    retire_entry* next;
+template <typename Key, typename T, bool THREADED, typename Allocator, bool CONST, bool REVERSE,
+          typename Trie = tktrie<Key, T, THREADED, Allocator>>
+class tktrie_iterator_impl;
+
+// A [begin, end) pair of iterators, usable in range-for
+template <typename It>
+struct tktrie_range {
+    It first;
+    It last;
     
-    retire_entry(NodePtr n, uint64_t e) noexcept : node(n), epoch(e), next(nullptr) {}
+    It begin() const { return first; }
+    It end() const { return last; }
+    bool empty() const { return first == last; }
 };
 
 // =============================================================================
@@ -78,14 +302,20 @@ struct retire_entry {
 template <typename Key, typename T, bool THREADED = false, typename Allocator = std::allocator<uint64_t>>
 class tktrie {
 public:
+    static_assert(TrieKey<Key>, "tktrie keys need a tktrie_traits specialization (see TrieKey)");
     using traits = tktrie_traits<Key>;
     static constexpr size_t FIXED_LEN = traits::FIXED_LEN;
-    
+
     using ptr_t = node_base<T, THREADED, Allocator, FIXED_LEN>*;
     using atomic_ptr = atomic_node_ptr<T, THREADED, Allocator, FIXED_LEN>;
     using builder_t = node_builder<T, THREADED, Allocator, FIXED_LEN>;
     using skip_t = skip_node<T, THREADED, Allocator, FIXED_LEN>;
     using data_t = dataptr<T, THREADED, Allocator>;
+    using source_t = value_source<T, THREADED, Allocator>;
+    using value_box_t = value_box<T, THREADED>;
+    // What iterators hold of a value: a copy, or for a move-only T a
+    // reference to its box (see value_box)
+    using held_t = typename data_t::held_t;
     // Non-const iterators (can call erase/insert via parent)
     using iterator = tktrie_iterator_impl<Key, T, THREADED, Allocator, false, false>;
     using reverse_iterator = tktrie_iterator_impl<Key, T, THREADED, Allocator, false, true>;
@@ -93,7 +323,6 @@ public:
     using const_iterator = tktrie_iterator_impl<Key, T, THREADED, Allocator, true, false>;
     using const_reverse_iterator = tktrie_iterator_impl<Key, T, THREADED, Allocator, true, true>;
     using mutex_t = std::conditional_t<THREADED, std::mutex, empty_mutex>;
-    using retire_entry_t = retire_entry<ptr_t>;
 
     // -------------------------------------------------------------------------
     // Result types
@@ -130,26 +359,28 @@ public:
     };
 
     // -------------------------------------------------------------------------
-    // Optimistic read types (for lock-free reads)
+    // Optimistic read types (reads validated without a lock)
     // -------------------------------------------------------------------------
+    // Versions are recorded with POISON so a retired or mid-write node never validates
     struct read_path {
         static constexpr int MAX_DEPTH = 64;
-        std::array<ptr_t, MAX_DEPTH> nodes{};
-        std::array<uint64_t, MAX_DEPTH> versions{};
+        std::array<ptr_t, MAX_DEPTH> nodes;
+        std::array<uint64_t, MAX_DEPTH> versions;
         int len = 0;
+        bool overflow = false;  // Deeper than MAX_DEPTH: can't be validated
         
-        void clear() noexcept { len = 0; }
+        void clear() noexcept { len = 0; overflow = false; }
         
         bool push(ptr_t n) noexcept {
-            if (len >= MAX_DEPTH) return false;
+            if (len >= MAX_DEPTH) { overflow = true; return false; }
             nodes[len] = n;
-            versions[len] = n->version();
+            versions[len] = n->header() & (VERSION_MASK | FLAG_POISON);
             ++len;
             return true;
         }
         
         bool push_checked(ptr_t n) noexcept {
-            if (len >= MAX_DEPTH) return false;
+            if (len >= MAX_DEPTH) { overflow = true; return false; }
             uint64_t h = n->header();
             if (is_poisoned_header(h)) return false;
             nodes[len] = n;
@@ -158,6 +389,8 @@ public:
             return true;
         }
     };
+    // Failed validations in a row before a read falls back to the writer lock
+    static constexpr int OPTIMISTIC_READ_ATTEMPTS = 10;
 
     // -------------------------------------------------------------------------
     // Speculative insert types
@@ -186,6 +419,26 @@ public:
         std::string remaining_key;
     };
 
+    // Node write locks taken by one speculative commit (see try_lock_version)
+    struct commit_locks {
+        ptr_t nodes[4];
+        int count = 0;
+        
+        bool lock(ptr_t n, uint64_t version) noexcept {
+            if (!n->try_lock_version(version)) return false;
+            nodes[count++] = n;
+            return true;
+        }
+        
+        // Retired nodes stay locked: mark_retired already replaced their version
+        void release() noexcept {
+            for (int i = 0; i < count; ++i) {
+                if (!nodes[i]->is_poisoned()) nodes[i]->unlock_version();
+            }
+            count = 0;
+        }
+    };
+
     struct pre_alloc {
         ptr_t nodes[8];
         int count = 0;
@@ -240,6 +493,7 @@ public:
         unsigned char c = 0;
         bool is_eos = false;
         ptr_t collapse_child = nullptr;
+        uint64_t collapse_version = 0;
         unsigned char collapse_char = 0;
         std::string target_skip;
         std::string child_skip;
@@ -252,10 +506,16 @@ public:
         void add(ptr_t n) { nodes[count++] = n; }
     };
 
+    // Zero-copy reads pin the value in place; inline values stored as
+    // std::atomic<T> (pointer-sized, trivially copyable) are copied instead
+    using pin_t = std::conditional_t<data_t::PINNABLE, const T*, T>;
+
     // -------------------------------------------------------------------------
     // Per-trie EBR
     // -------------------------------------------------------------------------
     static constexpr size_t EBR_MIN_RETIRED = 64;
+    // A node retired at epoch e is freed once every reader is at e + this
+    static constexpr uint64_t EBR_GRACE_EPOCHS = 8;
 
 private:
     atomic_ptr root_;
@@ -265,83 +525,249 @@ private:
     
     alignas(64) std::conditional_t<THREADED, std::atomic<uint64_t>, uint64_t> epoch_{1};
     
-    static constexpr size_t EBR_PADDED_SLOTS = 16;
-    
-    struct alignas(64) PaddedReaderSlot {
-        std::atomic<uint64_t> epoch{0};
-    };
-    
-    std::conditional_t<THREADED, 
-        std::array<PaddedReaderSlot, EBR_PADDED_SLOTS>,
-        std::array<uint64_t, 1>> reader_epochs_{};
+    // Per-thread reader records, registered lazily (see tktrie_ebr.h)
+    std::conditional_t<THREADED,
+        std::shared_ptr<ebr_registry>,
+        std::array<uint64_t, 1>> readers_{};
     
-    std::conditional_t<THREADED, std::atomic<retire_entry_t*>, retire_entry_t*> retired_head_{nullptr};
+    // Intrusive list of retired nodes, newest first (linked via builder_t::retire_next)
+    std::conditional_t<THREADED, std::atomic<ptr_t>, ptr_t> retired_head_{nullptr};
     std::conditional_t<THREADED, std::atomic<size_t>, size_t> retired_count_{0};
     mutable std::conditional_t<THREADED, std::mutex, empty_mutex> ebr_mutex_;
     
-    void ebr_retire(ptr_t n, uint64_t epoch);
+    // Values unlinked from live nodes, same order and epochs as retired_head_
+    // (see value_retire_sink). Counted in retired_count_.
+    std::conditional_t<THREADED, std::atomic<value_box_t*>, value_box_t*> retired_values_{nullptr};
+    void retire_value(value_box_t* b) noexcept;
+    static void retire_value_to(void* trie, value_box_t* b) noexcept;
+    // Installed by every THREADED write
+    struct value_retire_guard : value_retire_scope<T, Allocator> {
+        explicit value_retire_guard(tktrie& t) noexcept
+            : value_retire_scope<T, Allocator>(&t, &retire_value_to) {}
+    };
+    
+    void ebr_retire(ptr_t n);
     void ebr_cleanup();
+    void maybe_reclaim(size_t threshold);
+    
+    // The reclaimer is created on first switch to BACKGROUND and lives until
+    // the trie dies, so callers may kick it without synchronizing with
+    // set_reclaim_policy; its pass is a no-op under other policies
+    std::conditional_t<THREADED, std::atomic<reclaim_policy>, reclaim_policy> reclaim_policy_{reclaim_policy::INLINE};
+    std::unique_ptr<ebr_reclaimer> reclaimer_;
+    std::mutex reclaimer_mutex_;
     uint64_t min_reader_epoch() const noexcept;
-    size_t reader_enter() const noexcept;
-    void reader_exit(size_t slot) const noexcept;
+    ebr_reader_record* reader_enter() const;
+    void reader_exit(ebr_reader_record* rec) const noexcept;
+    
+    // Speculative commits run side by side under node locks, flagging only
+    // their own reader record. Locked fallbacks take mutex_, raise exclusive_
+    // and wait for in-flight commits to drain.
+    alignas(64) mutable std::conditional_t<THREADED, std::atomic<bool>, bool> exclusive_{false};
+    void commit_enter(ebr_reader_record* rec) const;
+    void commit_exit(ebr_reader_record* rec) const noexcept;
+    void lock_exclusive() const;
+    bool try_lock_exclusive() const;
+    void unlock_exclusive() const noexcept;
+    
+    struct commit_section {
+        const tktrie& trie;
+        ebr_reader_record* rec;
+        commit_section(const tktrie& t, ebr_reader_record* r) : trie(t), rec(r) { trie.commit_enter(rec); }
+        ~commit_section() { trie.commit_exit(rec); }
+    };
+    
+    struct exclusive_lock {
+        const tktrie& trie;
+        bool owns = true;
+        explicit exclusive_lock(const tktrie& t) : trie(t) { trie.lock_exclusive(); }
+        exclusive_lock(const tktrie& t, std::try_to_lock_t) : trie(t), owns(t.try_lock_exclusive()) {}
+        ~exclusive_lock() { if (owns) trie.unlock_exclusive(); }
+    };
 
-    static void node_deleter(void* ptr);
+    void node_deleter(ptr_t n);
     void retire_node(ptr_t n);
+    void ebr_retire_batch(const std::vector<ptr_t>& nodes);
+    void invalidate_cursors() noexcept;
 
-    template <bool NEED_VALUE>
-    bool read_impl(ptr_t n, std::string_view key, T& out) const noexcept
+    // -------------------------------------------------------------------------
+    // Flat combining (see tktrie_combine.h)
+    // -------------------------------------------------------------------------
+    // Lives on the posting thread's stack; published through its EBR record
+    struct fc_request {
+        std::string key_bytes;
+        const T* value = nullptr;  // The poster's, alive until done
+        bool is_insert = true;
+        bool result = false;
+        std::exception_ptr error;  // Thrown while applying it; rethrown to the poster
+        std::conditional_t<THREADED, std::atomic<bool>, bool> done{false};
+    };
+    // Combiner scratch, only touched under mutex_
+    std::vector<fc_request*> fc_batch_;
+    std::vector<ptr_t> fc_retired_;
+    bool run_combined(fc_request& req);
+    void combine_pending() noexcept;
+
+    // OUT is held_t, or pin_t for zero-copy reads
+    template <bool NEED_VALUE, typename Out>
+    bool read_impl(ptr_t n, std::string_view key, Out& out) const noexcept
         requires NEED_VALUE;
     
     template <bool NEED_VALUE>
     bool read_impl(ptr_t n, std::string_view key) const noexcept
         requires (!NEED_VALUE);
     
-    template <bool NEED_VALUE>
-    bool read_impl_optimistic(ptr_t n, std::string_view key, T& out, read_path& path) const noexcept
+    template <bool NEED_VALUE, typename Out>
+    bool read_impl_optimistic(ptr_t n, std::string_view key, Out& out, read_path& path) const noexcept
         requires NEED_VALUE;
     
     template <bool NEED_VALUE>
     bool read_impl_optimistic(ptr_t n, std::string_view key, read_path& path) const noexcept
         requires (!NEED_VALUE);
+    // Byte-level bodies of the public lookups and erases, shared by their
+    // Key and key-view overloads
+    template <typename K>
+    static auto key_bytes_of(const K& key) noexcept {
+        if constexpr (std::is_same_v<K, Key>) return traits::to_bytes(key);
+        else return trie_key_bytes(key);
+    }
+    bool contains_bytes(std::string_view kbv) const;
+    bool find_read(std::string_view kbv, held_t& value) const;
+    template <typename It, typename Self>
+    static It find_bytes(Self* self, std::string_view kbv);
+    template <typename It, typename Self>
+    static std::pair<It, It> equal_range_bytes(Self* self, std::string_view kb);
+    template <typename It, typename Self>
+    static tktrie_range<It> prefix_range_bytes(Self* self, std::string_view prefix);
+    bool erase_bytes(std::string_view kbv);
+    template <typename Fn>
+    size_t scan_bytes(std::string_view lo_v, std::string_view hi_v, Fn&& fn, size_t limit) const;
+    size_t erase_range_bytes(std::string_view lo_v, std::string_view hi_v);
+    template <typename K>
+    size_t batch_find(std::span<const K> keys, std::span<std::optional<T>> out) const;
+    template <typename K>
+    size_t batch_contains(std::span<const K> keys, std::span<bool> out) const;
+    template <typename K>
+    size_t batch_erase(std::span<const K> keys);
+
+    size_t lpm_impl(ptr_t n, std::string_view key, held_t& out, read_path* path) const noexcept;
+    size_t lpm_read(std::string_view key, held_t& out) const;
+
+    // Batched lookups (see tktrie_batch.h)
+    static constexpr size_t BATCH_LANES = 16;
+    enum class batch_step { DESCEND, FOUND, MISS };
+    struct batch_no_path {};
+    struct batch_lane {
+        decltype(traits::to_bytes(std::declval<const Key&>())) kb{};
+        std::string_view key;  // Unread rest of kb
+        ptr_t node = nullptr;
+        [[no_unique_address]] std::conditional_t<THREADED, read_path, batch_no_path> path;
+        pin_t pin{};
+    };
+    template <bool NEED_VALUE>
+    batch_step batch_advance(batch_lane& l) const noexcept;
+    template <bool NEED_VALUE>
+    bool batch_retry(std::string_view kbv, pin_t& pin) const;
+    template <bool NEED_VALUE, typename K, typename Done>
+    void batch_lookup(std::span<const K> keys, Done&& done) const;
+
+    // Bottom-up bulk load (see tktrie_bulk.h)
+    struct bulk_entry {
+        decltype(traits::to_bytes(std::declval<const Key&>())) kb;
+        const Key* key;
+        const T* value;
+        std::string_view bytes() const noexcept { return {kb.data(), kb.size()}; }
+    };
+    template <bool IS_LEAF, typename Fill>
+    ptr_t bulk_node(std::string_view skip, int count, Fill&& fill);
+    ptr_t bulk_build(const bulk_entry* e, size_t n, size_t depth);
+    template <typename Node>
+    void bulk_children(Node* node, const bulk_entry* e, size_t n, size_t depth);
+    ptr_t bulk_root(const bulk_entry* e, size_t n);
+    void bulk_sort(std::vector<bulk_entry>& entries, bool sorted);
+    size_t bulk_load(std::vector<bulk_entry>& entries, bool sorted);
+    template <bool IS_LEAF, typename Fn>
+    void batch_typed(ptr_t n, Fn&& fn);
+    template <bool IS_LEAF, typename Add>
+    ptr_t batch_grow(ptr_t n, int count, Add&& add);
+    template <bool IS_LEAF, typename Add>
+    void batch_add(atomic_ptr* slot, ptr_t n, int count, Add&& add, std::vector<ptr_t>& retired);
+    size_t batch_insert_each(atomic_ptr* slot, const bulk_entry* e, size_t n, size_t depth,
+                             std::vector<ptr_t>& retired);
+    size_t batch_apply(atomic_ptr* slot, const bulk_entry* e, size_t n, size_t depth, std::vector<ptr_t>& retired);
+    size_t batch_insert(const bulk_entry* e, size_t n);
+
+    // Range erase (see tktrie_erase_range.h)
+    struct erase_bounds {
+        std::string_view lo, hi;
+        bool open;  // No upper bound: [lo, end)
+        bool contains(std::string_view k) const noexcept { return k >= lo && (open || k < hi); }
+    };
+    enum class range_cover { NONE, SOME, ALL };
+    static range_cover cover_of(std::string_view p, const erase_bounds& b) noexcept;
+    size_t retire_subtree(ptr_t n, std::vector<ptr_t>& retired);
+    erase_result erase_range_impl(ptr_t n, std::string& acc, const erase_bounds& b, std::vector<ptr_t>& retired,
+                                  size_t& erased);
+    template <bool IS_LEAF>
+    ptr_t erase_range_rebuild(ptr_t n, int count, const std::bitset<256>& gone);
+    // Save/load node stream (see tktrie_serialize.h)
+    static constexpr char SAVE_MAGIC[4] = {'T', 'K', 'T', 'R'};
+    static constexpr uint8_t SAVE_VERSION = 1;
+    static constexpr uint8_t SAVE_LEAF = 1, SAVE_SKIP = 2, SAVE_EOS = 4, SAVE_NONE = 0x80;
+    template <typename Codec>
+    void save_node(tktrie_writer& w, ptr_t n, Codec& codec) const;
+    template <typename Codec>
+    ptr_t load_node(tktrie_reader& r, Codec& codec, size_t depth, size_t& keys);
+    size_t erase_bounded(const erase_bounds& b);
     
     bool validate_read_path(const read_path& path) const noexcept;
+    bool validate_probe_path(const path_entry* path, int len, int max_len, int held = 0) const noexcept;
 
-    insert_result insert_impl(atomic_ptr* slot, ptr_t n, std::string_view key, const T& value);
-    insert_result insert_into_leaf(atomic_ptr* slot, ptr_t leaf, std::string_view key, const T& value);
-    insert_result insert_into_interior(atomic_ptr* slot, ptr_t n, std::string_view key, const T& value);
-    ptr_t create_leaf_for_key(std::string_view key, const T& value);
-    insert_result split_leaf_skip(ptr_t leaf, std::string_view key, const T& value, size_t m);
-    insert_result prefix_leaf_skip(ptr_t leaf, std::string_view key, const T& value, size_t m);
-    insert_result extend_leaf_skip(ptr_t leaf, std::string_view key, const T& value, size_t m);
-    insert_result split_leaf_multi(ptr_t leaf, std::string_view key, const T& value, size_t m);
-    insert_result prefix_leaf_multi(ptr_t leaf, std::string_view key, const T& value, size_t m);
+    insert_result insert_impl(atomic_ptr* slot, ptr_t n, std::string_view key, const source_t& value);
+    insert_result insert_into_leaf(atomic_ptr* slot, ptr_t leaf, std::string_view key, const source_t& value);
+    insert_result insert_into_interior(atomic_ptr* slot, ptr_t n, std::string_view key, const source_t& value);
+    ptr_t create_leaf_for_key(std::string_view key, const source_t& value);
+    insert_result split_leaf_skip(ptr_t leaf, std::string_view key, const source_t& value, size_t m);
+    insert_result prefix_leaf_skip(ptr_t leaf, std::string_view key, const source_t& value, size_t m);
+    insert_result extend_leaf_skip(ptr_t leaf, std::string_view key, const source_t& value, size_t m);
+    insert_result split_leaf_multi(ptr_t leaf, std::string_view key, const source_t& value, size_t m);
+    insert_result prefix_leaf_multi(ptr_t leaf, std::string_view key, const source_t& value, size_t m);
     ptr_t clone_leaf_with_skip(ptr_t leaf, std::string_view new_skip);
-    insert_result add_eos_to_leaf_multi(ptr_t leaf, const T& value);
-    insert_result add_char_to_leaf(ptr_t leaf, unsigned char c, const T& value);
-    insert_result demote_leaf_multi(ptr_t leaf, std::string_view key, const T& value);
-    insert_result split_interior(ptr_t n, std::string_view key, const T& value, size_t m);
+    insert_result add_eos_to_leaf_multi(ptr_t leaf, const source_t& value);
+    insert_result add_char_to_leaf(ptr_t leaf, unsigned char c, const source_t& value);
+    insert_result demote_leaf_multi(ptr_t leaf, std::string_view key, const source_t& value);
+    insert_result split_interior(ptr_t n, std::string_view key, const source_t& value, size_t m);
     ptr_t clone_interior_with_skip(ptr_t n, std::string_view new_skip);
-    insert_result prefix_interior(ptr_t n, std::string_view key, const T& value, size_t m);
-    insert_result set_interior_eos(ptr_t n, const T& value);
-    insert_result add_child_to_interior(ptr_t n, unsigned char c, std::string_view remaining, const T& value);
+    insert_result prefix_interior(ptr_t n, std::string_view key, const source_t& value, size_t m);
+    insert_result set_interior_eos(ptr_t n, const source_t& value);
+    insert_result add_child_to_interior(ptr_t n, unsigned char c, std::string_view remaining, const source_t& value);
 
     speculative_info probe_speculative(ptr_t n, std::string_view key) const noexcept;
     speculative_info probe_leaf_speculative(ptr_t n, std::string_view key, speculative_info& info) const noexcept;
-    pre_alloc allocate_speculative(const speculative_info& info, const T& value);
-    bool validate_path(const speculative_info& info) const noexcept;
+    pre_alloc allocate_speculative(const speculative_info& info, const source_t& value);
+    bool lock_speculative_path(const speculative_info& info, commit_locks& locks) noexcept;
     atomic_ptr* find_slot_for_commit(const speculative_info& info) noexcept;
     atomic_ptr* get_verified_slot(const speculative_info& info) noexcept;
     void commit_to_slot(atomic_ptr* slot, ptr_t new_node, const speculative_info& info) noexcept;
-    bool commit_speculative(speculative_info& info, pre_alloc& alloc, const T& value);
+    bool commit_speculative(speculative_info& info, pre_alloc& alloc, const source_t& value);
     void dealloc_speculation(pre_alloc& alloc);
-    std::pair<iterator, bool> insert_locked(const Key& key, std::string_view kb, const T& value, bool* retired_any);
+    std::pair<iterator, bool> insert_locked(const Key& key, std::string_view kb, const source_t& value, bool* retired_any);
+    std::pair<iterator, bool> insert_bytes(const Key& key, std::string_view kb, const source_t& value);
+    template <typename... Args>
+    std::pair<iterator, bool> emplace_bytes(const Key& key, std::string_view kb, Args&&... args);
+
+    // In-place overwrite of an existing key (see tktrie_assign.h)
+    ptr_t probe_value_holder(ptr_t n, std::string_view key, unsigned char& c, uint64_t& version) const noexcept;
+    template <typename Make>
+    bool assign_existing(std::string_view kb, Make&& make);
+    void value_retired() noexcept;
 
     erase_spec_info probe_erase(ptr_t n, std::string_view key) const noexcept;
     erase_spec_info probe_leaf_erase(ptr_t n, std::string_view key, erase_spec_info& info) const noexcept;
     erase_spec_info probe_interior_erase(ptr_t n, std::string_view key, erase_spec_info& info) const noexcept;
-    bool do_inplace_leaf_erase(ptr_t leaf, unsigned char c, uint64_t expected_version);
+    bool do_inplace_leaf_erase(ptr_t leaf, unsigned char c);
     erase_pre_alloc allocate_erase_speculative(const erase_spec_info& info);
-    bool validate_erase_path(const erase_spec_info& info) const noexcept;
+    bool lock_erase_path(const erase_spec_info& info, commit_locks& locks) noexcept;
     bool commit_erase_speculative(erase_spec_info& info, erase_pre_alloc& alloc);
     void dealloc_erase_speculation(erase_pre_alloc& alloc);
     std::pair<bool, bool> erase_locked(std::string_view kb);
@@ -353,7 +779,72 @@ private:
     erase_result collapse_single_child(ptr_t n, unsigned char c, ptr_t child, erase_result& res);
 
 public:
+    // -------------------------------------------------------------------------
+    // Cursor: the root-to-entry path of an ordered walk (see tktrie_cursor.h)
+    // -------------------------------------------------------------------------
+    // Stepping moves to the next sibling from the deepest frame instead of
+    // re-walking from root_. A saved path is reused only while every node on
+    // it is unchanged (THREADED) and not yet reclaimable; otherwise the next
+    // step re-seeks from the last key. Iterators keep one.
+    class cursor {
+        friend class tktrie;
+
+        struct frame {
+            ptr_t node = nullptr;
+            uint64_t version = 0;  // header & (VERSION_MASK | FLAG_POISON) when pushed
+            uint32_t key_len = 0;  // key_ length through this node's skip
+            int pos = 0;           // See tktrie_cursor.h
+        };
+        // Fixed-length keys take at most one node per byte, plus the root
+        static constexpr int INLINE_DEPTH = FIXED_LEN > 0 ? static_cast<int>(FIXED_LEN) + 1 : 16;
+
+        std::array<frame, INLINE_DEPTH> frames_{};
+        std::vector<frame> spill_;  // Frames past INLINE_DEPTH
+        int depth_ = 0;
+        uint64_t epoch_ = 0;        // Trie epoch_ before the path was walked
+        bool torn_ = false;         // The walk saw a node mid-change
+        std::string key_;           // Key bytes along the path
+
+        frame& at(int i) noexcept { return i < INLINE_DEPTH ? frames_[i] : spill_[i - INLINE_DEPTH]; }
+        const frame& at(int i) const noexcept {
+            return i < INLINE_DEPTH ? frames_[i] : spill_[i - INLINE_DEPTH];
+        }
+        frame& top() noexcept { return at(depth_ - 1); }
+
+        // Appends n's skip to key_; false (and torn_) if n is retired or mid-write
+        bool push(ptr_t n, int pos) {
+            uint64_t v = n->header() & (VERSION_MASK | FLAG_POISON);
+            if constexpr (THREADED) {
+                if (v & (FLAG_POISON | VERSION_WRITING)) {
+                    torn_ = true;
+                    return false;
+                }
+            }
+            if (depth_ >= INLINE_DEPTH && spill_.size() <= static_cast<size_t>(depth_ - INLINE_DEPTH)) {
+                spill_.emplace_back();
+            }
+            key_.append(n->skip_str());
+            frame& f = at(depth_++);
+            f.node = n;
+            f.version = v;
+            f.key_len = static_cast<uint32_t>(key_.size());
+            f.pos = pos;
+            return true;
+        }
+
+        void reset() noexcept {
+            depth_ = 0;
+            torn_ = false;
+            key_.clear();
+        }
+
+    public:
+        cursor() = default;
+    };
+
     tktrie();
+    // Node slabs are carved from chunks obtained through alloc (rebound)
+    explicit tktrie(const Allocator& alloc);
     ~tktrie();
     tktrie(const tktrie& other);
     tktrie& operator=(const tktrie& other);
@@ -361,16 +852,235 @@ public:
     tktrie& operator=(tktrie&& other) noexcept;
 
     void clear();
+    Allocator get_allocator() const { return builder_.get_allocator(); }
     size_t size() const noexcept { return size_.load(); }
     bool empty() const noexcept { return size() == 0; }
     bool contains(const Key& key) const;
     std::pair<iterator, bool> insert(const std::pair<const Key, T>& kv);
+    // Moves kv.second into the slot that stores it, even if key is present
+    std::pair<iterator, bool> insert(std::pair<const Key, T>&& kv);
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args);
+    // Constructs T from args once, in its final storage, and only if key is
+    // absent (THREADED: a racing insert of key may still win after the check)
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args);
     bool erase(const Key& key);
     
+    // Insert, or overwrite an existing key's value in place: one node is
+    // locked and nothing is rebuilt or retired but the old value. The bool is
+    // true if the key was inserted.
+    std::pair<iterator, bool> insert_or_assign(const Key& key, const T& value);
+    // Stores fn(old), where old is a const T* to the current value or nullptr
+    // if key is absent; fn runs under the node's lock, so concurrent upserts
+    // of one key never lose an update. fn may be called again if the key
+    // appears between its call and the insert. Returns true if inserted.
+    template <typename Fn>
+    bool upsert(const Key& key, Fn&& fn);
+    
+    // Opt-in flat combining: the op is posted, and whichever poster takes the
+    // writer lock applies every pending op in one key-sorted pass
+    std::pair<iterator, bool> insert_combined(const std::pair<const Key, T>& kv);
+    bool erase_combined(const Key& key);
+    
     // Find returns non-const iterator from non-const trie, const_iterator from const trie
     iterator find(const Key& key);
     const_iterator find(const Key& key) const;
     
+    // Zero-copy lookup. THREADED: the guard holds this thread's read epoch, so
+    // the value stays alive (as it was when found) even if the key is erased
+    // or replaced; retired nodes pile up until it dies, so keep it short and
+    // destroy it on the thread that made it. Non-THREADED: a write to the key
+    // invalidates it, as for std::map references.
+    class read_guard {
+        friend class tktrie;
+        const tktrie* trie_ = nullptr;
+        ebr_reader_record* rec_ = nullptr;
+        pin_t pin_{};
+        bool found_ = false;
+
+    public:
+        read_guard() noexcept = default;
+        read_guard(read_guard&& o) noexcept
+            : trie_(o.trie_), rec_(std::exchange(o.rec_, nullptr)), pin_(o.pin_),
+              found_(std::exchange(o.found_, false)) {}
+        read_guard& operator=(read_guard&& o) noexcept {
+            if (this != &o) {
+                release();
+                trie_ = o.trie_;
+                rec_ = std::exchange(o.rec_, nullptr);
+                pin_ = o.pin_;
+                found_ = std::exchange(o.found_, false);
+            }
+            return *this;
+        }
+        ~read_guard() { release(); }
+
+        explicit operator bool() const noexcept { return found_; }
+        const T& operator*() const noexcept {
+            if constexpr (data_t::PINNABLE) return *pin_;
+            else return pin_;
+        }
+        const T* operator->() const noexcept { return &**this; }
+
+        void release() noexcept {
+            if (rec_) trie_->reader_exit(rec_);
+            rec_ = nullptr;
+            found_ = false;
+        }
+    };
+    
+    read_guard find_ref(const Key& key) const;
+    
+    // Deepest stored key that is a prefix of key (key itself included), or
+    // end(): one descent, keeping the last EOS value passed on the way down.
+    // THREADED: the same reader epoch, path validation and retries as find().
+    iterator longest_prefix_match(std::string_view key) requires (FIXED_LEN == 0);
+    const_iterator longest_prefix_match(std::string_view key) const requires (FIXED_LEN == 0);
+    
+    // Calls fn(std::string_view key, const T& value) on every key starting
+    // with prefix, in order: one descent to the prefix's subtree, then a
+    // cursor walk through it. Values are not copied and key is one reused
+    // buffer, both valid for the call only. THREADED: the walk holds this
+    // thread's read epoch throughout (see read_guard), and sees each key that
+    // stays present for its whole duration exactly once.
+    template <typename Fn>
+    void for_each_with_prefix(std::string_view prefix, Fn&& fn) const requires (FIXED_LEN == 0);
+    // [first key with prefix, end): the end compares equal to the first
+    // iterator whose key lacks the prefix, so writes during the walk can't
+    // carry it past the prefix's keys
+    tktrie_range<iterator> prefix_range(std::string_view prefix) requires (FIXED_LEN == 0);
+    tktrie_range<const_iterator> prefix_range(std::string_view prefix) const requires (FIXED_LEN == 0);
+    
+    // Loads (key, value) pairs into an empty trie by building each node once,
+    // at its final type and skip, bottom-up from key order; a non-empty trie
+    // gets them as by insert_batch(). build_from_sorted expects ascending keys
+    // (it sorts if they are not); bulk_insert takes any order. For duplicate
+    // keys the first wins, as with insert(). Returns how many were added.
+    template <std::forward_iterator It>
+    size_t build_from_sorted(It first, It last);
+    template <std::forward_iterator It>
+    size_t bulk_insert(It first, It last);
+    
+    // Applies a batch in key order under one writer critical section: one
+    // lock, one epoch bump and one retirement for all of it. insert_batch
+    // gives each node it touches all of that node's new entries at once, so
+    // a node grows at most once, straight to its final type. Existing keys
+    // are left as they are, and the first of repeated keys wins, as with
+    // insert(). Returns how many keys were added or removed.
+    size_t insert_batch(std::span<const std::pair<Key, T>> kvs);
+    size_t erase_batch(std::span<const Key> keys) { return batch_erase(keys); }
+    size_t erase_batch(std::span<const std::string_view> keys) requires (FIXED_LEN == 0) { return batch_erase(keys); }
+    
+    // Erases every key starting with prefix, or in [lo, hi), in one writer
+    // critical section: subtrees wholly inside are unlinked whole, not key
+    // by key, and their nodes retired together. Returns how many keys went.
+    size_t erase_prefix(std::string_view prefix) requires (FIXED_LEN == 0);
+    size_t erase_range(const Key& lo, const Key& hi);
+    
+    // Writes the trie to out as a compact depth-first node stream, values
+    // through codec (write(tktrie_writer&, const T&)); load(in) replaces the
+    // trie's contents with a saved stream (codec.read(tktrie_reader&, T&)
+    // returns false on bad input), allocating each node once at its final
+    // type in a single pass. load returns false, with in's failbit set and
+    // the trie unchanged, if the stream is short or corrupt, or was saved by
+    // a trie with another key width (FIXED_LEN; key types of the same width
+    // are not told apart). THREADED: save holds the writer lock, and every
+    // write counts its key inside its commit, so the stream is a snapshot
+    // whose header matches its keys; it blocks writers but not readers. load
+    // builds the new tree first, then swaps it in under the writer lock and
+    // retires the old one, so readers racing it see the old keys or the new.
+    template <typename Codec = tktrie_codec<T>>
+    bool save(std::ostream& out, Codec codec = {}) const;
+    template <typename Codec = tktrie_codec<T>>
+    bool load(std::istream& in, Codec codec = {});
+    
+    // Looks up every key, overlapping the cache misses of up to 16 walks at
+    // a time; out[i] (out.size() >= keys.size()) gets keys[i]'s value or
+    // nullopt, or whether it is present. Returns how many were found.
+    // THREADED: enters the reader epoch once for the whole batch, and each
+    // answer is as of some moment during the call, as for find().
+    size_t find_batch(std::span<const Key> keys, std::span<std::optional<T>> out) const {
+        return batch_find(keys, out);
+    }
+    size_t find_batch(std::span<const std::string_view> keys, std::span<std::optional<T>> out) const
+        requires (FIXED_LEN == 0) {
+        return batch_find(keys, out);
+    }
+    size_t contains_batch(std::span<const Key> keys, std::span<bool> out) const { return batch_contains(keys, out); }
+    size_t contains_batch(std::span<const std::string_view> keys, std::span<bool> out) const requires (FIXED_LEN == 0) {
+        return batch_contains(keys, out);
+    }
+    
+    // std::map bounds: first key >= key (lower) or > key (upper).
+    // equal_range's second is upper_bound(key) as of the call, bounded so
+    // it also equals any iterator past key (see tktrie_iterator.h)
+    iterator lower_bound(const Key& key);
+    const_iterator lower_bound(const Key& key) const;
+    iterator upper_bound(const Key& key);
+    const_iterator upper_bound(const Key& key) const;
+    std::pair<iterator, iterator> equal_range(const Key& key);
+    std::pair<const_iterator, const_iterator> equal_range(const Key& key) const;
+    
+    // Calls fn(const Key& key, const T& value) on keys in [lo, hi) in order,
+    // stopping after limit of them; returns how many it visited. One descent
+    // to lo, then a cursor walk; same lifetimes as for_each_with_prefix.
+    template <typename Fn>
+    size_t scan(const Key& lo, const Key& hi, Fn&& fn, size_t limit = SIZE_MAX) const;
+    
+    // Calls fn(const T&) on the stored value without copying it. Returns
+    // whether key was found. Same lifetime rules as read_guard for the call.
+    template <typename Fn>
+    bool visit(const Key& key, Fn&& fn) const {
+        read_guard g = find_ref(key);
+        if (!g) return false;
+        std::forward<Fn>(fn)(*g);
+        return true;
+    }
+    
+    // Heterogeneous lookups and erases for string tries: a key given as a
+    // std::string_view, C string or byte span is used as it is, without
+    // building a std::string. Same semantics as the overloads above.
+    template <trie_key_view<Key> K> requires (FIXED_LEN == 0)
+    bool contains(const K& key) const { return contains_bytes(trie_key_bytes(key)); }
+    template <trie_key_view<Key> K> requires (FIXED_LEN == 0)
+    iterator find(const K& key) { return find_bytes<iterator>(this, trie_key_bytes(key)); }
+    template <trie_key_view<Key> K> requires (FIXED_LEN == 0)
+    const_iterator find(const K& key) const { return find_bytes<const_iterator>(this, trie_key_bytes(key)); }
+    template <trie_key_view<Key> K> requires (FIXED_LEN == 0)
+    read_guard find_ref(const K& key) const { return find_ref_bytes(trie_key_bytes(key)); }
+    template <trie_key_view<Key> K, typename Fn> requires (FIXED_LEN == 0)
+    bool visit(const K& key, Fn&& fn) const {
+        read_guard g = find_ref_bytes(trie_key_bytes(key));
+        if (!g) return false;
+        std::forward<Fn>(fn)(*g);
+        return true;
+    }
+    template <trie_key_view<Key> K> requires (FIXED_LEN == 0)
+    bool erase(const K& key) { return erase_bytes(trie_key_bytes(key)); }
+    template <trie_key_view<Key> K> requires (FIXED_LEN == 0)
+    iterator lower_bound(const K& key) { return iterator::make_seek(this, trie_key_bytes(key), false); }
+    template <trie_key_view<Key> K> requires (FIXED_LEN == 0)
+    const_iterator lower_bound(const K& key) const { return const_iterator::make_seek(this, trie_key_bytes(key), false); }
+    template <trie_key_view<Key> K> requires (FIXED_LEN == 0)
+    iterator upper_bound(const K& key) { return iterator::make_seek(this, trie_key_bytes(key), true); }
+    template <trie_key_view<Key> K> requires (FIXED_LEN == 0)
+    const_iterator upper_bound(const K& key) const { return const_iterator::make_seek(this, trie_key_bytes(key), true); }
+    template <trie_key_view<Key> K> requires (FIXED_LEN == 0)
+    std::pair<iterator, iterator> equal_range(const K& key) {
+        return equal_range_bytes<iterator>(this, trie_key_bytes(key));
+    }
+    template <trie_key_view<Key> K> requires (FIXED_LEN == 0)
+    std::pair<const_iterator, const_iterator> equal_range(const K& key) const {
+        return equal_range_bytes<const_iterator>(this, trie_key_bytes(key));
+    }
+    template <trie_key_view<Key> K1, trie_key_view<Key> K2, typename Fn> requires (FIXED_LEN == 0)
+    size_t scan(const K1& lo, const K2& hi, Fn&& fn, size_t limit = SIZE_MAX) const {
+        return scan_bytes(trie_key_bytes(lo), trie_key_bytes(hi), fn, limit);
+    }
+    template <trie_key_view<Key> K1, trie_key_view<Key> K2> requires (FIXED_LEN == 0)
+    size_t erase_range(const K1& lo, const K2& hi) { return erase_range_bytes(trie_key_bytes(lo), trie_key_bytes(hi)); }
+    
     // Forward iterators (non-const)
     iterator begin() { return iterator::make_begin(this); }
     iterator end() noexcept { return iterator::make_end(this); }
@@ -393,16 +1103,58 @@ public:
     
     void reclaim_retired() noexcept;
     
+    // Who frees retired nodes (THREADED only; see reclaim_policy). Not
+    // carried over by copy or move.
+    void set_reclaim_policy(reclaim_policy p);
+    reclaim_policy get_reclaim_policy() const noexcept;
+    // Frees retired nodes and values once no active reader can still reach
+    // them: those retired before the oldest active reader's epoch minus
+    // EBR_GRACE_EPOCHS. With no reader active it also moves the epoch past
+    // that grace period (saved cursors re-seek), so everything retired goes.
+    // The MANUAL hook, but safe under any policy and from any thread.
+    void poll();
+    // Nodes and values retired but not yet freed
+    size_t retired_count() const noexcept {
+        if constexpr (THREADED) return retired_count_.load(std::memory_order_relaxed);
+        return 0;
+    }
+    
     ptr_t test_root() const noexcept { return root_.load(); }
     
     // -------------------------------------------------------------------------
     // Internal iterator helpers - find key bytes and value
     // Return true if found, false for end()
     // -------------------------------------------------------------------------
-    bool find_first_bytes(std::string& out_key, T& out_value) const;
-    bool find_last_bytes(std::string& out_key, T& out_value) const;
-    bool find_greater_bytes(const std::string& key, std::string& out_key, T& out_value) const;
-    bool find_less_bytes(const std::string& key, std::string& out_key, T& out_value) const;
+    bool find_first_bytes(std::string& out_key, held_t& out_value) const;
+    bool find_last_bytes(std::string& out_key, held_t& out_value) const;
+    bool find_greater_bytes(const std::string& key, std::string& out_key, held_t& out_value) const;
+    bool find_less_bytes(const std::string& key, std::string& out_key, held_t& out_value) const;
+
+    // Cursor forms: FORWARD = toward larger keys. cursor_first finds the
+    // smallest (largest) key; cursor_seek the first key after (before)
+    // target, or at it unless STRICT; cursor_step the one after (before) the
+    // key it was last positioned on, which must be passed in as key.
+    bool cursor_first(cursor& cur, bool forward, std::string& out_key, held_t& out_value) const;
+    bool cursor_seek(cursor& cur, std::string_view target, bool forward, bool strict,
+                     std::string& out_key, held_t& out_value) const;
+    bool cursor_step(cursor& cur, bool forward, std::string& key, held_t& out_value) const;
+
+private:
+    // OUT is held_t, or pin_t for zero-copy walks
+    template <typename Walk>
+    bool cursor_run(cursor& cur, std::string& out_key, Walk&& walk) const;
+    template <typename Out>
+    bool cursor_next(cursor& cur, bool forward, Out& out_value) const;
+    template <typename Out>
+    bool cursor_seek_impl(cursor& cur, std::string_view target, bool forward, bool strict, Out& out_value) const;
+    void cursor_pop(cursor& cur) const noexcept;
+    bool cursor_validate(const cursor& cur) const noexcept;
+    bool cursor_usable(const cursor& cur) const noexcept;
+    // Zero-copy forward walk from the first key >= start while in_range(key)
+    template <typename InRange, typename Fn>
+    size_t cursor_walk(std::string_view start, InRange&& in_range, Fn&& fn, size_t limit) const;
+    // find_ref's body (with the other byte-level bodies, above read_guard)
+    read_guard find_ref_bytes(std::string_view kbv) const;
 };
 
 
@@ -430,6 +1182,13 @@ using int64_trie = tktrie<int64_t, T, false, Allocator>;
 template <typename T, typename Allocator = std::allocator<uint64_t>>
 using concurrent_int64_trie = tktrie<int64_t, T, true, Allocator>;
 
+template <size_t N, typename T, typename Allocator = std::allocator<uint64_t>>
+using bytes_trie = tktrie<std::array<uint8_t, N>, T, false, Allocator>;
+
+template <size_t N, typename T, typename Allocator = std::allocator<uint64_t>>
+using concurrent_bytes_trie = tktrie<std::array<uint8_t, N>, T, true, Allocator>;
+
 }  // namespace gteitelbaum
 
 #include "tktrie_core.h"
+#include "tktrie_sharded.h"
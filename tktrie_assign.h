@@ -0,0 +1,164 @@
+#pragma once
+
+// This file contains in-place value assignment (insert_or_assign, upsert)
+// It should only be included from tktrie_combine.h
+
+namespace gteitelbaum {
+
+#define TKTRIE_TEMPLATE template <typename Key, typename T, bool THREADED, typename Allocator>
+#define TKTRIE_CLASS tktrie<Key, T, THREADED, Allocator>
+
+// -----------------------------------------------------------------------------
+// In-place assignment
+// -----------------------------------------------------------------------------
+// A key's value lives in exactly one dataptr: an interior's EOS, a SKIP
+// leaf's value, or one entry of a multi-entry leaf. Overwriting it changes no
+// structure, so a writer locks just that node at the version it probed (a
+// live node at an unchanged version still holds the key), swaps the value
+// and unlocks. Readers see the version move and retry; the old heap value is
+// retired through the value_retire_sink, and the epoch bumped for it.
+
+// Node holding key's value (and for multi-entry leaves, its entry char), each
+// version read before the fields it guards. Null if absent or mid-retire.
+TKTRIE_TEMPLATE
+typename TKTRIE_CLASS::ptr_t TKTRIE_CLASS::probe_value_holder(
+    ptr_t n, std::string_view key, unsigned char& c, uint64_t& version) const noexcept {
+    while (n && !builder_t::is_sentinel(n)) {
+        version = n->version();
+        if (n->is_poisoned()) return nullptr;
+        if (!consume_prefix(key, n->skip_str())) return nullptr;
+        if (n->is_leaf()) {
+            if (n->is_skip()) return key.empty() ? n : nullptr;
+            if (key.size() != 1) return nullptr;
+            c = static_cast<unsigned char>(key[0]);
+            return n;
+        }
+        if (key.empty()) return n;
+        unsigned char edge = static_cast<unsigned char>(key[0]);
+        key.remove_prefix(1);
+        n = n->get_child(edge);
+    }
+    return nullptr;
+}
+
+// Replaces key's value with make(old) and returns true, or returns false if
+// key looked absent (the caller inserts, and retries here if that loses a race)
+TKTRIE_TEMPLATE
+template <typename Make>
+bool TKTRIE_CLASS::assign_existing(std::string_view kb, Make&& make) {
+    auto assign = [&make](auto& slot) {
+        pin_t pin{};
+        slot.try_read(pin);
+        const T* old;
+        if constexpr (data_t::PINNABLE) old = pin;
+        else old = &pin;
+        if constexpr (data_t::SHARED) slot.set(source_t(data_t::make_box(make(old))));
+        else slot.set(make(old));
+    };
+
+    if constexpr (!THREADED) {
+        std::lock_guard<mutex_t> lock(mutex_);
+        unsigned char c = 0;
+        uint64_t version = 0;
+        ptr_t n = probe_value_holder(root_.load(), kb, c, version);
+        return n && n->with_value_slot(c, assign);
+    } else {
+        maybe_reclaim(EBR_MIN_RETIRED);
+        
+        value_retire_guard values(*this);
+        auto* rec = reader_enter();
+        
+        static constexpr int MAX_RETRIES = 7;
+        
+        for (int retry = 0; retry <= MAX_RETRIES; ++retry) {
+            unsigned char c = 0;
+            uint64_t version = 0;
+            ptr_t n = probe_value_holder(root_.load(), kb, c, version);
+            if (!n) {
+                reader_exit(rec);
+                return false;
+            }
+            bool assigned;
+            {
+                commit_section commit(*this, rec);
+                commit_locks locks;
+                if (!locks.lock(n, version)) continue;
+                try {
+                    assigned = n->with_value_slot(c, assign);
+                } catch (...) {
+                    locks.release();
+                    reader_exit(rec);
+                    throw;
+                }
+                locks.release();
+            }
+            reader_exit(rec);
+            if (assigned) value_retired();
+            return assigned;
+        }
+        
+        bool assigned = false;
+        try {
+            exclusive_lock lock(*this);
+            unsigned char c = 0;
+            uint64_t version = 0;
+            ptr_t n = probe_value_holder(root_.load(), kb, c, version);
+            if (n) {
+                bool began = n->begin_write();
+                try {
+                    assigned = n->with_value_slot(c, assign);
+                } catch (...) {
+                    if (began) n->end_write();
+                    throw;
+                }
+                if (began) n->end_write();
+            }
+        } catch (...) {
+            reader_exit(rec);
+            throw;
+        }
+        reader_exit(rec);
+        if (assigned) value_retired();
+        return assigned;
+    }
+}
+
+// An overwrite retires the old box but no node: move the epoch on, as
+// structural writes do, or an update-only workload never reaches a point
+// where the box is past its grace period
+TKTRIE_TEMPLATE
+void TKTRIE_CLASS::value_retired() noexcept {
+    if constexpr (THREADED && !data_t::INLINE) epoch_.fetch_add(1, std::memory_order_release);
+}
+
+TKTRIE_TEMPLATE
+std::pair<typename TKTRIE_CLASS::iterator, bool> TKTRIE_CLASS::insert_or_assign(
+    const Key& key, const T& value) {
+    auto kb = traits::to_bytes(key);
+    std::string_view kbv(kb.data(), kb.size());
+    while (true) {
+        if (assign_existing(kbv, [&value](const T*) -> const T& { return value; })) {
+            return {iterator(this, kbv, value), false};
+        }
+        auto res = insert_bytes(key, kbv, value);
+        if (res.second) return res;
+    }
+}
+
+TKTRIE_TEMPLATE
+template <typename Fn>
+bool TKTRIE_CLASS::upsert(const Key& key, Fn&& fn) {
+    auto kb = traits::to_bytes(key);
+    std::string_view kbv(kb.data(), kb.size());
+    while (true) {
+        if (assign_existing(kbv, [&fn](const T* old) -> T { return fn(old); })) return false;
+        if (emplace_bytes(key, kbv, fn(static_cast<const T*>(nullptr))).second) return true;
+    }
+}
+
+#undef TKTRIE_TEMPLATE
+#undef TKTRIE_CLASS
+
+}  // namespace gteitelbaum
+
+#include "tktrie_cursor.h"
@@ -0,0 +1,172 @@
+#pragma once
+
+// This file contains the batched lookups
+// It should only be included from tktrie_cursor.h
+
+namespace gteitelbaum {
+
+#define TKTRIE_TEMPLATE template <typename Key, typename T, bool THREADED, typename Allocator>
+#define TKTRIE_CLASS tktrie<Key, T, THREADED, Allocator>
+
+// -----------------------------------------------------------------------------
+// Batched lookups
+// -----------------------------------------------------------------------------
+// Up to BATCH_LANES lookups walk in lockstep, one node each per round. A lane
+// that descends prefetches its child, and the other lanes' steps run while
+// that line is in flight, so a group's cache misses overlap instead of
+// queueing behind one another. THREADED: the batch holds one reader epoch;
+// each lane records and validates its own read_path like find(), and a lane
+// that fails validation is redone alone through the scalar retry loop.
+
+// One node of read_impl_optimistic's walk
+TKTRIE_TEMPLATE
+template <bool NEED_VALUE>
+inline typename TKTRIE_CLASS::batch_step TKTRIE_CLASS::batch_advance(batch_lane& l) const noexcept {
+    ptr_t n = l.node;
+    uint64_t h = n->header();
+    if constexpr (THREADED) {
+        if (!l.path.push(n)) return batch_step::MISS;
+        if (h & FLAG_POISON) return batch_step::MISS;
+    }
+
+    std::string_view& key = l.key;
+    if (h & FLAG_SKIP_USED) {
+        if (!consume_prefix(key, n->skip_str())) return batch_step::MISS;
+    }
+
+    if (h & FLAG_LEAF) [[unlikely]] {
+        bool found;
+        if (h & FLAG_SKIP) {
+            if constexpr (NEED_VALUE) found = key.empty() && n->as_skip()->value.try_read(l.pin);
+            else found = key.empty();
+        } else if (key.size() != 1) {
+            found = false;
+        } else {
+            unsigned char c = static_cast<unsigned char>(key[0]);
+            if constexpr (NEED_VALUE) found = n->try_read_leaf_value(c, l.pin);
+            else found = n->has_leaf_entry(c);
+        }
+        return found ? batch_step::FOUND : batch_step::MISS;
+    }
+
+    if (key.empty()) {
+        if constexpr (FIXED_LEN > 0) {
+            return batch_step::MISS;
+        } else {
+            if (!(h & FLAG_HAS_EOS)) return batch_step::MISS;
+            if constexpr (NEED_VALUE) return n->try_read_eos(l.pin) ? batch_step::FOUND : batch_step::MISS;
+            else return batch_step::FOUND;
+        }
+    }
+
+    unsigned char c = static_cast<unsigned char>(key[0]);
+    key.remove_prefix(1);
+    l.node = n->get_child(c);
+    if (!l.node) return batch_step::MISS;
+    KTRIE_PREFETCH(l.node);
+    return batch_step::DESCEND;
+}
+
+// A lane whose path did not validate: the same retries as find()
+TKTRIE_TEMPLATE
+template <bool NEED_VALUE>
+bool TKTRIE_CLASS::batch_retry(std::string_view kbv, pin_t& pin) const {
+    read_path path;
+    for (int attempts = 0; attempts < OPTIMISTIC_READ_ATTEMPTS; ++attempts) {
+        path.clear();
+        bool found;
+        if constexpr (NEED_VALUE) found = read_impl_optimistic<true>(root_.load(), kbv, pin, path);
+        else found = read_impl_optimistic<false>(root_.load(), kbv, path);
+        if (validate_read_path(path)) return found;
+    }
+    exclusive_lock lock(*this);
+    if constexpr (NEED_VALUE) return read_impl<true>(root_.load(), kbv, pin);
+    else return read_impl<false>(root_.load(), kbv);
+}
+
+// Calls done(i, found, pin) once per key, in no particular order
+TKTRIE_TEMPLATE
+template <bool NEED_VALUE, typename K, typename Done>
+void TKTRIE_CLASS::batch_lookup(std::span<const K> keys, Done&& done) const {
+    if constexpr (THREADED) const_cast<tktrie*>(this)->maybe_reclaim(EBR_MIN_RETIRED * 2);
+    ebr_reader_record* rec = nullptr;
+    if constexpr (THREADED) rec = reader_enter();
+
+    std::array<batch_lane, BATCH_LANES> lanes;
+    std::array<int, BATCH_LANES> active;
+    for (size_t base = 0; base < keys.size(); base += BATCH_LANES) {
+        int count = static_cast<int>(std::min(keys.size() - base, BATCH_LANES));
+        ptr_t root = root_.load();
+        if (!root) {
+            for (int i = 0; i < count; ++i) done(base + i, false, lanes[0].pin);
+            continue;
+        }
+        for (int i = 0; i < count; ++i) {
+            batch_lane& l = lanes[i];
+            l.kb = key_bytes_of(keys[base + i]);
+            l.key = std::string_view(l.kb.data(), l.kb.size());
+            l.node = root;
+            if constexpr (THREADED) l.path.clear();
+            active[i] = i;
+        }
+
+        int live = count;
+        while (live > 0) {
+            int kept = 0;
+            for (int a = 0; a < live; ++a) {
+                batch_lane& l = lanes[active[a]];
+                batch_step s = batch_advance<NEED_VALUE>(l);
+                if (s == batch_step::DESCEND) {
+                    active[kept++] = active[a];
+                    continue;
+                }
+                bool found = s == batch_step::FOUND;
+                if constexpr (THREADED) {
+                    if (!validate_read_path(l.path)) {
+                        found = batch_retry<NEED_VALUE>(std::string_view(l.kb.data(), l.kb.size()), l.pin);
+                    }
+                }
+                done(base + active[a], found, l.pin);
+            }
+            live = kept;
+        }
+    }
+
+    if constexpr (THREADED) reader_exit(rec);
+}
+
+TKTRIE_TEMPLATE
+template <typename K>
+size_t TKTRIE_CLASS::batch_find(std::span<const K> keys, std::span<std::optional<T>> out) const {
+    KTRIE_DEBUG_ASSERT(out.size() >= keys.size());
+    size_t hits = 0;
+    batch_lookup<true>(keys, [&](size_t i, bool found, const pin_t& pin) {
+        if (!found) {
+            out[i].reset();
+            return;
+        }
+        if constexpr (data_t::PINNABLE) out[i].emplace(*pin);
+        else out[i].emplace(pin);
+        ++hits;
+    });
+    return hits;
+}
+
+TKTRIE_TEMPLATE
+template <typename K>
+size_t TKTRIE_CLASS::batch_contains(std::span<const K> keys, std::span<bool> out) const {
+    KTRIE_DEBUG_ASSERT(out.size() >= keys.size());
+    size_t hits = 0;
+    batch_lookup<false>(keys, [&](size_t i, bool found, const pin_t&) {
+        out[i] = found;
+        hits += found;
+    });
+    return hits;
+}
+
+#undef TKTRIE_TEMPLATE
+#undef TKTRIE_CLASS
+
+}  // namespace gteitelbaum
+
+#include "tktrie_bulk.h"
@@ -0,0 +1,426 @@
+#pragma once
+
+// This file contains the bottom-up bulk loader
+// It should only be included from tktrie_batch.h
+
+#include <algorithm>
+
+namespace gteitelbaum {
+
+#define TKTRIE_TEMPLATE template <typename Key, typename T, bool THREADED, typename Allocator>
+#define TKTRIE_CLASS tktrie<Key, T, THREADED, Allocator>
+
+// -----------------------------------------------------------------------------
+// Bulk load
+// -----------------------------------------------------------------------------
+// Sorted keys lay the trie out in order: a run of keys sharing a prefix is one
+// subtree, its skip is the run's common prefix (that of its first and last
+// keys), and its entries are the runs of the next byte. Each node is built
+// once, at its final type and skip, with no probing, node growth, retirement
+// or epoch bumps. The finished tree is published under the writer lock if the
+// trie is still empty.
+//
+// Otherwise the batch is applied in one writer critical section: the sorted
+// run under each existing node is merged into it at once (batch_apply), so a
+// node that gains several entries is copied once to its final type rather
+// than once per growth step, and epoch_ is bumped and the batch's old nodes
+// retired once for the whole batch.
+
+TKTRIE_TEMPLATE
+template <bool IS_LEAF, typename Fill>
+typename TKTRIE_CLASS::ptr_t TKTRIE_CLASS::bulk_node(std::string_view skip, int count, Fill&& fill) {
+    if (count <= BINARY_MAX) {
+        ptr_t n = builder_.template make_binary<IS_LEAF>(skip);
+        fill(n->template as_binary<IS_LEAF>());
+        n->template as_binary<IS_LEAF>()->update_capacity_flags();
+        return n;
+    }
+    if (count <= LIST_MAX) {
+        ptr_t n = builder_.template make_list<IS_LEAF>(skip);
+        fill(n->template as_list<IS_LEAF>());
+        n->template as_list<IS_LEAF>()->update_capacity_flags();
+        return n;
+    }
+    if (count <= POP_MAX) {
+        ptr_t n = builder_.template make_pop<IS_LEAF>(skip);
+        fill(n->template as_pop<IS_LEAF>());
+        n->template as_pop<IS_LEAF>()->update_capacity_flags();
+        return n;
+    }
+    ptr_t n = builder_.template make_full<IS_LEAF>(skip);
+    fill(n->template as_full<IS_LEAF>());
+    n->template as_full<IS_LEAF>()->update_capacity_flags();
+    return n;
+}
+
+// Subtree for e[0, n), sorted and distinct, all sharing their first depth bytes
+TKTRIE_TEMPLATE
+typename TKTRIE_CLASS::ptr_t TKTRIE_CLASS::bulk_build(const bulk_entry* e, size_t n, size_t depth) {
+    if (n == 1) return builder_.make_leaf_skip(e[0].bytes().substr(depth), *e[0].value);
+
+    std::string_view first = e[0].bytes(), last = e[n - 1].bytes();
+    size_t p = depth;
+    while (p < first.size() && p < last.size() && first[p] == last[p]) ++p;
+    std::string_view skip = first.substr(depth, p - depth);
+
+    // Only the first key can end at the skip: it is a prefix of the rest
+    size_t begin = first.size() == p ? 1 : 0;
+    bool leaf = begin == 0;
+    int count = 0;
+    for (size_t i = begin; i < n; ++i) {
+        std::string_view k = e[i].bytes();
+        if (k.size() != p + 1) leaf = false;
+        if (i == begin || k[p] != e[i - 1].bytes()[p]) ++count;
+    }
+
+    if (leaf) {
+        return bulk_node<true>(skip, count, [&](auto* node) {
+            for (size_t i = 0; i < n; ++i) {
+                node->add_entry(static_cast<unsigned char>(e[i].bytes()[p]), *e[i].value);
+            }
+        });
+    }
+    ptr_t node = bulk_node<false>(skip, count, [&](auto* node) { bulk_children(node, e + begin, n - begin, p); });
+    if (begin) node->set_eos(*e[0].value);
+    return node;
+}
+
+// One child per run of e's byte at depth
+TKTRIE_TEMPLATE
+template <typename Node>
+void TKTRIE_CLASS::bulk_children(Node* node, const bulk_entry* e, size_t n, size_t depth) {
+    for (size_t s = 0; s < n;) {
+        char c = e[s].bytes()[depth];
+        size_t t = s + 1;
+        while (t < n && e[t].bytes()[depth] == c) ++t;
+        node->add_entry(static_cast<unsigned char>(c), bulk_build(e + s, t - s, depth + 1));
+        s = t;
+    }
+}
+
+// The FIXED_LEN root is always an interior node with no skip
+TKTRIE_TEMPLATE
+typename TKTRIE_CLASS::ptr_t TKTRIE_CLASS::bulk_root(const bulk_entry* e, size_t n) {
+    if constexpr (FIXED_LEN == 0) {
+        return bulk_build(e, n, 0);
+    } else {
+        int count = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (i == 0 || e[i].bytes()[0] != e[i - 1].bytes()[0]) ++count;
+        }
+        auto fill = [&](auto* node) { bulk_children(node, e, n, 0); };
+        if (count <= LIST_MAX) {
+            ptr_t r = builder_.make_interior_list("");
+            fill(r->template as_list<false>());
+            r->template as_list<false>()->update_capacity_flags();
+            return r;
+        }
+        return bulk_node<false>("", count, fill);
+    }
+}
+
+// Calls fn with n's typed view
+TKTRIE_TEMPLATE
+template <bool IS_LEAF, typename Fn>
+void TKTRIE_CLASS::batch_typed(ptr_t n, Fn&& fn) {
+    if (n->is_binary()) fn(n->template as_binary<IS_LEAF>());
+    else if (n->is_list()) fn(n->template as_list<IS_LEAF>());
+    else if (n->is_pop()) fn(n->template as_pop<IS_LEAF>());
+    else fn(n->template as_full<IS_LEAF>());
+}
+
+// n's entries and EOS plus add's, in one node of the type count needs
+TKTRIE_TEMPLATE
+template <bool IS_LEAF, typename Add>
+typename TKTRIE_CLASS::ptr_t TKTRIE_CLASS::batch_grow(ptr_t n, int count, Add&& add) {
+    using ops = trie_ops<T, THREADED, Allocator, FIXED_LEN>;
+    ptr_t grown = nullptr;
+    batch_typed<IS_LEAF>(n, [&](auto* src) {
+        grown = bulk_node<IS_LEAF>(n->skip_str(), count, [&](auto* dst) {
+            ops::template copy_entries<IS_LEAF>(src, dst);
+            add(dst);
+        });
+        if constexpr (!IS_LEAF) ops::copy_eos_to(src, grown);
+    });
+    return grown;
+}
+
+// Adds with add() in place if count still fits n's type, else swaps in a
+// grown copy and retires n
+TKTRIE_TEMPLATE
+template <bool IS_LEAF, typename Add>
+void TKTRIE_CLASS::batch_add(atomic_ptr* slot, ptr_t n, int count, Add&& add, std::vector<ptr_t>& retired) {
+    int cap = n->is_binary() ? BINARY_MAX : n->is_list() ? LIST_MAX : n->is_pop() ? POP_MAX : 256;
+    if (count <= cap) {
+        bool began = n->begin_write();
+        batch_typed<IS_LEAF>(n, [&](auto* node) {
+            add(node);
+            node->update_capacity_flags();
+        });
+        if (began) n->end_write();
+        return;
+    }
+    ptr_t grown = batch_grow<IS_LEAF>(n, count, add);
+    if constexpr (THREADED) slot->store(get_retry_sentinel<T, THREADED, Allocator, FIXED_LEN>());
+    slot->store(grown);
+    retired.push_back(n);
+}
+
+// Through insert_impl, one key at a time, where a run does not fit a node
+TKTRIE_TEMPLATE
+size_t TKTRIE_CLASS::batch_insert_each(atomic_ptr* slot, const bulk_entry* e, size_t n, size_t depth,
+                                       std::vector<ptr_t>& retired) {
+    size_t inserted = 0;
+    for (size_t i = 0; i < n; ++i) {
+        ptr_t node = slot->load();
+        auto res = insert_impl(slot, node, e[i].bytes().substr(depth), *e[i].value);
+        if (res.new_node && res.new_node != node) {
+            if constexpr (THREADED) slot->store(get_retry_sentinel<T, THREADED, Allocator, FIXED_LEN>());
+            slot->store(res.new_node);
+        }
+        for (auto* old : res.old_nodes) retired.push_back(old);
+        inserted += res.inserted;
+    }
+    return inserted;
+}
+
+// Inserts e[0, n), sorted and distinct, all sharing their first depth bytes,
+// into the subtree at slot; returns how many were new. A missing subtree is
+// bulk built; a node whose skip the whole run matches takes all of its new
+// entries at once, growing at most once, straight to its final type.
+TKTRIE_TEMPLATE
+size_t TKTRIE_CLASS::batch_apply(atomic_ptr* slot, const bulk_entry* e, size_t n, size_t depth,
+                                 std::vector<ptr_t>& retired) {
+    ptr_t node = slot->load();
+    if (!node || node->is_poisoned() || builder_t::is_sentinel(node)) {
+        slot->store(slot == &root_ ? bulk_root(e, n) : bulk_build(e, n, depth));
+        return n;
+    }
+
+    std::string_view skip = node->skip_str();
+    size_t p = depth + skip.size();
+    std::string_view first = e[0].bytes(), last = e[n - 1].bytes();
+    // Sorted: all of the run shares the prefix its first and last keys share
+    if (node->is_skip() || first.size() < p || last.size() < p || first.substr(depth, skip.size()) != skip ||
+        last.substr(depth, skip.size()) != skip) {
+        return batch_insert_each(slot, e, n, depth, retired);
+    }
+
+    if (node->is_leaf()) {
+        int added = 0;
+        for (size_t i = 0; i < n; ++i) {
+            std::string_view k = e[i].bytes();
+            if (k.size() != p + 1) return batch_insert_each(slot, e, n, depth, retired);
+            added += !node->has_leaf_entry(static_cast<unsigned char>(k[p]));
+        }
+        if (added == 0) return 0;
+        // Distinct keys of one length: one new char each
+        batch_add<true>(slot, node, node->leaf_entry_count() + added, [&](auto* dst) {
+            for (size_t i = 0; i < n; ++i) {
+                unsigned char c = static_cast<unsigned char>(e[i].bytes()[p]);
+                if (!dst->has(c)) dst->add_entry(c, *e[i].value);
+            }
+        }, retired);
+        return added;
+    }
+
+    size_t inserted = 0;
+    size_t begin = 0;
+    if (first.size() == p) {
+        begin = 1;
+        if constexpr (FIXED_LEN == 0) {
+            if (!node->has_eos()) {
+                bool began = node->begin_write();
+                node->set_eos(*e[0].value);
+                if (began) node->end_write();
+                ++inserted;
+            }
+        }
+    }
+
+    // Runs under existing children recurse; the others become new subtrees
+    std::vector<std::pair<unsigned char, ptr_t>> fresh;
+    for (size_t s = begin; s < n;) {
+        char c = e[s].bytes()[p];
+        size_t t = s + 1;
+        while (t < n && e[t].bytes()[p] == c) ++t;
+        unsigned char uc = static_cast<unsigned char>(c);
+        if (ptr_t child = node->get_child(uc)) {
+            inserted += batch_apply(node->get_child_slot(uc), e + s, t - s, p + 1, retired);
+            // A child swapped in its slot changes node too: a commit that
+            // probed node before must not clone the old child back in
+            if (node->get_child(uc) != child) node->bump_version();
+        } else {
+            fresh.emplace_back(uc, bulk_build(e + s, t - s, p + 1));
+            inserted += t - s;
+        }
+        s = t;
+    }
+    if (fresh.empty()) return inserted;
+    batch_add<false>(slot, node, node->child_count() + static_cast<int>(fresh.size()), [&](auto* dst) {
+        for (auto [c, child] : fresh) dst->add_entry(c, child);
+    }, retired);
+    return inserted;
+}
+
+// Sorts entries by key bytes and drops repeats, keeping the first of each
+TKTRIE_TEMPLATE
+void TKTRIE_CLASS::bulk_sort(std::vector<bulk_entry>& entries, bool sorted) {
+    auto less = [](const bulk_entry& a, const bulk_entry& b) {
+        if constexpr (FIXED_LEN > 0) return std::memcmp(a.kb.data(), b.kb.data(), FIXED_LEN) < 0;
+        else return a.bytes() < b.bytes();
+    };
+    if (!sorted) std::stable_sort(entries.begin(), entries.end(), less);
+    entries.erase(std::unique(entries.begin(), entries.end(),
+                              [](const bulk_entry& a, const bulk_entry& b) { return a.bytes() == b.bytes(); }),
+                  entries.end());
+}
+
+// One writer critical section and at most one epoch bump for the batch
+TKTRIE_TEMPLATE
+size_t TKTRIE_CLASS::batch_insert(const bulk_entry* e, size_t n) {
+    std::vector<ptr_t> retired;
+    size_t inserted = 0;
+    auto apply = [&]() {
+        inserted = batch_apply(&root_, e, n, 0, retired);
+        size_.fetch_add(inserted);
+        if constexpr (THREADED) {
+            if (inserted || !retired.empty()) epoch_.fetch_add(1, std::memory_order_release);
+        }
+        ebr_retire_batch(retired);
+    };
+    if constexpr (THREADED) {
+        {
+            exclusive_lock lock(*this);
+            value_retire_guard values(*this);
+            apply();
+        }
+        maybe_reclaim(EBR_MIN_RETIRED);
+    } else {
+        std::lock_guard<mutex_t> lock(mutex_);
+        apply();
+    }
+    return inserted;
+}
+
+TKTRIE_TEMPLATE
+size_t TKTRIE_CLASS::bulk_load(std::vector<bulk_entry>& entries, bool sorted) {
+    bulk_sort(entries, sorted);
+    if (entries.empty()) return 0;
+
+    if (empty()) {
+        ptr_t built = bulk_root(entries.data(), entries.size());
+        auto publish = [&]() {
+            if (size_.load() != 0) return false;
+            ptr_t old = root_.load();
+            if constexpr (THREADED) {
+                epoch_.fetch_add(1, std::memory_order_release);
+                root_.store(get_retry_sentinel<T, THREADED, Allocator, FIXED_LEN>());
+            }
+            root_.store(built);
+            size_.store(entries.size());
+            retire_node(old);
+            return true;
+        };
+        bool published;
+        if constexpr (THREADED) {
+            exclusive_lock lock(*this);
+            published = publish();
+        } else {
+            std::lock_guard<mutex_t> lock(mutex_);
+            published = publish();
+        }
+        if (published) return entries.size();
+        builder_.dealloc_node(built);
+    }
+
+    return batch_insert(entries.data(), entries.size());
+}
+
+TKTRIE_TEMPLATE
+template <std::forward_iterator It>
+size_t TKTRIE_CLASS::build_from_sorted(It first, It last) {
+    std::vector<bulk_entry> entries;
+    if constexpr (std::random_access_iterator<It>) entries.reserve(static_cast<size_t>(last - first));
+    bool sorted = true;
+    for (; first != last; ++first) {
+        const auto& kv = *first;
+        entries.push_back({traits::to_bytes(kv.first), &kv.first, &kv.second});
+        if (entries.size() > 1 && entries.back().bytes() < entries[entries.size() - 2].bytes()) sorted = false;
+    }
+    return bulk_load(entries, sorted);
+}
+
+TKTRIE_TEMPLATE
+template <std::forward_iterator It>
+size_t TKTRIE_CLASS::bulk_insert(It first, It last) {
+    std::vector<bulk_entry> entries;
+    if constexpr (std::random_access_iterator<It>) entries.reserve(static_cast<size_t>(last - first));
+    for (; first != last; ++first) {
+        const auto& kv = *first;
+        entries.push_back({traits::to_bytes(kv.first), &kv.first, &kv.second});
+    }
+    return bulk_load(entries, false);
+}
+
+TKTRIE_TEMPLATE
+size_t TKTRIE_CLASS::insert_batch(std::span<const std::pair<Key, T>> kvs) {
+    std::vector<bulk_entry> entries;
+    entries.reserve(kvs.size());
+    for (const auto& kv : kvs) entries.push_back({traits::to_bytes(kv.first), &kv.first, &kv.second});
+    return bulk_load(entries, false);
+}
+
+// Erases share the one critical section, epoch bump and retire CAS; each
+// still takes its own walk, as a node's removals can collapse it
+TKTRIE_TEMPLATE
+template <typename K>
+size_t TKTRIE_CLASS::batch_erase(std::span<const K> keys) {
+    std::vector<bulk_entry> entries;
+    entries.reserve(keys.size());
+    for (const K& k : keys) entries.push_back({key_bytes_of(k), nullptr, nullptr});
+    bulk_sort(entries, false);
+
+    std::vector<ptr_t> retired;
+    size_t erased = 0;
+    auto apply = [&]() {
+        for (const auto& en : entries) {
+            auto res = erase_impl(&root_, root_.load(), en.bytes());
+            if (res.erased) {
+                if (res.deleted_subtree) {
+                    if constexpr (THREADED) root_.store(get_retry_sentinel<T, THREADED, Allocator, FIXED_LEN>());
+                    root_.store(nullptr);
+                } else if (res.new_node) {
+                    if constexpr (THREADED) root_.store(get_retry_sentinel<T, THREADED, Allocator, FIXED_LEN>());
+                    root_.store(res.new_node);
+                }
+                ++erased;
+            }
+            for (auto* old : res.old_nodes) retired.push_back(old);
+        }
+        size_.fetch_sub(erased);
+        if constexpr (THREADED) {
+            if (erased || !retired.empty()) epoch_.fetch_add(1, std::memory_order_release);
+        }
+        ebr_retire_batch(retired);
+    };
+    if constexpr (THREADED) {
+        {
+            exclusive_lock lock(*this);
+            value_retire_guard values(*this);
+            apply();
+        }
+        maybe_reclaim(EBR_MIN_RETIRED);
+    } else {
+        std::lock_guard<mutex_t> lock(mutex_);
+        apply();
+    }
+    return erased;
+}
+
+#undef TKTRIE_TEMPLATE
+#undef TKTRIE_CLASS
+
+}  // namespace gteitelbaum
+
+#include "tktrie_erase_range.h"
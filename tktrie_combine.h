@@ -0,0 +1,135 @@
+#pragma once
+
+// This file contains the flat-combining batch writer
+// It should only be included from tktrie_erase.h
+
+#include <algorithm>
+
+namespace gteitelbaum {
+
+#define TKTRIE_TEMPLATE template <typename Key, typename T, bool THREADED, typename Allocator>
+#define TKTRIE_CLASS tktrie<Key, T, THREADED, Allocator>
+
+// -----------------------------------------------------------------------------
+// Flat combining
+// -----------------------------------------------------------------------------
+// A poster parks its request in its own EBR record, then either waits for it
+// to be served or takes the writer lock and serves everyone's. The combiner
+// applies the batch in key order through the locked insert/erase paths,
+// bumps epoch_ once and retires the batch's nodes with a single CAS.
+// Every request taken is completed: an op that throws (T's copy, say) hands
+// its exception back to its poster and the rest of the batch goes on.
+
+TKTRIE_TEMPLATE
+void TKTRIE_CLASS::combine_pending() noexcept {
+    fc_batch_.clear();
+    readers_->for_each([this](ebr_reader_record* r) {
+        if (!r->publication.load(std::memory_order_relaxed)) return;
+        if (void* p = r->publication.exchange(nullptr, std::memory_order_acquire)) {
+            try {
+                fc_batch_.push_back(static_cast<fc_request*>(p));
+            } catch (...) {
+                r->publication.store(p, std::memory_order_release);  // Left for a later pass
+            }
+        }
+    });
+    if (fc_batch_.empty()) return;
+    value_retire_guard values(*this);
+
+    // Neighbouring keys share a path, so it stays hot in cache between ops
+    std::sort(fc_batch_.begin(), fc_batch_.end(),
+              [](const fc_request* a, const fc_request* b) { return a->key_bytes < b->key_bytes; });
+
+    fc_retired_.clear();
+    for (fc_request* req : fc_batch_) {
+        try {
+            // An op retires at most 4 nodes: make room first, so once the tree
+            // has changed nothing below can throw
+            fc_retired_.reserve(fc_retired_.size() + 4);
+            if (req->is_insert) {
+                auto res = insert_impl(&root_, root_.load(), req->key_bytes, *req->value);
+                if (res.inserted && res.new_node) {
+                    root_.store(get_retry_sentinel<T, THREADED, Allocator, FIXED_LEN>());
+                    root_.store(res.new_node);
+                }
+                for (auto* old : res.old_nodes) fc_retired_.push_back(old);
+                if (res.inserted) size_.fetch_add(1);
+                req->result = res.inserted;
+            } else {
+                auto res = erase_impl(&root_, root_.load(), req->key_bytes);
+                if (res.erased) {
+                    if (res.deleted_subtree) {
+                        root_.store(get_retry_sentinel<T, THREADED, Allocator, FIXED_LEN>());
+                        root_.store(nullptr);
+                    } else if (res.new_node) {
+                        root_.store(get_retry_sentinel<T, THREADED, Allocator, FIXED_LEN>());
+                        root_.store(res.new_node);
+                    }
+                    size_.fetch_sub(1);
+                }
+                for (auto* old : res.old_nodes) fc_retired_.push_back(old);
+                req->result = res.erased;
+            }
+        } catch (...) {
+            req->error = std::current_exception();
+        }
+    }
+
+    if (!fc_retired_.empty()) {
+        epoch_.fetch_add(1, std::memory_order_release);
+        ebr_retire_batch(fc_retired_);
+    }
+    // Last touch of each request: its owner may return as soon as it sees done
+    for (fc_request* req : fc_batch_) req->done.store(true, std::memory_order_release);
+}
+
+TKTRIE_TEMPLATE
+bool TKTRIE_CLASS::run_combined(fc_request& req) {
+    auto* rec = reader_enter();
+    rec->publication.store(&req, std::memory_order_release);
+    while (!req.done.load(std::memory_order_acquire)) {
+        exclusive_lock lock(*this, std::try_to_lock);
+        if (lock.owns) combine_pending();
+        else std::this_thread::yield();
+    }
+    reader_exit(rec);
+    maybe_reclaim(EBR_MIN_RETIRED);
+    if (req.error) std::rethrow_exception(req.error);
+    return req.result;
+}
+
+TKTRIE_TEMPLATE
+std::pair<typename TKTRIE_CLASS::iterator, bool> TKTRIE_CLASS::insert_combined(
+    const std::pair<const Key, T>& kv) {
+    if constexpr (!THREADED) {
+        return insert(kv);
+    } else {
+        auto kb = traits::to_bytes(kv.first);
+        fc_request req;
+        req.key_bytes.assign(kb.data(), kb.size());
+        req.value = &kv.second;
+        req.is_insert = true;
+        bool inserted = run_combined(req);
+        return {iterator(this, req.key_bytes, kv.second), inserted};
+    }
+}
+
+TKTRIE_TEMPLATE
+bool TKTRIE_CLASS::erase_combined(const Key& key) {
+    if constexpr (!THREADED) {
+        return erase(key);
+    } else {
+        auto kb = traits::to_bytes(key);
+        fc_request req;
+        req.key_bytes.assign(kb.data(), kb.size());
+        req.is_insert = false;
+        return run_combined(req);
+    }
+}
+
+#undef TKTRIE_TEMPLATE
+#undef TKTRIE_CLASS
+
+}  // namespace gteitelbaum
+
+#include "tktrie_assign.h"
@@ -9,78 +9,172 @@ namespace gteitelbaum {
 #define TKTRIE_CLASS tktrie<Key, T, THREADED, Allocator>
 
 TKTRIE_TEMPLATE
-void TKTRIE_CLASS::node_deleter(void* ptr) {
-    if (!ptr) return;
-    auto* n = static_cast<ptr_t>(ptr);
-    if (builder_t::is_sentinel(n)) return;
-    builder_t::delete_node(n);
+void TKTRIE_CLASS::node_deleter(ptr_t n) {
+    if (!n || builder_t::is_sentinel(n)) return;
+    builder_.delete_node(n);
 }
 
 TKTRIE_TEMPLATE
 void TKTRIE_CLASS::retire_node(ptr_t n) {
     if (!n || builder_t::is_sentinel(n)) return;
     if constexpr (THREADED) {
-        n->poison();
-        uint64_t epoch = epoch_.load(std::memory_order_acquire);
-        ebr_retire(n, epoch);
+        ebr_retire(n);
     } else {
+        ++epoch_;  // Cursors holding n re-seek (see cursor_usable)
         node_deleter(n);
     }
 }
 
+// Writers retire concurrently, so the push is a CAS (still no allocation).
+// The epoch is read after the head it links to, so retire epochs never
+// decrease from the list tail to its head.
 TKTRIE_TEMPLATE
-void TKTRIE_CLASS::ebr_retire(ptr_t n, uint64_t epoch) {
+void TKTRIE_CLASS::ebr_retire(ptr_t n) {
     if constexpr (THREADED) {
-        auto* entry = new retire_entry_t(n, epoch);
-        retire_entry_t* old_head = retired_head_.load(std::memory_order_relaxed);
+        ptr_t head = retired_head_.load(std::memory_order_acquire);
         do {
-            entry->next = old_head;
-        } while (!retired_head_.compare_exchange_weak(old_head, entry,
-                    std::memory_order_release, std::memory_order_relaxed));
+            n->mark_retired(epoch_.load(std::memory_order_acquire));
+            builder_t::retire_next(n) = head;
+        } while (!retired_head_.compare_exchange_weak(head, n,
+                    std::memory_order_acq_rel, std::memory_order_acquire));
         retired_count_.fetch_add(1, std::memory_order_relaxed);
     }
 }
 
+// Same shape as ebr_retire; boxes carry their own link and epoch
 TKTRIE_TEMPLATE
-size_t TKTRIE_CLASS::reader_enter() const noexcept {
+void TKTRIE_CLASS::retire_value(value_box_t* b) noexcept {
+    if constexpr (THREADED) {
+        value_box_t* head = retired_values_.load(std::memory_order_acquire);
+        do {
+            b->retire_epoch = epoch_.load(std::memory_order_acquire);
+            b->retire_next = head;
+        } while (!retired_values_.compare_exchange_weak(head, b,
+                    std::memory_order_acq_rel, std::memory_order_acquire));
+        retired_count_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        data_t::destroy_box(b);
+    }
+}
+
+TKTRIE_TEMPLATE
+void TKTRIE_CLASS::retire_value_to(void* trie, value_box_t* b) noexcept {
+    static_cast<tktrie*>(trie)->retire_value(b);
+}
+
+// One CAS for a whole chain, all stamped with the same epoch (re-read per
+// attempt for the same monotonicity as ebr_retire)
+TKTRIE_TEMPLATE
+void TKTRIE_CLASS::ebr_retire_batch(const std::vector<ptr_t>& nodes) {
+    if constexpr (THREADED) {
+        if (nodes.empty()) return;
+        for (size_t i = 0; i + 1 < nodes.size(); ++i) builder_t::retire_next(nodes[i]) = nodes[i + 1];
+        ptr_t first = nodes.front();
+        ptr_t last = nodes.back();
+        ptr_t head = retired_head_.load(std::memory_order_acquire);
+        do {
+            uint64_t e = epoch_.load(std::memory_order_acquire);
+            for (ptr_t n : nodes) n->mark_retired(e);
+            builder_t::retire_next(last) = head;
+        } while (!retired_head_.compare_exchange_weak(head, first,
+                    std::memory_order_acq_rel, std::memory_order_acquire));
+        retired_count_.fetch_add(nodes.size(), std::memory_order_relaxed);
+    } else {
+        if (!nodes.empty()) ++epoch_;
+        for (ptr_t n : nodes) node_deleter(n);
+    }
+}
+
+// Nodes were freed without waiting out readers: push the epoch a full grace
+// period on, so no saved cursor path is trusted again
+TKTRIE_TEMPLATE
+void TKTRIE_CLASS::invalidate_cursors() noexcept {
+    if constexpr (THREADED) {
+        epoch_.fetch_add(EBR_GRACE_EPOCHS, std::memory_order_acq_rel);
+    } else {
+        ++epoch_;
+    }
+}
+
+// Enter/exit touch only the calling thread's record: O(1), no CAS once registered.
+// Nested entries on the same trie keep the outermost epoch.
+TKTRIE_TEMPLATE
+ebr_reader_record* TKTRIE_CLASS::reader_enter() const {
+    if constexpr (THREADED) {
+        ebr_reader_record* rec = ebr_local_cache().lookup(readers_);
+        if (rec->depth++ == 0) {
+            rec->epoch.store(epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+        }
+        return rec;
+    }
+    return nullptr;
+}
+
+TKTRIE_TEMPLATE
+void TKTRIE_CLASS::reader_exit(ebr_reader_record* rec) const noexcept {
+    if constexpr (THREADED) {
+        if (--rec->depth == 0) {
+            rec->epoch.store(0, std::memory_order_seq_cst);
+            if (rec->transient) ebr_registry::release(rec);
+        }
+    } else {
+        (void)rec;
+    }
+}
+
+// Dekker-style handshake: each side publishes its flag, then checks the other's
+TKTRIE_TEMPLATE
+void TKTRIE_CLASS::commit_enter(ebr_reader_record* rec) const {
     if constexpr (THREADED) {
-        size_t start = thread_slot_hash(EBR_PADDED_SLOTS);
-        uint64_t my_epoch = epoch_.load(std::memory_order_seq_cst);
-        
-        size_t slot = start;
         while (true) {
-            uint64_t expected = 0;
-            if (const_cast<PaddedReaderSlot&>(reader_epochs_[slot])
-                    .epoch.compare_exchange_strong(expected, my_epoch,
-                        std::memory_order_seq_cst, std::memory_order_relaxed)) {
-                return slot;
-            }
-            slot = (slot + 1) % EBR_PADDED_SLOTS;
+            rec->committing.store(true, std::memory_order_seq_cst);
+            if (!exclusive_.load(std::memory_order_seq_cst)) [[likely]] return;
+            rec->committing.store(false, std::memory_order_seq_cst);
+            std::lock_guard<mutex_t> wait(mutex_);  // Until the exclusive section ends
         }
+    } else {
+        (void)rec;
+    }
+}
+
+TKTRIE_TEMPLATE
+void TKTRIE_CLASS::commit_exit(ebr_reader_record* rec) const noexcept {
+    if constexpr (THREADED) {
+        rec->committing.store(false, std::memory_order_release);
+    } else {
+        (void)rec;
+    }
+}
+
+TKTRIE_TEMPLATE
+void TKTRIE_CLASS::lock_exclusive() const {
+    mutex_.lock();
+    if constexpr (THREADED) {
+        exclusive_.store(true, std::memory_order_seq_cst);
+        while (readers_->any_committing()) std::this_thread::yield();
     }
-    return 0;
 }
 
 TKTRIE_TEMPLATE
-void TKTRIE_CLASS::reader_exit(size_t slot) const noexcept {
+bool TKTRIE_CLASS::try_lock_exclusive() const {
+    if (!mutex_.try_lock()) return false;
     if constexpr (THREADED) {
-        const_cast<PaddedReaderSlot&>(reader_epochs_[slot])
-            .epoch.store(0, std::memory_order_seq_cst);
+        exclusive_.store(true, std::memory_order_seq_cst);
+        while (readers_->any_committing()) std::this_thread::yield();
     }
+    return true;
+}
+
+TKTRIE_TEMPLATE
+void TKTRIE_CLASS::unlock_exclusive() const noexcept {
+    if constexpr (THREADED) exclusive_.store(false, std::memory_order_seq_cst);
+    mutex_.unlock();
 }
 
 TKTRIE_TEMPLATE
 uint64_t TKTRIE_CLASS::min_reader_epoch() const noexcept {
     if constexpr (THREADED) {
-        uint64_t current = epoch_.load(std::memory_order_seq_cst);
-        uint64_t min_e = current;
-        for (size_t i = 0; i < EBR_PADDED_SLOTS; ++i) {
-            uint64_t e = reader_epochs_[i].epoch.load(std::memory_order_seq_cst);
-            if (e != 0 && e < min_e) {
-                min_e = e;
-            }
-        }
-        return min_e;
+        return readers_->min_epoch(epoch_.load(std::memory_order_seq_cst));
     }
     return 0;
 }
@@ -90,46 +184,82 @@ void TKTRIE_CLASS::ebr_cleanup() {
     if constexpr (THREADED) {
         std::lock_guard<std::mutex> lock(ebr_mutex_);
         
-        retire_entry_t* list = retired_head_.exchange(nullptr, std::memory_order_acquire);
-        retired_count_.store(0, std::memory_order_relaxed);
-        if (!list) return;
+        ptr_t head = retired_head_.load(std::memory_order_acquire);
+        value_box_t* vhead = retired_values_.load(std::memory_order_acquire);
+        if (!head && !vhead) return;
         
         uint64_t min_epoch = min_reader_epoch();
-        
-        retire_entry_t* still_head = nullptr;
-        size_t still_count = 0;
-        
-        while (list) {
-            retire_entry_t* curr = list;
-            list = list->next;
-            
-            if (curr->epoch + 8 <= min_epoch) {
-                node_deleter(curr->node);
-                delete curr;
+        size_t freed = 0;
+        
+        // Newest first, so everything reclaimable is a tail of the list.
+        // The head is unlinked only by CAS: writers may be pushing in front of it.
+        if (head) {
+            ptr_t prev = head;
+            ptr_t curr = builder_t::retire_next(head);
+            if (head->retired_epoch() + EBR_GRACE_EPOCHS <= min_epoch &&
+                retired_head_.compare_exchange_strong(head, nullptr, std::memory_order_acquire)) {
+                curr = head;
             } else {
-                curr->next = still_head;
-                still_head = curr;
-                ++still_count;
+                while (curr && curr->retired_epoch() + EBR_GRACE_EPOCHS > min_epoch) {
+                    prev = curr;
+                    curr = builder_t::retire_next(curr);
+                }
+                if (curr) builder_t::retire_next(prev) = nullptr;
+            }
+            while (curr) {
+                ptr_t next = builder_t::retire_next(curr);
+                node_deleter(curr);
+                curr = next;
+                ++freed;
             }
         }
-        
-        if (still_head) {
-            retire_entry_t* still_tail = still_head;
-            while (still_tail->next) still_tail = still_tail->next;
-            
-            retire_entry_t* old_head = retired_head_.load(std::memory_order_relaxed);
-            do {
-                still_tail->next = old_head;
-            } while (!retired_head_.compare_exchange_weak(old_head, still_head,
-                        std::memory_order_release, std::memory_order_relaxed));
-            retired_count_.fetch_add(still_count, std::memory_order_relaxed);
+        if (vhead) {
+            value_box_t* prev = vhead;
+            value_box_t* curr = vhead->retire_next;
+            if (vhead->retire_epoch + EBR_GRACE_EPOCHS <= min_epoch &&
+                retired_values_.compare_exchange_strong(vhead, nullptr, std::memory_order_acquire)) {
+                curr = vhead;
+            } else {
+                while (curr && curr->retire_epoch + EBR_GRACE_EPOCHS > min_epoch) {
+                    prev = curr;
+                    curr = curr->retire_next;
+                }
+                if (curr) prev->retire_next = nullptr;
+            }
+            while (curr) {
+                value_box_t* next = curr->retire_next;
+                data_t::destroy_box(curr);
+                curr = next;
+                ++freed;
+            }
         }
+        if (freed) retired_count_.fetch_sub(freed, std::memory_order_relaxed);
     }
 }
 
+// Called on the hot paths once THRESHOLD nodes are waiting. The policy is
+// read after reclaimer_ is published (release/acquire on reclaim_policy_), so
+// BACKGROUND always finds a live reclaimer to wake.
 TKTRIE_TEMPLATE
-template <bool NEED_VALUE>
-inline bool TKTRIE_CLASS::read_impl(ptr_t n, std::string_view key, T& out) const noexcept
+void TKTRIE_CLASS::maybe_reclaim(size_t threshold) {
+    if constexpr (THREADED) {
+        if (retired_count_.load(std::memory_order_relaxed) < threshold) return;
+        switch (reclaim_policy_.load(std::memory_order_acquire)) {
+            case reclaim_policy::INLINE:
+                ebr_cleanup();
+                break;
+            case reclaim_policy::BACKGROUND:
+                reclaimer_->kick();
+                break;
+            case reclaim_policy::MANUAL:
+                break;
+        }
+    }
+}
+
+TKTRIE_TEMPLATE
+template <bool NEED_VALUE, typename Out>
+inline bool TKTRIE_CLASS::read_impl(ptr_t n, std::string_view key, Out& out) const noexcept
     requires NEED_VALUE {
     if (!n) return false;
     
@@ -222,8 +352,8 @@ inline bool TKTRIE_CLASS::read_impl(ptr_t n, std::string_view key) const noexcep
 }
 
 TKTRIE_TEMPLATE
-template <bool NEED_VALUE>
-inline bool TKTRIE_CLASS::read_impl_optimistic(ptr_t n, std::string_view key, T& out, read_path& path) const noexcept
+template <bool NEED_VALUE, typename Out>
+inline bool TKTRIE_CLASS::read_impl_optimistic(ptr_t n, std::string_view key, Out& out, read_path& path) const noexcept
     requires NEED_VALUE {
     if (!n) return false;
     
@@ -231,13 +361,16 @@ inline bool TKTRIE_CLASS::read_impl_optimistic(ptr_t n, std::string_view key, T&
     while (true) {
         h = n->header();
         
-        if (h & FLAG_POISON) return false;
-        
-        if (path.len >= read_path::MAX_DEPTH) return false;
+        if (path.len >= read_path::MAX_DEPTH) [[unlikely]] {
+            path.overflow = true;
+            return false;
+        }
         path.nodes[path.len] = n;
-        path.versions[path.len] = h & VERSION_MASK;
+        path.versions[path.len] = h & (VERSION_MASK | FLAG_POISON);
         ++path.len;
         
+        if (h & FLAG_POISON) return false;
+        
         if (h & FLAG_SKIP_USED) {
             if (!consume_prefix(key, n->skip_str())) return false;
         }
@@ -282,13 +415,16 @@ inline bool TKTRIE_CLASS::read_impl_optimistic(ptr_t n, std::string_view key, re
     while (true) {
         h = n->header();
         
-        if (h & FLAG_POISON) return false;
-        
-        if (path.len >= read_path::MAX_DEPTH) return false;
+        if (path.len >= read_path::MAX_DEPTH) [[unlikely]] {
+            path.overflow = true;
+            return false;
+        }
         path.nodes[path.len] = n;
-        path.versions[path.len] = h & VERSION_MASK;
+        path.versions[path.len] = h & (VERSION_MASK | FLAG_POISON);
         ++path.len;
         
+        if (h & FLAG_POISON) return false;
+        
         if (h & FLAG_SKIP_USED) {
             if (!consume_prefix(key, n->skip_str())) return false;
         }
@@ -324,16 +460,41 @@ inline bool TKTRIE_CLASS::read_impl_optimistic(ptr_t n, std::string_view key, re
 TKTRIE_TEMPLATE
 inline bool TKTRIE_CLASS::validate_read_path(const read_path& path) const noexcept {
     [[assume(path.len >= 0 && path.len <= 64)]];
+    if (path.overflow) return false;
+    // Keep the node reads above from sinking below the version re-checks
+    if constexpr (THREADED) std::atomic_thread_fence(std::memory_order_acquire);
+    // POISON is compared too: a retired node's version bits hold its retire epoch
     for (int i = 0; i < path.len; ++i) {
-        if (get_version(path.nodes[i]->header()) != path.versions[i]) {
-            return false;
-        }
+        uint64_t v = path.versions[i];
+        if (v & (FLAG_POISON | VERSION_WRITING)) return false;  // Seen retired or mid-write
+        if ((path.nodes[i]->header() & (VERSION_MASK | FLAG_POISON)) != v) return false;
     }
     return true;
 }
 
+// A probe that commits nothing (EXISTS, NOT_FOUND) is only an answer if the
+// nodes it walked were stable; a full path may have been truncated.
+// A commit checks the same once it holds its locks: the last HELD entries are
+// locked (which checked their versions), and an ancestor edited in place
+// since the probe may have handed it a child for another key.
 TKTRIE_TEMPLATE
-TKTRIE_CLASS::tktrie() : root_(nullptr) {
+inline bool TKTRIE_CLASS::validate_probe_path(const path_entry* path, int len, int max_len, int held) const noexcept {
+    if (len >= max_len) return false;
+    if constexpr (THREADED) std::atomic_thread_fence(std::memory_order_acquire);
+    for (int i = 0; i < len - held; ++i) {
+        uint64_t v = path[i].version;
+        if (v & VERSION_WRITING) return false;
+        if ((path[i].node->header() & (VERSION_MASK | FLAG_POISON)) != v) return false;
+    }
+    return true;
+}
+
+TKTRIE_TEMPLATE
+TKTRIE_CLASS::tktrie() : tktrie(Allocator()) {}
+
+TKTRIE_TEMPLATE
+TKTRIE_CLASS::tktrie(const Allocator& alloc) : root_(nullptr), builder_(alloc) {
+    if constexpr (THREADED) readers_ = std::make_shared<ebr_registry>();
     if constexpr (FIXED_LEN > 0) {
         root_.store(builder_.make_interior_list(""));
     }
@@ -341,6 +502,7 @@ TKTRIE_CLASS::tktrie() : root_(nullptr) {
 
 TKTRIE_TEMPLATE
 TKTRIE_CLASS::~tktrie() {
+    reclaimer_.reset();  // Joins: its pass must not race the teardown below
     ptr_t r = root_.load();
     root_.store(nullptr);
     if (r && !builder_t::is_sentinel(r)) {
@@ -348,19 +510,30 @@ TKTRIE_CLASS::~tktrie() {
     }
     if constexpr (THREADED) {
         std::lock_guard<std::mutex> lock(ebr_mutex_);
-        retire_entry_t* list = retired_head_.exchange(nullptr, std::memory_order_acquire);
+        ptr_t list = retired_head_.exchange(nullptr, std::memory_order_acquire);
         retired_count_.store(0, std::memory_order_relaxed);
         while (list) {
-            retire_entry_t* curr = list;
-            list = list->next;
-            node_deleter(curr->node);
-            delete curr;
+            ptr_t next = builder_t::retire_next(list);
+            node_deleter(list);
+            list = next;
+        }
+        value_box_t* values = retired_values_.exchange(nullptr, std::memory_order_acquire);
+        while (values) {
+            value_box_t* next = values->retire_next;
+            data_t::destroy_box(values);
+            values = next;
         }
     }
 }
 
 TKTRIE_TEMPLATE
-TKTRIE_CLASS::tktrie(const tktrie& other) : root_(nullptr) {
+TKTRIE_CLASS::tktrie(const tktrie& other)
+    : root_(nullptr),
+      builder_(std::allocator_traits<Allocator>::select_on_container_copy_construction(
+          other.builder_.get_allocator())) {
+    // Clones share a move-only value's box, which two tries must not
+    static_assert(std::is_copy_constructible_v<T>, "copying a tktrie copies its values");
+    if constexpr (THREADED) readers_ = std::make_shared<ebr_registry>();
     ptr_t other_root = other.root_.load();
     if (other_root && !builder_t::is_sentinel(other_root)) {
         root_.store(builder_.deep_copy(other_root));
@@ -370,6 +543,7 @@ TKTRIE_CLASS::tktrie(const tktrie& other) : root_(nullptr) {
 
 TKTRIE_TEMPLATE
 TKTRIE_CLASS& TKTRIE_CLASS::operator=(const tktrie& other) {
+    static_assert(std::is_copy_constructible_v<T>, "copying a tktrie copies its values");
     if (this != &other) {
         clear();
         ptr_t other_root = other.root_.load();
@@ -382,19 +556,31 @@ TKTRIE_CLASS& TKTRIE_CLASS::operator=(const tktrie& other) {
 }
 
 TKTRIE_TEMPLATE
-TKTRIE_CLASS::tktrie(tktrie&& other) noexcept : root_(nullptr) {
+TKTRIE_CLASS::tktrie(tktrie&& other) noexcept
+    : root_(nullptr), builder_(other.builder_.get_allocator()) {
+    if constexpr (THREADED) readers_ = std::make_shared<ebr_registry>();
+    // Nodes live in other's slabs: drain its retired list, then take the slabs
+    other.reclaim_retired();
+    builder_.swap(other.builder_);
     root_.store(other.root_.load());
     other.root_.store(nullptr);
     size_.store(other.size_.exchange(0));
+    other.invalidate_cursors();
 }
 
 TKTRIE_TEMPLATE
 TKTRIE_CLASS& TKTRIE_CLASS::operator=(tktrie&& other) noexcept {
     if (this != &other) {
         clear();
+        ptr_t r = root_.load();
+        root_.store(nullptr);
+        if (r) builder_.dealloc_node(r);
+        other.reclaim_retired();
+        builder_.swap(other.builder_);
         root_.store(other.root_.load());
         other.root_.store(nullptr);
         size_.store(other.size_.exchange(0));
+        other.invalidate_cursors();
     }
     return *this;
 }
@@ -402,62 +588,64 @@ TKTRIE_CLASS& TKTRIE_CLASS::operator=(tktrie&& other) noexcept {
 TKTRIE_TEMPLATE
 void TKTRIE_CLASS::clear() {
     ptr_t r = root_.load();
-    
-    if constexpr (FIXED_LEN > 0) {
-        root_.store(builder_.make_interior_list(""));
-    } else {
-        root_.store(nullptr);
-    }
-    
+    root_.store(nullptr);
     if (r && !builder_t::is_sentinel(r)) {
         builder_.dealloc_node(r);
     }
     size_.store(0);
+    invalidate_cursors();
     if constexpr (THREADED) {
         std::lock_guard<std::mutex> lock(ebr_mutex_);
-        retire_entry_t* list = retired_head_.exchange(nullptr, std::memory_order_acquire);
+        ptr_t list = retired_head_.exchange(nullptr, std::memory_order_acquire);
         retired_count_.store(0, std::memory_order_relaxed);
         while (list) {
-            retire_entry_t* curr = list;
-            list = list->next;
-            node_deleter(curr->node);
-            delete curr;
+            ptr_t next = builder_t::retire_next(list);
+            node_deleter(list);
+            list = next;
+        }
+        value_box_t* values = retired_values_.exchange(nullptr, std::memory_order_acquire);
+        while (values) {
+            value_box_t* next = values->retire_next;
+            data_t::destroy_box(values);
+            values = next;
         }
     }
+    // No node is left: hand the slabs back rather than keep them for reuse
+    builder_.release();
+    if constexpr (FIXED_LEN > 0) {
+        root_.store(builder_.make_interior_list(""));
+    }
 }
 
 TKTRIE_TEMPLATE
 inline bool TKTRIE_CLASS::contains(const Key& key) const {
     auto kb = traits::to_bytes(key);
-    std::string_view kbv(kb.data(), kb.size());
+    return contains_bytes(std::string_view(kb.data(), kb.size()));
+}
+
+TKTRIE_TEMPLATE
+inline bool TKTRIE_CLASS::contains_bytes(std::string_view kbv) const {
     if constexpr (THREADED) {
-        if (retired_count_.load(std::memory_order_relaxed) >= EBR_MIN_RETIRED * 2) {
-            const_cast<tktrie*>(this)->ebr_cleanup();
-        }
+        const_cast<tktrie*>(this)->maybe_reclaim(EBR_MIN_RETIRED * 2);
         
-        size_t slot = reader_enter();
+        auto* rec = reader_enter();
         
-        for (int attempts = 0; attempts < 10; ++attempts) {
-            uint64_t epoch_before = epoch_.load(std::memory_order_acquire);
-            
-            ptr_t root = root_.load();
-            if (!root) {
-                reader_exit(slot);
-                return false;
-            }
-            
-            if (root->is_poisoned()) continue;
-            
-            bool found = read_impl<false>(root, kbv);
-            
-            uint64_t epoch_after = epoch_.load(std::memory_order_acquire);
-            if (epoch_before == epoch_after) {
-                reader_exit(slot);
+        // Only writes to the nodes on this key's path force a retry
+        read_path path;
+        for (int attempts = 0; attempts < OPTIMISTIC_READ_ATTEMPTS; ++attempts) {
+            path.clear();
+            bool found = read_impl_optimistic<false>(root_.load(), kbv, path);
+            if (validate_read_path(path)) {
+                reader_exit(rec);
                 return found;
             }
         }
-        bool result = read_impl<false>(root_.load(), kbv);
-        reader_exit(slot);
+        bool result;
+        {
+            exclusive_lock lock(*this);
+            result = read_impl<false>(root_.load(), kbv);
+        }
+        reader_exit(rec);
         return result;
     } else {
         return read_impl<false>(root_.load(), kbv);
@@ -467,16 +655,56 @@ inline bool TKTRIE_CLASS::contains(const Key& key) const {
 TKTRIE_TEMPLATE
 std::pair<typename TKTRIE_CLASS::iterator, bool> TKTRIE_CLASS::insert(const std::pair<const Key, T>& kv) {
     auto kb = traits::to_bytes(kv.first);
+    return insert_bytes(kv.first, std::string_view(kb.data(), kb.size()), kv.second);
+}
+
+TKTRIE_TEMPLATE
+std::pair<typename TKTRIE_CLASS::iterator, bool> TKTRIE_CLASS::insert(std::pair<const Key, T>&& kv) {
+    auto kb = traits::to_bytes(kv.first);
+    return emplace_bytes(kv.first, std::string_view(kb.data(), kb.size()), std::move(kv.second));
+}
+
+TKTRIE_TEMPLATE
+template <typename... Args>
+std::pair<typename TKTRIE_CLASS::iterator, bool> TKTRIE_CLASS::emplace(Args&&... args) {
+    std::pair<const Key, T> kv(std::forward<Args>(args)...);
+    return insert(std::move(kv));
+}
+
+TKTRIE_TEMPLATE
+template <typename... Args>
+std::pair<typename TKTRIE_CLASS::iterator, bool> TKTRIE_CLASS::try_emplace(const Key& key, Args&&... args) {
+    auto kb = traits::to_bytes(key);
     std::string_view kbv(kb.data(), kb.size());
+    held_t existing;
+    if (find_read(kbv, existing)) return {iterator(this, kbv, std::move(existing)), false};
+    return emplace_bytes(key, kbv, std::forward<Args>(args)...);
+}
+
+// Inline values are built on the stack: copying them into the node is free
+TKTRIE_TEMPLATE
+template <typename... Args>
+std::pair<typename TKTRIE_CLASS::iterator, bool> TKTRIE_CLASS::emplace_bytes(
+    const Key& key, std::string_view kb, Args&&... args) {
+    if constexpr (data_t::INLINE) {
+        const T value(std::forward<Args>(args)...);
+        return insert_bytes(key, kb, value);
+    } else {
+        source_t value(data_t::make_box(std::forward<Args>(args)...));
+        return insert_bytes(key, kb, value);
+    }
+}
+
+TKTRIE_TEMPLATE
+std::pair<typename TKTRIE_CLASS::iterator, bool> TKTRIE_CLASS::insert_bytes(
+    const Key& key, std::string_view kb, const source_t& value) {
     bool retired_any = false;
-    auto result = insert_locked(kv.first, kbv, kv.second, &retired_any);
+    auto result = insert_locked(key, kb, value, &retired_any);
     if constexpr (THREADED) {
         if (retired_any) {
             epoch_.fetch_add(1, std::memory_order_acq_rel);
         }
-        if (retired_count_.load(std::memory_order_relaxed) >= EBR_MIN_RETIRED) {
-            ebr_cleanup();
-        }
+        maybe_reclaim(EBR_MIN_RETIRED);
     }
     return result;
 }
@@ -484,15 +712,17 @@ std::pair<typename TKTRIE_CLASS::iterator, bool> TKTRIE_CLASS::insert(const std:
 TKTRIE_TEMPLATE
 bool TKTRIE_CLASS::erase(const Key& key) {
     auto kb = traits::to_bytes(key);
-    std::string_view kbv(kb.data(), kb.size());
+    return erase_bytes(std::string_view(kb.data(), kb.size()));
+}
+
+TKTRIE_TEMPLATE
+bool TKTRIE_CLASS::erase_bytes(std::string_view kbv) {
     auto [erased, retired_any] = erase_locked(kbv);
     if constexpr (THREADED) {
         if (retired_any) {
             epoch_.fetch_add(1, std::memory_order_acq_rel);
         }
-        if (retired_count_.load(std::memory_order_relaxed) >= EBR_MIN_RETIRED) {
-            ebr_cleanup();
-        }
+        maybe_reclaim(EBR_MIN_RETIRED);
     }
     return erased;
 }
@@ -500,1013 +730,244 @@ bool TKTRIE_CLASS::erase(const Key& key) {
 TKTRIE_TEMPLATE
 typename TKTRIE_CLASS::iterator TKTRIE_CLASS::find(const Key& key) {
     auto kb = traits::to_bytes(key);
-    std::string_view kbv(kb.data(), kb.size());
-    T value;
-    if constexpr (THREADED) {
-        if (retired_count_.load(std::memory_order_relaxed) >= EBR_MIN_RETIRED * 2) {
-            ebr_cleanup();
-        }
-        
-        size_t slot = reader_enter();
-        
-        for (int attempts = 0; attempts < 10; ++attempts) {
-            uint64_t epoch_before = epoch_.load(std::memory_order_acquire);
-            
-            ptr_t root = root_.load();
-            if (!root) {
-                reader_exit(slot);
-                return end();
-            }
-            if (root->is_poisoned()) continue;
-            
-            bool found = read_impl<true>(root, kbv, value);
-            
-            uint64_t epoch_after = epoch_.load(std::memory_order_acquire);
-            if (epoch_before == epoch_after) {
-                reader_exit(slot);
-                if (found) return iterator(this, kbv, value);
-                return end();
-            }
-        }
-        bool found = read_impl<true>(root_.load(), kbv, value);
-        reader_exit(slot);
-        if (found) return iterator(this, kbv, value);
-    } else {
-        if (read_impl<true>(root_.load(), kbv, value)) {
-            return iterator(this, kbv, value);
-        }
-    }
-    return end();
+    return find_bytes<iterator>(this, std::string_view(kb.data(), kb.size()));
 }
 
 TKTRIE_TEMPLATE
 typename TKTRIE_CLASS::const_iterator TKTRIE_CLASS::find(const Key& key) const {
     auto kb = traits::to_bytes(key);
-    std::string_view kbv(kb.data(), kb.size());
-    T value;
-    if constexpr (THREADED) {
-        if (retired_count_.load(std::memory_order_relaxed) >= EBR_MIN_RETIRED * 2) {
-            const_cast<tktrie*>(this)->ebr_cleanup();
-        }
-        
-        size_t slot = reader_enter();
-        
-        for (int attempts = 0; attempts < 10; ++attempts) {
-            uint64_t epoch_before = epoch_.load(std::memory_order_acquire);
-            
-            ptr_t root = root_.load();
-            if (!root) {
-                reader_exit(slot);
-                return end();
-            }
-            if (root->is_poisoned()) continue;
-            
-            bool found = read_impl<true>(root, kbv, value);
-            
-            uint64_t epoch_after = epoch_.load(std::memory_order_acquire);
-            if (epoch_before == epoch_after) {
-                reader_exit(slot);
-                if (found) return const_iterator(this, kbv, value);
-                return end();
-            }
-        }
-        bool found = read_impl<true>(root_.load(), kbv, value);
-        reader_exit(slot);
-        if (found) return const_iterator(this, kbv, value);
-    } else {
-        if (read_impl<true>(root_.load(), kbv, value)) {
-            return const_iterator(this, kbv, value);
-        }
-    }
-    return end();
+    return find_bytes<const_iterator>(this, std::string_view(kb.data(), kb.size()));
 }
 
 TKTRIE_TEMPLATE
-void TKTRIE_CLASS::reclaim_retired() noexcept {
-    if constexpr (THREADED) {
-        std::lock_guard<std::mutex> lock(ebr_mutex_);
-        retire_entry_t* list = retired_head_.exchange(nullptr, std::memory_order_acquire);
-        retired_count_.store(0, std::memory_order_relaxed);
-        while (list) {
-            retire_entry_t* curr = list;
-            list = list->next;
-            node_deleter(curr->node);
-            delete curr;
-        }
-    }
+template <typename It, typename Self>
+It TKTRIE_CLASS::find_bytes(Self* self, std::string_view kbv) {
+    held_t value;
+    if (self->find_read(kbv, value)) return It(self, kbv, value);
+    return self->end();
 }
 
-// -----------------------------------------------------------------------------
-// Iterator helpers: find first/last/greater/less
-// -----------------------------------------------------------------------------
-
+// Copies out the value stored at kbv, if any
 TKTRIE_TEMPLATE
-bool TKTRIE_CLASS::find_first_bytes(std::string& out_key, T& out_value) const {
-    ptr_t n = root_.load();
-    if (!n || n->is_poisoned() || builder_t::is_sentinel(n)) return false;
-    
-    out_key.clear();
-    
-    while (n && !n->is_poisoned()) {
-        out_key.append(n->skip_str());
+bool TKTRIE_CLASS::find_read(std::string_view kbv, held_t& value) const {
+    if constexpr (THREADED) {
+        const_cast<tktrie*>(this)->maybe_reclaim(EBR_MIN_RETIRED * 2);
         
-        if (n->is_leaf()) {
-            if (n->is_skip()) {
-                n->as_skip()->value.try_read(out_value);
-                return true;
-            }
-            // Multi-entry leaf: get first (smallest) entry
-            if (n->is_binary()) {
-                auto* bn = n->template as_binary<true>();
-                if (bn->count() > 0) {
-                    out_key.push_back(static_cast<char>(bn->char_at(0)));
-                    bn->read_value(0, out_value);
-                    return true;
-                }
-            } else if (n->is_list()) {
-                auto* ln = n->template as_list<true>();
-                if (ln->count() > 0) {
-                    out_key.push_back(static_cast<char>(ln->char_at(0)));
-                    ln->read_value(0, out_value);
-                    return true;
-                }
-            } else if (n->is_pop()) {
-                auto* pn = n->template as_pop<true>();
-                if (pn->count() > 0) {
-                    unsigned char c = pn->valid().first();
-                    out_key.push_back(static_cast<char>(c));
-                    pn->element_at_slot(0).try_read(out_value);
-                    return true;
-                }
-            } else {
-                auto* fn = n->template as_full<true>();
-                if (fn->count() > 0) {
-                    unsigned char c = fn->valid().first();
-                    out_key.push_back(static_cast<char>(c));
-                    fn->read_value(c, out_value);
-                    return true;
-                }
-            }
-            return false;
-        }
+        auto* rec = reader_enter();
         
-        // Interior: check EOS first (smallest), then descend to first child
-        if constexpr (FIXED_LEN == 0) {
-            if (n->has_eos()) {
-                n->try_read_eos(out_value);
-                return true;
+        // Only writes to the nodes on this key's path force a retry
+        read_path path;
+        for (int attempts = 0; attempts < OPTIMISTIC_READ_ATTEMPTS; ++attempts) {
+            path.clear();
+            bool found = read_impl_optimistic<true>(root_.load(), kbv, value, path);
+            if (validate_read_path(path)) {
+                reader_exit(rec);
+                return found;
             }
         }
-        
-        // Get first child
-        ptr_t child = nullptr;
-        unsigned char first_c = 0;
-        if (n->is_binary()) {
-            auto* bn = n->template as_binary<false>();
-            if (bn->count() > 0) { first_c = bn->char_at(0); child = bn->child_at_slot(0); }
-        } else if (n->is_list()) {
-            auto* ln = n->template as_list<false>();
-            if (ln->count() > 0) { first_c = ln->char_at(0); child = ln->child_at_slot(0); }
-        } else if (n->is_pop()) {
-            auto* pn = n->template as_pop<false>();
-            if (pn->count() > 0) { first_c = pn->valid().first(); child = pn->get_child(first_c); }
-        } else {
-            auto* fn = n->template as_full<false>();
-            if (fn->count() > 0) { first_c = fn->valid().first(); child = fn->get_child(first_c); }
+        bool found;
+        {
+            exclusive_lock lock(*this);
+            found = read_impl<true>(root_.load(), kbv, value);
         }
-        
-        if (!child) return false;
-        out_key.push_back(static_cast<char>(first_c));
-        n = child;
+        reader_exit(rec);
+        return found;
+    } else {
+        return read_impl<true>(root_.load(), kbv, value);
     }
-    return false;
 }
 
+// Same read as find(), but the guard keeps the reader epoch and a pointer
+// into the value's box instead of copying it out
 TKTRIE_TEMPLATE
-bool TKTRIE_CLASS::find_last_bytes(std::string& out_key, T& out_value) const {
-    ptr_t n = root_.load();
-    if (!n || n->is_poisoned() || builder_t::is_sentinel(n)) return false;
-    
-    out_key.clear();
-    
-    while (n && !n->is_poisoned()) {
-        out_key.append(n->skip_str());
+typename TKTRIE_CLASS::read_guard TKTRIE_CLASS::find_ref(const Key& key) const {
+    auto kb = traits::to_bytes(key);
+    return find_ref_bytes(std::string_view(kb.data(), kb.size()));
+}
+
+TKTRIE_TEMPLATE
+typename TKTRIE_CLASS::read_guard TKTRIE_CLASS::find_ref_bytes(std::string_view kbv) const {
+    read_guard g;
+    g.trie_ = this;
+    if constexpr (THREADED) {
+        const_cast<tktrie*>(this)->maybe_reclaim(EBR_MIN_RETIRED * 2);
         
-        if (n->is_leaf()) {
-            if (n->is_skip()) {
-                n->as_skip()->value.try_read(out_value);
-                return true;
-            }
-            // Multi-entry leaf: get last (largest) entry
-            if (n->is_binary()) {
-                auto* bn = n->template as_binary<true>();
-                int cnt = bn->count();
-                if (cnt > 0) {
-                    out_key.push_back(static_cast<char>(bn->char_at(cnt - 1)));
-                    bn->read_value(cnt - 1, out_value);
-                    return true;
-                }
-            } else if (n->is_list()) {
-                auto* ln = n->template as_list<true>();
-                int cnt = ln->count();
-                if (cnt > 0) {
-                    out_key.push_back(static_cast<char>(ln->char_at(cnt - 1)));
-                    ln->read_value(cnt - 1, out_value);
-                    return true;
-                }
-            } else if (n->is_pop()) {
-                auto* pn = n->template as_pop<true>();
-                int cnt = pn->count();
-                if (cnt > 0) {
-                    // Find last set bit
-                    unsigned char last_c = 255;
-                    while (last_c > 0 && !pn->valid().test(last_c)) --last_c;
-                    out_key.push_back(static_cast<char>(last_c));
-                    pn->element_at_slot(cnt - 1).try_read(out_value);
-                    return true;
-                }
-            } else {
-                auto* fn = n->template as_full<true>();
-                if (fn->count() > 0) {
-                    unsigned char last_c = 255;
-                    while (last_c > 0 && !fn->valid().test(last_c)) --last_c;
-                    out_key.push_back(static_cast<char>(last_c));
-                    fn->read_value(last_c, out_value);
-                    return true;
-                }
-            }
-            return false;
-        }
+        g.rec_ = reader_enter();
         
-        // Interior: descend to last child, then check EOS last (EOS is smallest for a node)
-        ptr_t child = nullptr;
-        unsigned char last_c = 0;
-        if (n->is_binary()) {
-            auto* bn = n->template as_binary<false>();
-            int cnt = bn->count();
-            if (cnt > 0) { last_c = bn->char_at(cnt - 1); child = bn->child_at_slot(cnt - 1); }
-        } else if (n->is_list()) {
-            auto* ln = n->template as_list<false>();
-            int cnt = ln->count();
-            if (cnt > 0) { last_c = ln->char_at(cnt - 1); child = ln->child_at_slot(cnt - 1); }
-        } else if (n->is_pop()) {
-            auto* pn = n->template as_pop<false>();
-            int cnt = pn->count();
-            if (cnt > 0) {
-                unsigned char c = 255;
-                while (c > 0 && !pn->valid().test(c)) --c;
-                last_c = c;
-                child = pn->get_child(last_c);
-            }
-        } else {
-            auto* fn = n->template as_full<false>();
-            if (fn->count() > 0) {
-                unsigned char c = 255;
-                while (c > 0 && !fn->valid().test(c)) --c;
-                last_c = c;
-                child = fn->get_child(last_c);
+        read_path path;
+        bool validated = false;
+        for (int attempts = 0; attempts < OPTIMISTIC_READ_ATTEMPTS; ++attempts) {
+            path.clear();
+            g.found_ = read_impl_optimistic<true>(root_.load(), kbv, g.pin_, path);
+            if (validate_read_path(path)) {
+                validated = true;
+                break;
             }
         }
-        
-        if (child) {
-            out_key.push_back(static_cast<char>(last_c));
-            n = child;
-        } else if constexpr (FIXED_LEN == 0) {
-            // No children, check EOS
-            if (n->has_eos()) {
-                n->try_read_eos(out_value);
-                return true;
-            }
-            return false;
-        } else {
-            return false;
+        if (!validated) {
+            // Unlinked values are retired, not freed, so the pin outlives the lock
+            exclusive_lock lock(*this);
+            g.found_ = read_impl<true>(root_.load(), kbv, g.pin_);
         }
+        if (!g.found_) g.release();
+    } else {
+        g.found_ = read_impl<true>(root_.load(), kbv, g.pin_);
     }
-    return false;
+    return g;
 }
 
+// read_impl's descent, keeping the last value passed: an interior EOS or the
+// leaf entry the key runs into. Returns that key's length, or npos; path,
+// if given, is recorded as by read_impl_optimistic.
 TKTRIE_TEMPLATE
-bool TKTRIE_CLASS::find_greater_bytes(const std::string& key, std::string& out_key, T& out_value) const {
-    // Find smallest key strictly greater than 'key'
-    // Strategy: traverse to key's position, then advance
-    ptr_t n = root_.load();
-    if (!n || n->is_poisoned() || builder_t::is_sentinel(n)) return false;
-    
-    struct frame { ptr_t node; size_t key_pos; int child_idx; };
-    std::vector<frame> stack;
-    
-    std::string_view kv(key);
-    out_key.clear();
-    
-    // Navigate toward key, recording path
-    while (n && !n->is_poisoned()) {
-        std::string_view skip = n->skip_str();
-        size_t m = match_skip_impl(skip, kv);
-        
-        if (m < skip.size() && m < kv.size()) {
-            // Divergence in skip: if key char < skip char, this subtree is all greater
-            if (static_cast<unsigned char>(kv[m]) < static_cast<unsigned char>(skip[m])) {
-                out_key.append(skip);
-                if (n->is_leaf()) {
-                    if (n->is_skip()) {
-                        n->as_skip()->value.try_read(out_value);
-                        return true;
-                    }
-                    // First entry of leaf
-                    if (n->is_binary()) {
-                        auto* bn = n->template as_binary<true>();
-                        out_key.push_back(static_cast<char>(bn->char_at(0)));
-                        bn->read_value(0, out_value);
-                        return true;
-                    }
-                    // ... similar for other types - descend left
-                }
-                // Descend to first value in this subtree
-                goto descend_left;
-            }
-            // key char > skip char: need to backtrack
-            goto backtrack;
-        }
-        
-        if (m < skip.size()) {
-            // Key exhausted but skip continues: key is a prefix, first in subtree is answer
-            out_key.append(skip);
-            goto descend_left;
-        }
-        
-        out_key.append(skip);
-        kv.remove_prefix(m);
-        
-        if (n->is_leaf()) {
-            if (n->is_skip()) {
-                if (kv.empty()) {
-                    // Exact match - need to backtrack to find next
-                    goto backtrack;
-                }
-                // Key is longer - no match, backtrack
-                goto backtrack;
-            }
-            // Multi-entry leaf: find first entry > remaining key
-            if (kv.size() == 1) {
-                unsigned char c = static_cast<unsigned char>(kv[0]);
-                // Find first entry with char > c
-                if (n->is_binary()) {
-                    auto* bn = n->template as_binary<true>();
-                    for (int i = 0; i < bn->count(); ++i) {
-                        if (bn->char_at(i) > c) {
-                            out_key.push_back(static_cast<char>(bn->char_at(i)));
-                            bn->read_value(i, out_value);
-                            return true;
-                        }
-                    }
-                } else if (n->is_list()) {
-                    auto* ln = n->template as_list<true>();
-                    for (int i = 0; i < ln->count(); ++i) {
-                        if (ln->char_at(i) > c) {
-                            out_key.push_back(static_cast<char>(ln->char_at(i)));
-                            ln->read_value(i, out_value);
-                            return true;
-                        }
-                    }
-                } else if (n->is_pop()) {
-                    auto* pn = n->template as_pop<true>();
-                    int slot = 0;
-                    bool found = false;
-                    pn->valid().for_each_set([&](unsigned char ch) {
-                        if (!found && ch > c) {
-                            out_key.push_back(static_cast<char>(ch));
-                            pn->element_at_slot(slot).try_read(out_value);
-                            found = true;
-                        }
-                        ++slot;
-                    });
-                    if (found) return true;
-                } else {
-                    auto* fn = n->template as_full<true>();
-                    for (unsigned next = c + 1; next <= 255; ++next) {
-                        if (fn->valid().test(static_cast<unsigned char>(next))) {
-                            out_key.push_back(static_cast<char>(next));
-                            fn->read_value(static_cast<unsigned char>(next), out_value);
-                            return true;
-                        }
-                    }
-                }
-            }
-            goto backtrack;
-        }
-        
-        // Interior node
-        if (kv.empty()) {
-            // Key matches this interior node's EOS position
-            // Find first child (all children are greater than EOS)
-            goto descend_left_from_interior;
+inline size_t TKTRIE_CLASS::lpm_impl(ptr_t n, std::string_view key, held_t& out, read_path* path) const noexcept {
+    size_t len = key.size();
+    size_t best = std::string_view::npos;
+    while (n) {
+        uint64_t h = n->header();
+        if (path) {
+            if (path->len >= read_path::MAX_DEPTH) [[unlikely]] {
+                path->overflow = true;
+                return best;
+            }
+            path->nodes[path->len] = n;
+            path->versions[path->len] = h & (VERSION_MASK | FLAG_POISON);
+            ++path->len;
         }
-        
-        unsigned char c = static_cast<unsigned char>(kv[0]);
-        kv.remove_prefix(1);
-        
-        // Find child for c, record position for backtracking
-        int child_idx = -1;
-        ptr_t child = nullptr;
-        if (n->is_binary()) {
-            auto* bn = n->template as_binary<false>();
-            child_idx = bn->find(c);
-            if (child_idx >= 0) child = bn->child_at_slot(child_idx);
-        } else if (n->is_list()) {
-            auto* ln = n->template as_list<false>();
-            child_idx = ln->find(c);
-            if (child_idx >= 0) child = ln->child_at_slot(child_idx);
-        } else if (n->is_pop()) {
-            auto* pn = n->template as_pop<false>();
-            if (pn->valid().test(c)) {
-                child_idx = pn->valid().slot_for(c);
-                child = pn->get_child(c);
-            }
-        } else {
-            auto* fn = n->template as_full<false>();
-            if (fn->valid().test(c)) {
-                child_idx = c;  // For full, use char as index
-                child = fn->get_child(c);
-            }
+        if constexpr (THREADED) {
+            if (h & FLAG_POISON) return best;
         }
-        
-        stack.push_back({n, out_key.size(), child_idx});
-        out_key.push_back(static_cast<char>(c));
-        
-        if (child) {
-            n = child;
-            continue;
+
+        if (h & FLAG_SKIP_USED) {
+            if (!consume_prefix(key, n->skip_str())) return best;
         }
-        
-        // No exact child, find first child > c
-        goto find_next_sibling;
-    }
-    
-backtrack:
-    // Pop stack and find next sibling
-    while (!stack.empty()) {
-        frame f = stack.back();
-        stack.pop_back();
-        out_key.resize(f.key_pos);
-        n = f.node;
-        
-        // Find next child after f.child_idx
-        ptr_t next_child = nullptr;
-        unsigned char next_c = 0;
-        
-        if (n->is_binary()) {
-            auto* bn = n->template as_binary<false>();
-            if (f.child_idx + 1 < bn->count()) {
-                next_c = bn->char_at(f.child_idx + 1);
-                next_child = bn->child_at_slot(f.child_idx + 1);
-            }
-        } else if (n->is_list()) {
-            auto* ln = n->template as_list<false>();
-            if (f.child_idx + 1 < ln->count()) {
-                next_c = ln->char_at(f.child_idx + 1);
-                next_child = ln->child_at_slot(f.child_idx + 1);
-            }
-        } else if (n->is_pop()) {
-            auto* pn = n->template as_pop<false>();
-            int slot = 0;
-            bool found_current = false;
-            pn->valid().for_each_set([&](unsigned char ch) {
-                if (found_current && !next_child) {
-                    next_c = ch;
-                    next_child = pn->get_child(ch);
-                }
-                if (slot == f.child_idx) found_current = true;
-                ++slot;
-            });
-        } else {
-            auto* fn = n->template as_full<false>();
-            for (unsigned c = static_cast<unsigned>(f.child_idx) + 1; c <= 255; ++c) {
-                if (fn->valid().test(static_cast<unsigned char>(c))) {
-                    next_c = static_cast<unsigned char>(c);
-                    next_child = fn->get_child(next_c);
-                    break;
-                }
+
+        if (h & FLAG_LEAF) [[unlikely]] {
+            if (h & FLAG_SKIP) {
+                if (n->as_skip()->value.try_read(out)) best = len - key.size();
+            } else if (!key.empty() && n->try_read_leaf_value(static_cast<unsigned char>(key[0]), out)) {
+                best = len - key.size() + 1;
             }
+            return best;
         }
-        
-        if (next_child) {
-            out_key.push_back(static_cast<char>(next_c));
-            n = next_child;
-            goto descend_left;
-        }
+
+        if ((h & FLAG_HAS_EOS) && n->try_read_eos(out)) best = len - key.size();
+        if (key.empty()) return best;
+        unsigned char c = static_cast<unsigned char>(key[0]);
+        key.remove_prefix(1);
+        n = n->get_child(c);
     }
-    return false;
-    
-find_next_sibling:
-    {
-        if (stack.empty()) return false;
-        frame f = stack.back();
-        stack.pop_back();
-        out_key.resize(f.key_pos);
-        n = f.node;
-        
-        unsigned char prev_c = static_cast<unsigned char>(key[f.key_pos]);
-        ptr_t next_child = nullptr;
-        unsigned char next_c = 0;
-        
-        // Find first child > prev_c
-        if (n->is_binary()) {
-            auto* bn = n->template as_binary<false>();
-            for (int i = 0; i < bn->count(); ++i) {
-                if (bn->char_at(i) > prev_c) {
-                    next_c = bn->char_at(i);
-                    next_child = bn->child_at_slot(i);
-                    break;
-                }
-            }
-        } else if (n->is_list()) {
-            auto* ln = n->template as_list<false>();
-            for (int i = 0; i < ln->count(); ++i) {
-                if (ln->char_at(i) > prev_c) {
-                    next_c = ln->char_at(i);
-                    next_child = ln->child_at_slot(i);
-                    break;
-                }
-            }
-        } else if (n->is_pop()) {
-            auto* pn = n->template as_pop<false>();
-            pn->valid().for_each_set([&](unsigned char ch) {
-                if (!next_child && ch > prev_c) {
-                    next_c = ch;
-                    next_child = pn->get_child(ch);
-                }
-            });
-        } else {
-            auto* fn = n->template as_full<false>();
-            for (unsigned c = prev_c + 1; c <= 255; ++c) {
-                if (fn->valid().test(static_cast<unsigned char>(c))) {
-                    next_c = static_cast<unsigned char>(c);
-                    next_child = fn->get_child(next_c);
-                    break;
-                }
+    return best;
+}
+
+// Same retries and fallback as find()
+TKTRIE_TEMPLATE
+size_t TKTRIE_CLASS::lpm_read(std::string_view key, held_t& out) const {
+    if constexpr (THREADED) {
+        const_cast<tktrie*>(this)->maybe_reclaim(EBR_MIN_RETIRED * 2);
+
+        auto* rec = reader_enter();
+        read_path path;
+        for (int attempts = 0; attempts < OPTIMISTIC_READ_ATTEMPTS; ++attempts) {
+            path.clear();
+            size_t len = lpm_impl(root_.load(), key, out, &path);
+            if (validate_read_path(path)) {
+                reader_exit(rec);
+                return len;
             }
         }
-        
-        if (next_child) {
-            out_key.push_back(static_cast<char>(next_c));
-            n = next_child;
-            goto descend_left;
+        size_t len;
+        {
+            exclusive_lock lock(*this);
+            len = lpm_impl(root_.load(), key, out, nullptr);
         }
-        goto backtrack;
+        reader_exit(rec);
+        return len;
+    } else {
+        return lpm_impl(root_.load(), key, out, nullptr);
     }
+}
 
-descend_left_from_interior:
-    {
-        ptr_t child = nullptr;
-        unsigned char first_c = 0;
-        if (n->is_binary()) {
-            auto* bn = n->template as_binary<false>();
-            if (bn->count() > 0) { first_c = bn->char_at(0); child = bn->child_at_slot(0); }
-        } else if (n->is_list()) {
-            auto* ln = n->template as_list<false>();
-            if (ln->count() > 0) { first_c = ln->char_at(0); child = ln->child_at_slot(0); }
-        } else if (n->is_pop()) {
-            auto* pn = n->template as_pop<false>();
-            if (pn->count() > 0) { first_c = pn->valid().first(); child = pn->get_child(first_c); }
-        } else {
-            auto* fn = n->template as_full<false>();
-            if (fn->count() > 0) { first_c = fn->valid().first(); child = fn->get_child(first_c); }
-        }
-        if (child) {
-            out_key.push_back(static_cast<char>(first_c));
-            n = child;
-            goto descend_left;
-        }
-        goto backtrack;
-    }
+TKTRIE_TEMPLATE
+typename TKTRIE_CLASS::iterator TKTRIE_CLASS::longest_prefix_match(std::string_view key)
+    requires (FIXED_LEN == 0) {
+    held_t value;
+    size_t len = lpm_read(key, value);
+    if (len == std::string_view::npos) return end();
+    return iterator(this, key.substr(0, len), value);
+}
 
-descend_left:
-    while (n && !n->is_poisoned()) {
-        out_key.append(n->skip_str());
-        
-        if (n->is_leaf()) {
-            if (n->is_skip()) {
-                n->as_skip()->value.try_read(out_value);
-                return true;
-            }
-            // First entry
-            if (n->is_binary()) {
-                auto* bn = n->template as_binary<true>();
-                out_key.push_back(static_cast<char>(bn->char_at(0)));
-                bn->read_value(0, out_value);
-                return true;
-            } else if (n->is_list()) {
-                auto* ln = n->template as_list<true>();
-                out_key.push_back(static_cast<char>(ln->char_at(0)));
-                ln->read_value(0, out_value);
-                return true;
-            } else if (n->is_pop()) {
-                auto* pn = n->template as_pop<true>();
-                unsigned char c = pn->valid().first();
-                out_key.push_back(static_cast<char>(c));
-                pn->element_at_slot(0).try_read(out_value);
-                return true;
-            } else {
-                auto* fn = n->template as_full<true>();
-                unsigned char c = fn->valid().first();
-                out_key.push_back(static_cast<char>(c));
-                fn->read_value(c, out_value);
-                return true;
-            }
-        }
-        
-        if constexpr (FIXED_LEN == 0) {
-            if (n->has_eos()) {
-                n->try_read_eos(out_value);
-                return true;
-            }
+TKTRIE_TEMPLATE
+typename TKTRIE_CLASS::const_iterator TKTRIE_CLASS::longest_prefix_match(std::string_view key) const
+    requires (FIXED_LEN == 0) {
+    held_t value;
+    size_t len = lpm_read(key, value);
+    if (len == std::string_view::npos) return end();
+    return const_iterator(this, key.substr(0, len), value);
+}
+
+TKTRIE_TEMPLATE
+void TKTRIE_CLASS::reclaim_retired() noexcept {
+    if constexpr (THREADED) {
+        std::lock_guard<std::mutex> lock(ebr_mutex_);
+        invalidate_cursors();
+        ptr_t list = retired_head_.exchange(nullptr, std::memory_order_acquire);
+        retired_count_.store(0, std::memory_order_relaxed);
+        while (list) {
+            ptr_t next = builder_t::retire_next(list);
+            node_deleter(list);
+            list = next;
         }
-        
-        ptr_t child = nullptr;
-        unsigned char first_c = 0;
-        if (n->is_binary()) {
-            auto* bn = n->template as_binary<false>();
-            if (bn->count() > 0) { first_c = bn->char_at(0); child = bn->child_at_slot(0); }
-        } else if (n->is_list()) {
-            auto* ln = n->template as_list<false>();
-            if (ln->count() > 0) { first_c = ln->char_at(0); child = ln->child_at_slot(0); }
-        } else if (n->is_pop()) {
-            auto* pn = n->template as_pop<false>();
-            if (pn->count() > 0) { first_c = pn->valid().first(); child = pn->get_child(first_c); }
-        } else {
-            auto* fn = n->template as_full<false>();
-            if (fn->count() > 0) { first_c = fn->valid().first(); child = fn->get_child(first_c); }
+        value_box_t* values = retired_values_.exchange(nullptr, std::memory_order_acquire);
+        while (values) {
+            value_box_t* next = values->retire_next;
+            data_t::destroy_box(values);
+            values = next;
         }
-        
-        if (!child) return false;
-        out_key.push_back(static_cast<char>(first_c));
-        n = child;
     }
-    return false;
 }
 
 TKTRIE_TEMPLATE
-bool TKTRIE_CLASS::find_less_bytes(const std::string& key, std::string& out_key, T& out_value) const {
-    // Find largest key strictly less than 'key'
-    // This is symmetric to find_greater_bytes but descending right instead of left
-    ptr_t n = root_.load();
-    if (!n || n->is_poisoned() || builder_t::is_sentinel(n)) return false;
-    
-    struct frame { ptr_t node; size_t key_pos; int child_idx; bool has_eos; };
-    std::vector<frame> stack;
-    
-    std::string_view kv(key);
-    out_key.clear();
-    
-    // Navigate toward key, recording path
-    while (n && !n->is_poisoned()) {
-        std::string_view skip = n->skip_str();
-        size_t m = match_skip_impl(skip, kv);
-        
-        if (m < skip.size() && m < kv.size()) {
-            // Divergence: if key char > skip char, need to backtrack
-            if (static_cast<unsigned char>(kv[m]) > static_cast<unsigned char>(skip[m])) {
-                // This subtree is all less - descend to rightmost
-                out_key.append(skip);
-                goto descend_right;
-            }
-            // key char < skip char: backtrack
-            goto backtrack;
-        }
-        
-        if (m < skip.size()) {
-            // Key exhausted but skip continues: all in this subtree are greater
-            goto backtrack;
-        }
-        
-        out_key.append(skip);
-        kv.remove_prefix(m);
-        
-        if (n->is_leaf()) {
-            if (n->is_skip()) {
-                if (kv.empty()) {
-                    // Exact match - need to backtrack to find previous
-                    goto backtrack;
-                }
-                // Key is longer than skip - this value is less
-                n->as_skip()->value.try_read(out_value);
-                return true;
-            }
-            // Multi-entry leaf: find last entry < remaining key
-            if (kv.size() == 1) {
-                unsigned char c = static_cast<unsigned char>(kv[0]);
-                // Find last entry with char < c
-                if (n->is_binary()) {
-                    auto* bn = n->template as_binary<true>();
-                    for (int i = bn->count() - 1; i >= 0; --i) {
-                        if (bn->char_at(i) < c) {
-                            out_key.push_back(static_cast<char>(bn->char_at(i)));
-                            bn->read_value(i, out_value);
-                            return true;
-                        }
-                    }
-                } else if (n->is_list()) {
-                    auto* ln = n->template as_list<true>();
-                    for (int i = ln->count() - 1; i >= 0; --i) {
-                        if (ln->char_at(i) < c) {
-                            out_key.push_back(static_cast<char>(ln->char_at(i)));
-                            ln->read_value(i, out_value);
-                            return true;
-                        }
-                    }
-                } else if (n->is_pop()) {
-                    auto* pn = n->template as_pop<true>();
-                    unsigned char found_c = 0;
-                    int found_slot = -1;
-                    int slot = 0;
-                    pn->valid().for_each_set([&](unsigned char ch) {
-                        if (ch < c) { found_c = ch; found_slot = slot; }
-                        ++slot;
-                    });
-                    if (found_slot >= 0) {
-                        out_key.push_back(static_cast<char>(found_c));
-                        pn->element_at_slot(found_slot).try_read(out_value);
-                        return true;
-                    }
-                } else {
-                    auto* fn = n->template as_full<true>();
-                    for (int prev = static_cast<int>(c) - 1; prev >= 0; --prev) {
-                        if (fn->valid().test(static_cast<unsigned char>(prev))) {
-                            out_key.push_back(static_cast<char>(prev));
-                            fn->read_value(static_cast<unsigned char>(prev), out_value);
-                            return true;
-                        }
+void TKTRIE_CLASS::set_reclaim_policy(reclaim_policy p) {
+    if constexpr (THREADED) {
+        if (p == reclaim_policy::BACKGROUND) {
+            std::lock_guard<std::mutex> lock(reclaimer_mutex_);
+            if (!reclaimer_) {
+                reclaimer_ = std::make_unique<ebr_reclaimer>([this] {
+                    if (reclaim_policy_.load(std::memory_order_acquire) == reclaim_policy::BACKGROUND) {
+                        ebr_cleanup();
                     }
-                }
-            } else if (kv.empty()) {
-                // Key matches interior position, need EOS which doesn't exist for leaf
-                goto backtrack;
-            }
-            goto backtrack;
-        }
-        
-        // Interior node
-        if (kv.empty()) {
-            // Key matches this interior node's EOS position
-            // EOS is smallest in this subtree, so we need to backtrack
-            goto backtrack;
-        }
-        
-        unsigned char c = static_cast<unsigned char>(kv[0]);
-        kv.remove_prefix(1);
-        
-        bool has_eos = false;
-        if constexpr (FIXED_LEN == 0) {
-            has_eos = n->has_eos();
-        }
-        
-        // Find child for c
-        int child_idx = -1;
-        ptr_t child = nullptr;
-        if (n->is_binary()) {
-            auto* bn = n->template as_binary<false>();
-            child_idx = bn->find(c);
-            if (child_idx >= 0) child = bn->child_at_slot(child_idx);
-        } else if (n->is_list()) {
-            auto* ln = n->template as_list<false>();
-            child_idx = ln->find(c);
-            if (child_idx >= 0) child = ln->child_at_slot(child_idx);
-        } else if (n->is_pop()) {
-            auto* pn = n->template as_pop<false>();
-            if (pn->valid().test(c)) {
-                child_idx = pn->valid().slot_for(c);
-                child = pn->get_child(c);
-            }
-        } else {
-            auto* fn = n->template as_full<false>();
-            if (fn->valid().test(c)) {
-                child_idx = c;
-                child = fn->get_child(c);
-            }
-        }
-        
-        stack.push_back({n, out_key.size(), child_idx, has_eos});
-        out_key.push_back(static_cast<char>(c));
-        
-        if (child) {
-            n = child;
-            continue;
-        }
-        
-        // No exact child, find last child < c
-        goto find_prev_sibling;
-    }
-    
-backtrack:
-    while (!stack.empty()) {
-        frame f = stack.back();
-        stack.pop_back();
-        out_key.resize(f.key_pos);
-        n = f.node;
-        
-        unsigned char prev_c = 0;
-        if (f.key_pos < key.size()) {
-            prev_c = static_cast<unsigned char>(key[f.key_pos]);
-        }
-        
-        // Find last child < prev_c
-        ptr_t prev_child = nullptr;
-        unsigned char pc = 0;
-        
-        if (n->is_binary()) {
-            auto* bn = n->template as_binary<false>();
-            for (int i = bn->count() - 1; i >= 0; --i) {
-                if (bn->char_at(i) < prev_c) {
-                    pc = bn->char_at(i);
-                    prev_child = bn->child_at_slot(i);
-                    break;
-                }
-            }
-        } else if (n->is_list()) {
-            auto* ln = n->template as_list<false>();
-            for (int i = ln->count() - 1; i >= 0; --i) {
-                if (ln->char_at(i) < prev_c) {
-                    pc = ln->char_at(i);
-                    prev_child = ln->child_at_slot(i);
-                    break;
-                }
-            }
-        } else if (n->is_pop()) {
-            auto* pn = n->template as_pop<false>();
-            pn->valid().for_each_set([&](unsigned char ch) {
-                if (ch < prev_c) { pc = ch; prev_child = pn->get_child(ch); }
-            });
-        } else {
-            auto* fn = n->template as_full<false>();
-            for (int c = static_cast<int>(prev_c) - 1; c >= 0; --c) {
-                if (fn->valid().test(static_cast<unsigned char>(c))) {
-                    pc = static_cast<unsigned char>(c);
-                    prev_child = fn->get_child(pc);
-                    break;
-                }
-            }
-        }
-        
-        if (prev_child) {
-            out_key.push_back(static_cast<char>(pc));
-            n = prev_child;
-            goto descend_right;
-        }
-        
-        // No smaller child, check EOS
-        if constexpr (FIXED_LEN == 0) {
-            if (f.has_eos) {
-                n->try_read_eos(out_value);
-                return true;
+                });
             }
         }
+        reclaim_policy_.store(p, std::memory_order_release);
+    } else {
+        reclaim_policy_ = p;
     }
-    return false;
-    
-find_prev_sibling:
-    {
-        if (stack.empty()) return false;
-        frame f = stack.back();
-        stack.pop_back();
-        out_key.resize(f.key_pos);
-        n = f.node;
-        
-        unsigned char prev_c = static_cast<unsigned char>(key[f.key_pos]);
-        ptr_t prev_child = nullptr;
-        unsigned char pc = 0;
-        
-        if (n->is_binary()) {
-            auto* bn = n->template as_binary<false>();
-            for (int i = bn->count() - 1; i >= 0; --i) {
-                if (bn->char_at(i) < prev_c) {
-                    pc = bn->char_at(i);
-                    prev_child = bn->child_at_slot(i);
-                    break;
-                }
-            }
-        } else if (n->is_list()) {
-            auto* ln = n->template as_list<false>();
-            for (int i = ln->count() - 1; i >= 0; --i) {
-                if (ln->char_at(i) < prev_c) {
-                    pc = ln->char_at(i);
-                    prev_child = ln->child_at_slot(i);
-                    break;
-                }
-            }
-        } else if (n->is_pop()) {
-            auto* pn = n->template as_pop<false>();
-            pn->valid().for_each_set([&](unsigned char ch) {
-                if (ch < prev_c) { pc = ch; prev_child = pn->get_child(ch); }
-            });
-        } else {
-            auto* fn = n->template as_full<false>();
-            for (int c = static_cast<int>(prev_c) - 1; c >= 0; --c) {
-                if (fn->valid().test(static_cast<unsigned char>(c))) {
-                    pc = static_cast<unsigned char>(c);
-                    prev_child = fn->get_child(pc);
-                    break;
-                }
-            }
-        }
-        
-        if (prev_child) {
-            out_key.push_back(static_cast<char>(pc));
-            n = prev_child;
-            goto descend_right;
-        }
-        
-        // Check EOS
-        if constexpr (FIXED_LEN == 0) {
-            if (f.has_eos) {
-                n->try_read_eos(out_value);
-                return true;
-            }
-        }
-        goto backtrack;
+}
+
+TKTRIE_TEMPLATE
+reclaim_policy TKTRIE_CLASS::get_reclaim_policy() const noexcept {
+    if constexpr (THREADED) {
+        return reclaim_policy_.load(std::memory_order_relaxed);
+    } else {
+        return reclaim_policy_;
     }
+}
 
-descend_right:
-    while (n && !n->is_poisoned()) {
-        out_key.append(n->skip_str());
-        
-        if (n->is_leaf()) {
-            if (n->is_skip()) {
-                n->as_skip()->value.try_read(out_value);
-                return true;
-            }
-            // Last entry
-            if (n->is_binary()) {
-                auto* bn = n->template as_binary<true>();
-                int cnt = bn->count();
-                out_key.push_back(static_cast<char>(bn->char_at(cnt - 1)));
-                bn->read_value(cnt - 1, out_value);
-                return true;
-            } else if (n->is_list()) {
-                auto* ln = n->template as_list<true>();
-                int cnt = ln->count();
-                out_key.push_back(static_cast<char>(ln->char_at(cnt - 1)));
-                ln->read_value(cnt - 1, out_value);
-                return true;
-            } else if (n->is_pop()) {
-                auto* pn = n->template as_pop<true>();
-                unsigned char last_c = 255;
-                while (last_c > 0 && !pn->valid().test(last_c)) --last_c;
-                out_key.push_back(static_cast<char>(last_c));
-                pn->element_at_slot(pn->count() - 1).try_read(out_value);
-                return true;
-            } else {
-                auto* fn = n->template as_full<true>();
-                unsigned char last_c = 255;
-                while (last_c > 0 && !fn->valid().test(last_c)) --last_c;
-                out_key.push_back(static_cast<char>(last_c));
-                fn->read_value(last_c, out_value);
-                return true;
-            }
-        }
-        
-        // Interior: descend to rightmost child
-        ptr_t child = nullptr;
-        unsigned char last_c = 0;
-        if (n->is_binary()) {
-            auto* bn = n->template as_binary<false>();
-            int cnt = bn->count();
-            if (cnt > 0) { last_c = bn->char_at(cnt - 1); child = bn->child_at_slot(cnt - 1); }
-        } else if (n->is_list()) {
-            auto* ln = n->template as_list<false>();
-            int cnt = ln->count();
-            if (cnt > 0) { last_c = ln->char_at(cnt - 1); child = ln->child_at_slot(cnt - 1); }
-        } else if (n->is_pop()) {
-            auto* pn = n->template as_pop<false>();
-            if (pn->count() > 0) {
-                unsigned char c = 255;
-                while (c > 0 && !pn->valid().test(c)) --c;
-                last_c = c;
-                child = pn->get_child(last_c);
-            }
-        } else {
-            auto* fn = n->template as_full<false>();
-            if (fn->count() > 0) {
-                unsigned char c = 255;
-                while (c > 0 && !fn->valid().test(c)) --c;
-                last_c = c;
-                child = fn->get_child(last_c);
-            }
-        }
-        
-        if (child) {
-            out_key.push_back(static_cast<char>(last_c));
-            n = child;
-        } else if constexpr (FIXED_LEN == 0) {
-            if (n->has_eos()) {
-                n->try_read_eos(out_value);
-                return true;
-            }
-            return false;
-        } else {
-            return false;
+TKTRIE_TEMPLATE
+void TKTRIE_CLASS::poll() {
+    if constexpr (THREADED) {
+        ebr_cleanup();
+        // What is left was retired within the last grace period. If no reader
+        // holds the epoch back, only the lack of later writes keeps it: skip
+        // the epoch past it (saved cursors re-seek) and free it now.
+        if (retired_count_.load(std::memory_order_relaxed) != 0 &&
+            min_reader_epoch() == epoch_.load(std::memory_order_seq_cst)) {
+            invalidate_cursors();
+            ebr_cleanup();
         }
     }
-    return false;
 }
 
 #undef TKTRIE_TEMPLATE
@@ -0,0 +1,438 @@
+#pragma once
+
+// This file contains the cursor walk behind ordered iteration
+// It should only be included from tktrie_assign.h
+
+namespace gteitelbaum {
+
+#define TKTRIE_TEMPLATE template <typename Key, typename T, bool THREADED, typename Allocator>
+#define TKTRIE_CLASS tktrie<Key, T, THREADED, Allocator>
+
+// -----------------------------------------------------------------------------
+// Cursor walk
+// -----------------------------------------------------------------------------
+// Each frame's pos says where the walk stands in its node:
+//   -2        before everything (an interior's EOS and a SKIP leaf's value
+//             are still to come)
+//   -1        on the EOS / SKIP leaf value, or before the first entry char
+//   0..255    on that entry char: a leaf value, or the child being walked
+//   256       after everything
+// Stepping forward takes the next entry char after pos, backward the previous
+// one and then the EOS. Only chars are stored, so entries added or removed in
+// place around pos never shift it.
+//
+// THREADED walks read like read_impl_optimistic: versions are recorded on
+// push, a frame is re-checked as it is popped (its node's entries were read),
+// and cursor_validate re-checks what is left. Any mismatch tears the walk,
+// which is retried from the last key as a seek.
+
+TKTRIE_TEMPLATE
+inline void TKTRIE_CLASS::cursor_pop(cursor& cur) const noexcept {
+    if constexpr (THREADED) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const auto& f = cur.top();
+        if ((f.node->header() & (VERSION_MASK | FLAG_POISON)) != f.version) cur.torn_ = true;
+    }
+    --cur.depth_;
+}
+
+TKTRIE_TEMPLATE
+inline bool TKTRIE_CLASS::cursor_validate(const cursor& cur) const noexcept {
+    if (cur.torn_) return false;
+    if constexpr (THREADED) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        for (int i = 0; i < cur.depth_; ++i) {
+            const auto& f = cur.at(i);
+            if ((f.node->header() & (VERSION_MASK | FLAG_POISON)) != f.version) return false;
+        }
+    }
+    return true;
+}
+
+// A node retired after the path was walked has a retire epoch of at least
+// cur.epoch_, so it is not freed before epoch_ reaches cur.epoch_ + grace.
+// Non-THREADED tries bump epoch_ whenever they free a node. Call with a
+// reader epoch held.
+TKTRIE_TEMPLATE
+inline bool TKTRIE_CLASS::cursor_usable(const cursor& cur) const noexcept {
+    if (cur.depth_ == 0) return false;
+    if constexpr (THREADED) {
+        if (epoch_.load(std::memory_order_seq_cst) - cur.epoch_ >= EBR_GRACE_EPOCHS) return false;
+        return cursor_validate(cur);
+    } else {
+        return cur.epoch_ == epoch_;
+    }
+}
+
+// Moves the top frame to its next (previous) entry, popping exhausted frames,
+// and descends to the first (last) entry below it. Leaves cur.key_ at the key
+// found.
+TKTRIE_TEMPLATE
+template <typename Out>
+bool TKTRIE_CLASS::cursor_next(cursor& cur, bool forward, Out& out_value) const {
+    while (cur.depth_ > 0) {
+        auto& f = cur.top();
+        ptr_t n = f.node;
+        uint64_t h = n->header();
+
+        if (h & FLAG_SKIP) {
+            if (f.pos == (forward ? -2 : 256)) {
+                f.pos = -1;
+                cur.key_.resize(f.key_len);
+                if (!n->as_skip()->value.try_read(out_value)) cur.torn_ = true;
+                return !cur.torn_;
+            }
+            cursor_pop(cur);
+            if (cur.torn_) return false;
+            continue;
+        }
+
+        if constexpr (FIXED_LEN == 0) {
+            if (forward && f.pos == -2) {
+                f.pos = -1;
+                if (!(h & FLAG_LEAF) && n->has_eos()) {
+                    cur.key_.resize(f.key_len);
+                    if (!n->try_read_eos(out_value)) cur.torn_ = true;
+                    return !cur.torn_;
+                }
+            }
+        }
+
+        int c;
+        if (forward) c = f.pos >= 255 ? -1 : n->next_entry_char(f.pos < 0 ? -1 : f.pos);
+        else c = f.pos <= 0 ? -1 : n->prev_entry_char(f.pos);
+
+        if (c < 0) {
+            if constexpr (FIXED_LEN == 0) {
+                if (!forward && f.pos >= 0 && !(h & FLAG_LEAF) && n->has_eos()) {
+                    f.pos = -1;
+                    cur.key_.resize(f.key_len);
+                    if (!n->try_read_eos(out_value)) cur.torn_ = true;
+                    return !cur.torn_;
+                }
+            }
+            cursor_pop(cur);
+            if (cur.torn_) return false;
+            continue;
+        }
+
+        f.pos = c;
+        cur.key_.resize(f.key_len);
+        cur.key_.push_back(static_cast<char>(c));
+        if (h & FLAG_LEAF) {
+            if (!n->try_read_leaf_value(static_cast<unsigned char>(c), out_value)) cur.torn_ = true;
+            return !cur.torn_;
+        }
+        ptr_t child = n->get_child(static_cast<unsigned char>(c));
+        if (!child) {
+            cur.torn_ = true;  // Listed char without a child: read mid-change
+            return false;
+        }
+        if (!cur.push(child, forward ? -2 : 256)) return false;
+    }
+    return false;
+}
+
+// Walks target's path, leaving each frame just before (after) the part of its
+// node on the wanted side of target, then finishes with cursor_next
+TKTRIE_TEMPLATE
+template <typename Out>
+bool TKTRIE_CLASS::cursor_seek_impl(cursor& cur, std::string_view target, bool forward, bool strict,
+                                    Out& out_value) const {
+    cur.reset();
+    if constexpr (THREADED) cur.epoch_ = epoch_.load(std::memory_order_seq_cst);
+    else cur.epoch_ = epoch_;
+
+    ptr_t n = root_.load();
+    if (!n) return false;
+    std::string_view kv = target;
+
+    while (true) {
+        if (!cur.push(n, forward ? -2 : 256)) return false;
+        auto& f = cur.top();
+        uint64_t h = n->header();
+
+        std::string_view skip = n->skip_str();
+        size_t m = match_skip_impl(skip, kv);
+        if (m < skip.size()) {
+            // The whole subtree sorts on one side of target
+            bool greater = m == kv.size() ||
+                           static_cast<unsigned char>(kv[m]) < static_cast<unsigned char>(skip[m]);
+            if (greater != forward) f.pos = forward ? 256 : -2;
+            return cursor_next(cur, forward, out_value);
+        }
+        kv.remove_prefix(m);
+
+        if (h & FLAG_SKIP) {
+            // Its key equals target if kv is empty, else sorts before it
+            bool wanted = kv.empty() ? !strict : !forward;
+            if (!wanted) f.pos = -1;
+            return cursor_next(cur, forward, out_value);
+        }
+
+        if (kv.empty()) {
+            // Entries below sort after target; an EOS equals it
+            if (forward) {
+                f.pos = strict ? -1 : -2;
+            } else {
+                f.pos = (strict || (h & FLAG_LEAF)) ? -1 : 0;
+            }
+            return cursor_next(cur, forward, out_value);
+        }
+
+        int c0 = static_cast<unsigned char>(kv[0]);
+        kv.remove_prefix(1);
+
+        if (h & FLAG_LEAF) {
+            // Entry c0 equals target if nothing follows it, else sorts before
+            if (forward) f.pos = (kv.empty() && !strict) ? c0 - 1 : c0;
+            else f.pos = (!kv.empty() || !strict) ? c0 + 1 : c0;
+            return cursor_next(cur, forward, out_value);
+        }
+
+        f.pos = c0;
+        ptr_t child = n->get_child(static_cast<unsigned char>(c0));
+        if (!child) return cursor_next(cur, forward, out_value);
+        cur.key_.push_back(static_cast<char>(c0));
+        n = child;
+    }
+}
+
+// Runs walk(fresh) until it validates, fresh = false on the first try only,
+// then once more under the writer lock. The key found is copied to out_key.
+TKTRIE_TEMPLATE
+template <typename Walk>
+bool TKTRIE_CLASS::cursor_run(cursor& cur, std::string& out_key, Walk&& walk) const {
+    bool found;
+    if constexpr (THREADED) {
+        const_cast<tktrie*>(this)->maybe_reclaim(EBR_MIN_RETIRED * 2);
+
+        auto* rec = reader_enter();
+        bool validated = false;
+        for (int attempts = 0; attempts < OPTIMISTIC_READ_ATTEMPTS; ++attempts) {
+            found = walk(attempts > 0);
+            if (cursor_validate(cur)) {
+                validated = true;
+                break;
+            }
+        }
+        if (!validated) {
+            exclusive_lock lock(*this);
+            found = walk(true);
+        }
+        reader_exit(rec);
+    } else {
+        found = walk(false);
+    }
+    if (!found) {
+        cur.reset();
+        return false;
+    }
+    out_key.assign(cur.key_);
+    return true;
+}
+
+TKTRIE_TEMPLATE
+bool TKTRIE_CLASS::cursor_first(cursor& cur, bool forward, std::string& out_key, held_t& out_value) const {
+    return cursor_run(cur, out_key, [&](bool) {
+        cur.reset();
+        if constexpr (THREADED) cur.epoch_ = epoch_.load(std::memory_order_seq_cst);
+        else cur.epoch_ = epoch_;
+        ptr_t n = root_.load();
+        if (!n || !cur.push(n, forward ? -2 : 256)) return false;
+        return cursor_next(cur, forward, out_value);
+    });
+}
+
+TKTRIE_TEMPLATE
+bool TKTRIE_CLASS::cursor_seek(cursor& cur, std::string_view target, bool forward, bool strict,
+                               std::string& out_key, held_t& out_value) const {
+    return cursor_run(cur, out_key, [&](bool) {
+        return cursor_seek_impl(cur, target, forward, strict, out_value);
+    });
+}
+
+// The saved path is stepped along while it is usable; once it is not (or a
+// step tears) the walk re-seeks past key
+TKTRIE_TEMPLATE
+bool TKTRIE_CLASS::cursor_step(cursor& cur, bool forward, std::string& key, held_t& out_value) const {
+    return cursor_run(cur, key, [&](bool retry) {
+        if (!retry && cursor_usable(cur)) return cursor_next(cur, forward, out_value);
+        return cursor_seek_impl(cur, key, forward, true, out_value);
+    });
+}
+
+// -----------------------------------------------------------------------------
+// Iterator helpers: find first/last/greater/less
+// -----------------------------------------------------------------------------
+
+TKTRIE_TEMPLATE
+bool TKTRIE_CLASS::find_first_bytes(std::string& out_key, held_t& out_value) const {
+    cursor cur;
+    return cursor_first(cur, true, out_key, out_value);
+}
+
+TKTRIE_TEMPLATE
+bool TKTRIE_CLASS::find_last_bytes(std::string& out_key, held_t& out_value) const {
+    cursor cur;
+    return cursor_first(cur, false, out_key, out_value);
+}
+
+TKTRIE_TEMPLATE
+bool TKTRIE_CLASS::find_greater_bytes(const std::string& key, std::string& out_key, held_t& out_value) const {
+    cursor cur;
+    return cursor_seek(cur, key, true, true, out_key, out_value);
+}
+
+TKTRIE_TEMPLATE
+bool TKTRIE_CLASS::find_less_bytes(const std::string& key, std::string& out_key, held_t& out_value) const {
+    cursor cur;
+    return cursor_seek(cur, key, false, true, out_key, out_value);
+}
+
+// -----------------------------------------------------------------------------
+// Range scans
+// -----------------------------------------------------------------------------
+// One seek, then cursor_next, which skips straight to each node's next
+// occupied char through its bitmap or list. The walk holds one reader epoch
+// throughout, so the value pins handed to fn stay valid for each call.
+
+TKTRIE_TEMPLATE
+template <typename InRange, typename Fn>
+size_t TKTRIE_CLASS::cursor_walk(std::string_view start, InRange&& in_range, Fn&& fn,
+                                 size_t limit) const {
+    if (limit == 0) return 0;
+    read_guard epoch;
+    epoch.trie_ = this;
+    epoch.rec_ = reader_enter();
+
+    cursor cur;
+    std::string key;
+    pin_t pin{};
+    size_t n = 0;
+    bool found = cursor_run(cur, key, [&](bool) {
+        return cursor_seek_impl(cur, start, true, false, pin);
+    });
+    while (found && in_range(std::string_view(key))) {
+        if constexpr (data_t::PINNABLE) fn(std::string_view(key), *pin);
+        else fn(std::string_view(key), pin);
+        if (++n == limit) break;
+        found = cursor_run(cur, key, [&](bool retry) {
+            if (!retry && cursor_usable(cur)) return cursor_next(cur, true, pin);
+            return cursor_seek_impl(cur, key, true, true, pin);
+        });
+    }
+    return n;
+}
+
+TKTRIE_TEMPLATE
+template <typename Fn>
+size_t TKTRIE_CLASS::scan(const Key& lo, const Key& hi, Fn&& fn, size_t limit) const {
+    auto lo_kb = traits::to_bytes(lo);
+    auto hi_kb = traits::to_bytes(hi);
+    return scan_bytes(std::string_view(lo_kb.data(), lo_kb.size()), std::string_view(hi_kb.data(), hi_kb.size()),
+                      fn, limit);
+}
+
+TKTRIE_TEMPLATE
+template <typename Fn>
+size_t TKTRIE_CLASS::scan_bytes(std::string_view lo_v, std::string_view hi_v, Fn&& fn, size_t limit) const {
+    if (!(lo_v < hi_v)) return 0;
+
+    Key k{};  // Reused: a string key keeps its capacity across the walk
+    return cursor_walk(lo_v, [hi_v](std::string_view kb) { return kb < hi_v; },
+        [&](std::string_view kb, const T& v) {
+            if constexpr (FIXED_LEN == 0) k.assign(kb);
+            else k = traits::from_bytes(kb);
+            fn(static_cast<const Key&>(k), v);
+        }, limit);
+}
+
+TKTRIE_TEMPLATE
+typename TKTRIE_CLASS::iterator TKTRIE_CLASS::lower_bound(const Key& key) {
+    auto kb = traits::to_bytes(key);
+    return iterator::make_seek(this, std::string_view(kb.data(), kb.size()), false);
+}
+
+TKTRIE_TEMPLATE
+typename TKTRIE_CLASS::const_iterator TKTRIE_CLASS::lower_bound(const Key& key) const {
+    auto kb = traits::to_bytes(key);
+    return const_iterator::make_seek(this, std::string_view(kb.data(), kb.size()), false);
+}
+
+TKTRIE_TEMPLATE
+typename TKTRIE_CLASS::iterator TKTRIE_CLASS::upper_bound(const Key& key) {
+    auto kb = traits::to_bytes(key);
+    return iterator::make_seek(this, std::string_view(kb.data(), kb.size()), true);
+}
+
+TKTRIE_TEMPLATE
+typename TKTRIE_CLASS::const_iterator TKTRIE_CLASS::upper_bound(const Key& key) const {
+    auto kb = traits::to_bytes(key);
+    return const_iterator::make_seek(this, std::string_view(kb.data(), kb.size()), true);
+}
+
+TKTRIE_TEMPLATE
+std::pair<typename TKTRIE_CLASS::iterator, typename TKTRIE_CLASS::iterator>
+TKTRIE_CLASS::equal_range(const Key& key) {
+    auto kb = traits::to_bytes(key);
+    return equal_range_bytes<iterator>(this, std::string_view(kb.data(), kb.size()));
+}
+
+TKTRIE_TEMPLATE
+std::pair<typename TKTRIE_CLASS::const_iterator, typename TKTRIE_CLASS::const_iterator>
+TKTRIE_CLASS::equal_range(const Key& key) const {
+    auto kb = traits::to_bytes(key);
+    return equal_range_bytes<const_iterator>(this, std::string_view(kb.data(), kb.size()));
+}
+
+// The upper bound is a snapshot position, so it is also bounded just past
+// kb (kb + '\0' is the next key in byte order): a walk from the lower bound
+// stops there even if the key it was seeked to goes away
+TKTRIE_TEMPLATE
+template <typename It, typename Self>
+std::pair<It, It> TKTRIE_CLASS::equal_range_bytes(Self* self, std::string_view kb) {
+    std::string bound(kb);
+    bound.push_back('\0');
+    return {It::make_seek(self, kb, false), It::make_bounded(It::make_seek(self, kb, true), std::move(bound))};
+}
+
+// -----------------------------------------------------------------------------
+// Prefix scans
+// -----------------------------------------------------------------------------
+
+TKTRIE_TEMPLATE
+template <typename Fn>
+void TKTRIE_CLASS::for_each_with_prefix(std::string_view prefix, Fn&& fn) const requires (FIXED_LEN == 0) {
+    cursor_walk(prefix, [prefix](std::string_view kb) { return kb.starts_with(prefix); }, fn, SIZE_MAX);
+}
+
+// The end is a bound, not a seek: it compares equal to the first iterator
+// past the prefix's keys, whatever was inserted or erased after the call
+TKTRIE_TEMPLATE
+template <typename It, typename Self>
+tktrie_range<It> TKTRIE_CLASS::prefix_range_bytes(Self* self, std::string_view prefix) {
+    std::string succ;
+    It first = It::make_seek(self, prefix, false);
+    if (!prefix_successor(prefix, succ)) return {std::move(first), It::make_end(self)};
+    return {std::move(first), It::make_bounded(It::make_end(self), std::move(succ))};
+}
+
+TKTRIE_TEMPLATE
+tktrie_range<typename TKTRIE_CLASS::iterator> TKTRIE_CLASS::prefix_range(std::string_view prefix)
+    requires (FIXED_LEN == 0) {
+    return prefix_range_bytes<iterator>(this, prefix);
+}
+
+TKTRIE_TEMPLATE
+tktrie_range<typename TKTRIE_CLASS::const_iterator> TKTRIE_CLASS::prefix_range(std::string_view prefix) const
+    requires (FIXED_LEN == 0) {
+    return prefix_range_bytes<const_iterator>(this, prefix);
+}
+
+#undef TKTRIE_TEMPLATE
+#undef TKTRIE_CLASS
+
+}  // namespace gteitelbaum
+
+#include "tktrie_batch.h"
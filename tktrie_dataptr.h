@@ -4,40 +4,131 @@
 #include <cstring>
 #include <memory>
 #include <type_traits>
+#include <utility>
 
 #include "tktrie_defines.h"
 
 namespace gteitelbaum {
 
+// =============================================================================
+// VALUE_BOX - heap value storage, with retire linkage when THREADED
+// =============================================================================
+// A move-only T can't be copied into a node's replacement, so its box is
+// shared instead and counted: each slot holding it (a node and its clone),
+// each iterator (value_ref) and the retire list owns one reference, and
+// destroy_box drops one. Other values are copied and their boxes never shared.
+
+template <typename T>
+inline constexpr bool SHARED_VALUE = !std::is_copy_constructible_v<T>;
+
+struct no_box_refs {};
+
+template <typename T, bool THREADED>
+struct value_box {
+    T value;
+    // References beyond the first (SHARED_VALUE only)
+    [[no_unique_address]] std::conditional_t<SHARED_VALUE<T>, uint32_t, no_box_refs> refs{};
+
+    template <typename... Args>
+    explicit value_box(Args&&... args) : value(std::forward<Args>(args)...) {}
+};
+
+template <typename T>
+struct value_box<T, true> {
+    T value;
+    value_box* retire_next = nullptr;
+    uint64_t retire_epoch = 0;
+    // References beyond the first (SHARED_VALUE only)
+    [[no_unique_address]] std::conditional_t<SHARED_VALUE<T>, std::atomic<uint32_t>, no_box_refs> refs{};
+
+    template <typename... Args>
+    explicit value_box(Args&&... args) : value(std::forward<Args>(args)...) {}
+};
+
+// =============================================================================
+// VALUE_RETIRE_SINK - where a THREADED trie's writes send unlinked values
+// =============================================================================
+// A value replaced or removed in a live node may still be read by a lock-free
+// reader (or pinned by visit()/read_guard), so while a trie write has a sink
+// installed, dataptr hands such boxes to it instead of destroying them. The
+// trie frees them through EBR like nodes. With no sink they die at once.
+
+template <typename T, typename Allocator>
+struct value_retire_sink {
+    using box_t = value_box<T, true>;
+
+    void* owner;
+    void (*retire)(void* owner, box_t* b);
+
+    static value_retire_sink*& current() noexcept {
+        thread_local value_retire_sink* sink = nullptr;
+        return sink;
+    }
+};
+
+template <typename T, typename Allocator>
+class value_retire_scope {
+    using sink_t = value_retire_sink<T, Allocator>;
+    sink_t sink_;
+    sink_t* prev_;
+
+public:
+    value_retire_scope(void* owner, void (*retire)(void*, typename sink_t::box_t*)) noexcept
+        : sink_{owner, retire}, prev_(sink_t::current()) {
+        sink_t::current() = &sink_;
+    }
+    ~value_retire_scope() { sink_t::current() = prev_; }
+
+    value_retire_scope(const value_retire_scope&) = delete;
+    value_retire_scope& operator=(const value_retire_scope&) = delete;
+};
+
+template <typename T, bool THREADED, typename Allocator>
+class value_source;
+
+template <typename T, bool THREADED, typename Allocator>
+class value_ref;
+
 // =============================================================================
 // DATAPTR - value storage with inline optimization
 // =============================================================================
 
 template <typename T, bool THREADED, typename Allocator, bool OPTIONAL = false>
 class dataptr {
-    static constexpr bool INLINE = !OPTIONAL && sizeof(T) <= sizeof(T*) && std::is_trivially_copyable_v<T>;
-    
+public:
+    static constexpr bool SHARED = SHARED_VALUE<T>;
+    static constexpr bool INLINE = !OPTIONAL && !SHARED && sizeof(T) <= sizeof(T*) && std::is_trivially_copyable_v<T>;
+
+    using box_t = value_box<T, THREADED>;
+    using source_t = value_source<T, THREADED, Allocator>;
+    using ref_t = value_ref<T, THREADED, Allocator>;
+    // What a copying read (an iterator, say) holds: a copy of the value, or
+    // for a move-only T a reference to its box
+    using held_t = std::conditional_t<SHARED, ref_t, T>;
+    // Readers can hold a const T* into the storage; otherwise (atomic inline
+    // storage) they take a copy, which is at most pointer-sized
+    static constexpr bool PINNABLE = !INLINE || !THREADED;
+
+private:
     using alloc_traits = std::allocator_traits<Allocator>;
-    using value_alloc_t = typename alloc_traits::template rebind_alloc<T>;
-    using value_alloc_traits = std::allocator_traits<value_alloc_t>;
+    // Boxes are made without the trie at hand, so with a default-constructed
+    // Allocator; one that has no default (stateful) falls back to std::allocator
+    using rebound_box_alloc_t = typename alloc_traits::template rebind_alloc<box_t>;
+    using box_alloc_t = std::conditional_t<std::is_default_constructible_v<rebound_box_alloc_t>,
+                                           rebound_box_alloc_t, std::allocator<box_t>>;
+    using box_alloc_traits = std::allocator_traits<box_alloc_t>;
 
     std::conditional_t<INLINE,
         std::conditional_t<THREADED, std::atomic<T>, T>,
-        std::conditional_t<THREADED, std::atomic<T*>, T*>
+        std::conditional_t<THREADED, std::atomic<box_t*>, box_t*>
     > storage_{};
 
 public:
     dataptr() noexcept = default;
     
     ~dataptr() {
-        if constexpr (!INLINE) {
-            T* p = load_ptr();
-            if (p) {
-                value_alloc_t alloc;
-                std::destroy_at(p);
-                value_alloc_traits::deallocate(alloc, p, 1);
-            }
-        }
+        // The node is unreachable by now: no reader can still hold the box
+        if constexpr (!INLINE) destroy_box(load_ptr());
     }
     
     dataptr(const dataptr&) = delete;
@@ -56,12 +147,7 @@ public:
             if constexpr (INLINE) {
                 store_inline(other.load_inline());
             } else {
-                T* old = exchange_ptr(other.exchange_ptr(nullptr));
-                if (old) {
-                    value_alloc_t alloc;
-                    std::destroy_at(old);
-                    value_alloc_traits::deallocate(alloc, old, 1);
-                }
+                dispose(exchange_ptr(other.exchange_ptr(nullptr)));
             }
         }
         return *this;
@@ -77,19 +163,40 @@ public:
             out = load_inline();
             return true;
         } else {
-            T* p = load_ptr();
-            if (!p) return false;
-            out = *p;
+            box_t* b = load_ptr();
+            if (!b) return false;
+            out = b->value;
+            return true;
+        }
+    }
+
+    // Zero-copy read: valid until the value is replaced or removed (THREADED:
+    // until the reader's epoch ends, see value_retire_sink)
+    bool try_read(const T*& out) const noexcept requires PINNABLE {
+        if constexpr (INLINE) {
+            out = &storage_;
+            return true;
+        } else {
+            box_t* b = load_ptr();
+            if (!b) return false;
+            out = &b->value;
             return true;
         }
     }
+
+    bool try_read(ref_t& out) const noexcept requires SHARED {
+        box_t* b = load_ptr();
+        if (!b) return false;
+        out.reset(b);
+        return true;
+    }
     
     T read() const noexcept {
         if constexpr (INLINE) {
             return load_inline();
         } else {
-            T* p = load_ptr();
-            return p ? *p : T{};
+            box_t* b = load_ptr();
+            return b ? b->value : T{};
         }
     }
 
@@ -97,12 +204,7 @@ public:
         if constexpr (INLINE) {
             store_inline(value);
         } else {
-            value_alloc_t alloc;
-            T* new_ptr = value_alloc_traits::allocate(alloc, 1);
-            try { std::construct_at(new_ptr, value); }
-            catch (...) { value_alloc_traits::deallocate(alloc, new_ptr, 1); throw; }
-            T* old = exchange_ptr(new_ptr);
-            if (old) { std::destroy_at(old); value_alloc_traits::deallocate(alloc, old, 1); }
+            dispose(exchange_ptr(make_box(value)));
         }
     }
 
@@ -110,12 +212,28 @@ public:
         if constexpr (INLINE) {
             store_inline(value);
         } else {
-            value_alloc_t alloc;
-            T* new_ptr = value_alloc_traits::allocate(alloc, 1);
-            try { std::construct_at(new_ptr, std::move(value)); }
-            catch (...) { value_alloc_traits::deallocate(alloc, new_ptr, 1); throw; }
-            T* old = exchange_ptr(new_ptr);
-            if (old) { std::destroy_at(old); value_alloc_traits::deallocate(alloc, old, 1); }
+            dispose(exchange_ptr(make_box(std::move(value))));
+        }
+    }
+
+    void set(const ref_t& r) requires SHARED {
+        acquire_box(r.box());
+        dispose(exchange_ptr(r.box()));
+    }
+
+    // Adopts the source's box if it still has one to give, else copies its
+    // value (a move-only T's box is shared)
+    void set(const source_t& src) {
+        if constexpr (INLINE) {
+            store_inline(src.get());
+        } else if (box_t* b = src.adopt(&storage_)) {
+            dispose(exchange_ptr(b));
+        } else if constexpr (SHARED) {
+            box_t* shared = src.shared_box();
+            acquire_box(shared);
+            dispose(exchange_ptr(shared));
+        } else {
+            dispose(exchange_ptr(make_box(src.get())));
         }
     }
 
@@ -123,26 +241,69 @@ public:
         if constexpr (INLINE) {
             store_inline(T{});
         } else {
-            T* old = exchange_ptr(nullptr);
-            if (old) {
-                value_alloc_t alloc;
-                std::destroy_at(old);
-                value_alloc_traits::deallocate(alloc, old, 1);
-            }
+            dispose(exchange_ptr(nullptr));
         }
     }
 
+    // A move-only T's box is shared rather than copied
     void deep_copy_from(const dataptr& other) {
         if constexpr (INLINE) {
             store_inline(other.load_inline());
+        } else if constexpr (SHARED) {
+            box_t* src = other.load_ptr();
+            if (src) acquire_box(src);
+            dispose(exchange_ptr(src));
         } else {
-            T* src = other.load_ptr();
-            if (src) set(*src);
+            box_t* src = other.load_ptr();
+            if (src) set(src->value);
             else clear();
         }
     }
 
+    template <typename... Args>
+    static box_t* make_box(Args&&... args) {
+        box_alloc_t alloc;
+        box_t* b = box_alloc_traits::allocate(alloc, 1);
+        try { std::construct_at(b, std::forward<Args>(args)...); }
+        catch (...) { box_alloc_traits::deallocate(alloc, b, 1); throw; }
+        return b;
+    }
+
+    static void acquire_box(box_t* b) noexcept {
+        if constexpr (SHARED) {
+            if constexpr (THREADED) b->refs.fetch_add(1, std::memory_order_relaxed);
+            else ++b->refs;
+        }
+    }
+
+    // Drops one reference to a shared box, and destroys it with the last
+    static void destroy_box(box_t* b) noexcept {
+        if (!b) return;
+        if constexpr (SHARED) {
+            if constexpr (THREADED) {
+                if (b->refs.fetch_sub(1, std::memory_order_acq_rel) != 0) return;
+            } else {
+                if (b->refs-- != 0) return;
+            }
+        }
+        box_alloc_t alloc;
+        std::destroy_at(b);
+        box_alloc_traits::deallocate(alloc, b, 1);
+    }
+
 private:
+    // A box unlinked from a live node: defer to the installed sink, if any
+    static void dispose(box_t* b) noexcept {
+        if (!b) return;
+        if constexpr (THREADED) {
+            if (auto* sink = value_retire_sink<T, Allocator>::current()) {
+                sink->retire(sink->owner, b);
+                return;
+            }
+        }
+        destroy_box(b);
+    }
+
     T load_inline() const noexcept {
         if constexpr (THREADED) return storage_.load(std::memory_order_acquire);
         else return storage_;
@@ -152,18 +313,123 @@ private:
         else storage_ = v;
     }
     
-    T* load_ptr() const noexcept {
+    box_t* load_ptr() const noexcept {
         if constexpr (THREADED) return storage_.load(std::memory_order_acquire);
         else return storage_;
     }
-    void store_ptr(T* p) noexcept {
+    void store_ptr(box_t* p) noexcept {
         if constexpr (THREADED) storage_.store(p, std::memory_order_release);
         else storage_ = p;
     }
-    T* exchange_ptr(T* p) noexcept {
+    box_t* exchange_ptr(box_t* p) noexcept {
         if constexpr (THREADED) return storage_.exchange(p, std::memory_order_acq_rel);
-        else { T* old = storage_; storage_ = p; return old; }
+        else { box_t* old = storage_; storage_ = p; return old; }
+    }
+};
+
+// =============================================================================
+// VALUE_SOURCE - a value on its way into the trie
+// =============================================================================
+// Either borrows a caller's T, which the slot storing it copies, or owns a box
+// built up front (rvalue insert, emplace) which the first slot to store it
+// adopts, so the value is constructed once in its final storage. A writer
+// discarding the adopting node unpublished calls reclaim() first. A move-only
+// T moved between nodes comes from a value_ref, whose box each slot shares.
+
+template <typename T, bool THREADED, typename Allocator>
+class value_source {
+public:
+    using box_t = value_box<T, THREADED>;
+    using slot_t = std::conditional_t<THREADED, std::atomic<box_t*>, box_t*>;
+
+private:
+    using data_t = dataptr<T, THREADED, Allocator>;
+
+    const T* value_;
+    box_t* box_ = nullptr;
+    mutable slot_t* slot_ = nullptr;  // Adopter, while box_ lives there
+    box_t* shared_ = nullptr;         // Not owned: the value_ref's
+
+public:
+    value_source(const T& v) noexcept : value_(&v) {}
+    explicit value_source(box_t* b) noexcept : value_(&b->value), box_(b) {}
+    value_source(const value_ref<T, THREADED, Allocator>& r) noexcept
+        : value_(&r.box()->value), shared_(r.box()) {}
+
+    ~value_source() {
+        if (box_ && !slot_) data_t::destroy_box(box_);
     }
+
+    value_source(const value_source&) = delete;
+    value_source& operator=(const value_source&) = delete;
+
+    // Still valid once adopted: the box then belongs to the trie
+    const T& get() const noexcept { return *value_; }
+
+    // The box a move-only T's slots share: the value_ref's, or this source's
+    // own once adopted
+    box_t* shared_box() const noexcept { return shared_ ? shared_ : box_; }
+
+    // The value as an iterator holds it: a copy, or for a move-only T a
+    // reference to the box it was stored in
+    typename data_t::held_t held() const {
+        if constexpr (data_t::SHARED) {
+            value_ref<T, THREADED, Allocator> r;
+            r.reset(shared_box());
+            return r;
+        } else {
+            return *value_;
+        }
+    }
+
+    box_t* adopt(slot_t* slot) const noexcept {
+        if (!box_ || slot_) return nullptr;
+        slot_ = slot;
+        return box_;
+    }
+
+    void reclaim() const noexcept {
+        if (!slot_) return;
+        if constexpr (THREADED) slot_->store(nullptr, std::memory_order_relaxed);
+        else *slot_ = nullptr;
+        slot_ = nullptr;
+    }
+};
+
+// =============================================================================
+// VALUE_REF - a counted reference to a move-only T's box
+// =============================================================================
+// Iterators hold one in place of a copy, and node rebuilds read entries into
+// one to share them (see value_box). Whoever takes a reference from a slot
+// does so inside a read epoch (THREADED), while the slot's own still holds.
+
+template <typename T, bool THREADED, typename Allocator>
+class value_ref {
+    using data_t = dataptr<T, THREADED, Allocator>;
+    using box_t = value_box<T, THREADED>;
+
+    box_t* box_ = nullptr;
+
+public:
+    value_ref() noexcept = default;
+    value_ref(const value_ref& o) noexcept : box_(o.box_) {
+        if (box_) data_t::acquire_box(box_);
+    }
+    value_ref(value_ref&& o) noexcept : box_(std::exchange(o.box_, nullptr)) {}
+    value_ref& operator=(value_ref o) noexcept {
+        std::swap(box_, o.box_);
+        return *this;
+    }
+    ~value_ref() { data_t::destroy_box(box_); }
+
+    // Drops the current box and takes a reference to b
+    void reset(box_t* b) noexcept {
+        if (b) data_t::acquire_box(b);
+        data_t::destroy_box(std::exchange(box_, b));
+    }
+
+    box_t* box() const noexcept { return box_; }
+    operator const T&() const noexcept { return box_->value; }
 };
 
 }  // namespace gteitelbaum
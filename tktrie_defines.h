@@ -19,6 +19,18 @@
 #define KTRIE_DEBUG_ASSERT(cond) assert(cond)
 #endif
 
+// Hint that a node is about to be read, so its first cache line is on the way
+#if defined(__GNUC__) || defined(__clang__)
+#define KTRIE_PREFETCH(p) __builtin_prefetch((p), 0, 3)
+#else
+#define KTRIE_PREFETCH(p) ((void)(p))
+#endif
+
+// 128-bit integer keys (UUIDs, IPv6 addresses), where the compiler has __int128
+#if defined(__SIZEOF_INT128__)
+#define KTRIE_HAS_INT128 1
+#endif
+
 template <typename T, typename... Args>
 constexpr T* ktrie_construct_at(T* p, Args&&... args) {
 #if __cplusplus >= 202002L && defined(__cpp_lib_constexpr_dynamic_alloc)
@@ -84,6 +96,15 @@ public:
         if constexpr (THREADED) return value_.fetch_and(v, std::memory_order_acq_rel);
         else { T old = value_; value_ &= v; return old; }
     }
+    
+    bool compare_exchange(T& expected, T desired) noexcept {
+        if constexpr (THREADED) return value_.compare_exchange_strong(expected, desired, std::memory_order_acq_rel);
+        else {
+            if (value_ != expected) { expected = value_; return false; }
+            value_ = desired;
+            return true;
+        }
+    }
 };
 
 template <bool THREADED>
@@ -140,7 +161,16 @@ inline constexpr uint64_t make_header(bool is_leaf, uint64_t type_flag,
          | (version & VERSION_MASK);
 }
 
+// Versions advance by 2; an odd version marks an in-place write in progress
+static constexpr uint64_t VERSION_WRITING = 1;
+
 inline constexpr uint64_t bump_version(uint64_t h) noexcept {
+    uint64_t flags = h & FLAGS_MASK;
+    uint64_t ver = (h & VERSION_MASK) + 2;
+    return flags | (ver & VERSION_MASK);
+}
+
+inline constexpr uint64_t step_version(uint64_t h) noexcept {
     uint64_t flags = h & FLAGS_MASK;
     uint64_t ver = (h & VERSION_MASK) + 1;
     return flags | (ver & VERSION_MASK);
@@ -151,7 +181,7 @@ inline constexpr uint64_t clear_flag(uint64_t h, uint64_t flag) noexcept { retur
 
 template <typename T>
 constexpr T ktrie_byteswap(T value) noexcept {
-    static_assert(std::is_integral_v<T>);
+    static_assert(std::is_integral_v<T> || sizeof(T) == 16);
     if constexpr (sizeof(T) == 1) return value;
     else if constexpr (sizeof(T) == 2)
         return static_cast<T>(((static_cast<uint16_t>(value) & 0x00FFu) << 8) |
@@ -160,6 +190,11 @@ constexpr T ktrie_byteswap(T value) noexcept {
         uint32_t v = static_cast<uint32_t>(value);
         return static_cast<T>(((v & 0x000000FFu) << 24) | ((v & 0x0000FF00u) << 8) |
                               ((v & 0x00FF0000u) >> 8)  | ((v & 0xFF000000u) >> 24));
+    } else if constexpr (sizeof(T) == 16) {
+        // Swap each half, and the halves
+        uint64_t lo = ktrie_byteswap(static_cast<uint64_t>(value));
+        uint64_t hi = ktrie_byteswap(static_cast<uint64_t>(value >> 64));
+        return static_cast<T>((static_cast<T>(lo) << 64) | hi);
     } else {
         uint64_t v = static_cast<uint64_t>(value);
         return static_cast<T>(
@@ -391,6 +426,32 @@ public:
         return 0;
     }
     
+    // Smallest set char above `after` (-1: from the start), or -1 if none
+    int next_set(int after) const noexcept {
+        int c = after + 1;
+        if (c > 255) return -1;
+        int w = c >> 6;
+        uint64_t bits = load_word(w) & (~0ULL << (c & 63));
+        while (!bits) {
+            if (++w == 4) return -1;
+            bits = load_word(w);
+        }
+        return (w << 6) | std::countr_zero(bits);
+    }
+    
+    // Largest set char below `before` (256: from the end), or -1 if none
+    int prev_set(int before) const noexcept {
+        int c = before - 1;
+        if (c < 0) return -1;
+        int w = c >> 6;
+        uint64_t bits = load_word(w) & (~0ULL >> (63 - (c & 63)));
+        while (!bits) {
+            if (--w < 0) return -1;
+            bits = load_word(w);
+        }
+        return (w << 6) | (63 - std::countl_zero(bits));
+    }
+    
     template <typename Fn>
     void for_each_set(Fn&& fn) const noexcept {
         for (int w = 0; w < 4; ++w) {
@@ -441,6 +502,8 @@ public:
 struct empty_mutex {
     void lock() noexcept {}
     void unlock() noexcept {}
+    void lock_shared() noexcept {}
+    void unlock_shared() noexcept {}
 };
 
 // =============================================================================
@@ -449,7 +512,8 @@ struct empty_mutex {
 
 template <size_t MAX_LEN>
 class inline_skip {
-    static_assert(MAX_LEN > 0 && MAX_LEN <= 16, "MAX_LEN must be 1-16");
+    // The last byte holds the length, so up to 255 bytes fit in 256
+    static_assert(MAX_LEN > 0 && MAX_LEN <= 256, "MAX_LEN must be 1-256");
     
     char data_[MAX_LEN] = {};
     
@@ -539,4 +603,15 @@ inline size_t match_skip_impl(std::string_view skip, std::string_view key) noexc
     return i;
 }
 
+// Smallest byte string above every string starting with prefix: prefix with
+// trailing 0xFF bytes dropped and the last byte left bumped. False if there
+// is none (prefix empty or all 0xFF).
+inline bool prefix_successor(std::string_view prefix, std::string& out) {
+    out.assign(prefix);
+    while (!out.empty() && static_cast<unsigned char>(out.back()) == 0xFF) out.pop_back();
+    if (out.empty()) return false;
+    out.back() = static_cast<char>(static_cast<unsigned char>(out.back()) + 1);
+    return true;
+}
+
 }  // namespace gteitelbaum
@@ -1,13 +1,213 @@
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <thread>
 
 namespace gteitelbaum {
 
-inline size_t thread_slot_hash(size_t max_slots) noexcept {
-    std::hash<std::thread::id> hasher;
-    return hasher(std::this_thread::get_id()) % max_slots;
+// =============================================================================
+// EBR_READER_RECORD - one per (thread, trie), on its own cache line
+// =============================================================================
+
+struct alignas(64) ebr_reader_record {
+    std::atomic<uint64_t> epoch{0};       // 0 = not reading
+    std::atomic<bool> in_use{false};      // Claimed by a thread
+    std::atomic<bool> committing{false};  // Inside a speculative writer commit
+    std::atomic<void*> publication{nullptr};  // Pending combined write (tktrie_combine.h)
+    uint32_t depth = 0;                   // Nesting depth (owner thread only)
+    bool transient = false;               // Not cached: release on last exit
+    ebr_reader_record* next = nullptr;    // Registry link, immutable once pushed
+};
+
+// =============================================================================
+// EBR_REGISTRY - growable per-trie set of reader records
+// =============================================================================
+// Records are only appended while the registry lives. A thread claims one on
+// first use and releases it on thread exit or cache eviction, so the list is
+// bounded by the peak number of threads reading concurrently.
+
+class ebr_registry {
+    std::atomic<ebr_reader_record*> head_{nullptr};
+    uint64_t id_;
+
+    static uint64_t next_id() noexcept {
+        static std::atomic<uint64_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+public:
+    ebr_registry() noexcept : id_(next_id()) {}
+
+    ~ebr_registry() {
+        ebr_reader_record* r = head_.load(std::memory_order_acquire);
+        while (r) {
+            ebr_reader_record* next = r->next;
+            delete r;
+            r = next;
+        }
+    }
+
+    ebr_registry(const ebr_registry&) = delete;
+    ebr_registry& operator=(const ebr_registry&) = delete;
+
+    // Never reused, so a stale thread cache entry can't match a new registry
+    uint64_t id() const noexcept { return id_; }
+
+    ebr_reader_record* acquire() {
+        for (ebr_reader_record* r = head_.load(std::memory_order_acquire); r; r = r->next) {
+            bool expected = false;
+            if (!r->in_use.load(std::memory_order_relaxed) &&
+                r->in_use.compare_exchange_strong(expected, true,
+                    std::memory_order_acquire, std::memory_order_relaxed)) {
+                return r;
+            }
+        }
+        auto* r = new ebr_reader_record;
+        r->in_use.store(true, std::memory_order_relaxed);
+        r->next = head_.load(std::memory_order_relaxed);
+        while (!head_.compare_exchange_weak(r->next, r,
+                    std::memory_order_release, std::memory_order_relaxed)) {}
+        return r;
+    }
+
+    static void release(ebr_reader_record* r) noexcept {
+        r->transient = false;
+        r->in_use.store(false, std::memory_order_release);
+    }
+
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (ebr_reader_record* r = head_.load(std::memory_order_acquire); r; r = r->next) fn(r);
+    }
+
+    bool any_committing() const noexcept {
+        for (ebr_reader_record* r = head_.load(std::memory_order_acquire); r; r = r->next) {
+            if (r->committing.load(std::memory_order_seq_cst)) return true;
+        }
+        return false;
+    }
+
+    // Oldest epoch published by an active reader, or current if none
+    uint64_t min_epoch(uint64_t current) const noexcept {
+        uint64_t min_e = current;
+        for (ebr_reader_record* r = head_.load(std::memory_order_acquire); r; r = r->next) {
+            uint64_t e = r->epoch.load(std::memory_order_seq_cst);
+            if (e != 0 && e < min_e) min_e = e;
+        }
+        return min_e;
+    }
+};
+
+// =============================================================================
+// EBR_THREAD_CACHE - per-thread, direct-mapped registry id -> record
+// =============================================================================
+// Holding the registry by shared_ptr lets a thread outlive the trie and still
+// release its record safely on exit.
+
+class ebr_thread_cache {
+    struct entry {
+        uint64_t id = 0;
+        ebr_reader_record* rec = nullptr;
+        std::shared_ptr<ebr_registry> reg;
+    };
+
+    static constexpr size_t WAYS = 8;
+    std::array<entry, WAYS> entries_{};
+
+    ebr_reader_record* refill(entry& e, const std::shared_ptr<ebr_registry>& reg) {
+        if (e.rec && e.rec->depth != 0) {
+            // Slot holds a record mid-read on another trie: don't evict it
+            ebr_reader_record* r = reg->acquire();
+            r->transient = true;
+            return r;
+        }
+        if (e.rec) ebr_registry::release(e.rec);
+        e.rec = reg->acquire();
+        e.reg = reg;
+        e.id = reg->id();
+        return e.rec;
+    }
+
+public:
+    ~ebr_thread_cache() {
+        for (auto& e : entries_) {
+            if (e.rec) ebr_registry::release(e.rec);
+        }
+    }
+
+    ebr_reader_record* lookup(const std::shared_ptr<ebr_registry>& reg) {
+        entry& e = entries_[reg->id() % WAYS];
+        if (e.id == reg->id()) [[likely]] return e.rec;
+        return refill(e, reg);
+    }
+};
+
+inline ebr_thread_cache& ebr_local_cache() {
+    thread_local ebr_thread_cache cache;
+    return cache;
 }
 
+// =============================================================================
+// RECLAIM_POLICY - who frees retired nodes
+// =============================================================================
+
+enum class reclaim_policy : uint8_t {
+    INLINE,      // Writers, and readers past twice the threshold, reclaim as they go
+    BACKGROUND,  // A per-trie thread reclaims; callers only wake it
+    MANUAL,      // Nothing reclaims until the owner calls poll()
+};
+
+// =============================================================================
+// EBR_RECLAIMER - background thread running a reclaim callback
+// =============================================================================
+// Sleeps until kicked or PERIOD elapses. A kick racing the thread going to
+// sleep can be missed; the timed wait bounds how long that delays reclaiming.
+
+class ebr_reclaimer {
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::atomic<bool> kicked_{false};
+    bool stop_ = false;
+    std::thread thread_;  // Last: starts after the members it uses
+
+public:
+    static constexpr std::chrono::milliseconds PERIOD{10};
+
+    template <typename Fn>
+    explicit ebr_reclaimer(Fn fn) : thread_([this, fn]() mutable {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            cv_.wait_for(lock, PERIOD, [this] { return stop_ || kicked_.load(std::memory_order_relaxed); });
+            if (stop_) break;
+            kicked_.store(false, std::memory_order_relaxed);
+            lock.unlock();
+            fn();
+            lock.lock();
+        }
+    }) {}
+
+    ~ebr_reclaimer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+    }
+
+    ebr_reclaimer(const ebr_reclaimer&) = delete;
+    ebr_reclaimer& operator=(const ebr_reclaimer&) = delete;
+
+    // Only the first kick since the last pass pays for a notify
+    void kick() noexcept {
+        if (!kicked_.exchange(true, std::memory_order_relaxed)) cv_.notify_one();
+    }
+};
+
 }  // namespace gteitelbaum
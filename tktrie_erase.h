@@ -33,11 +33,10 @@ std::pair<bool, bool> TKTRIE_CLASS::erase_locked(std::string_view kb) {
         auto res = erase_impl(&root_, root_.load(), kb);
         return apply_erase_result(res);
     } else {
-        if (retired_count_.load(std::memory_order_relaxed) >= EBR_MIN_RETIRED) {
-            ebr_cleanup();
-        }
+        maybe_reclaim(EBR_MIN_RETIRED);
         
-        size_t slot = reader_enter();
+        value_retire_guard values(*this);
+        auto* rec = reader_enter();
         
         static constexpr int MAX_RETRIES = 7;
         
@@ -45,17 +44,31 @@ std::pair<bool, bool> TKTRIE_CLASS::erase_locked(std::string_view kb) {
             erase_spec_info info = probe_erase(root_.load(), kb);
 
             if (info.op == erase_op::NOT_FOUND) {
-                reader_exit(slot);
+                if (!validate_probe_path(info.path.data(), info.path_len, erase_spec_info::MAX_PATH)) continue;
+                reader_exit(rec);
                 return {false, false};
             }
 
+            // Unlinking would leave the parent empty or single-entry: it must
+            // collapse too, which only the locked path below handles
+            if ((info.op == erase_op::DELETE_SKIP_LEAF || info.op == erase_op::DELETE_LAST_LEAF_ENTRY) &&
+                info.path_len > 1) {
+                ptr_t parent = info.path[info.path_len - 2].node;
+                if (parent->child_count() + (parent->has_eos() ? 1 : 0) <= 2) break;
+            }
+
             if (info.op == erase_op::IN_PLACE_LEAF) {
-                std::lock_guard<mutex_t> lock(mutex_);
-                if (!validate_erase_path(info)) continue;
-                if (do_inplace_leaf_erase(info.target, info.c, info.target_version)) {
-                    epoch_.fetch_add(1, std::memory_order_release);
+                commit_section commit(*this, rec);
+                commit_locks locks;
+                if (!lock_erase_path(info, locks)) {
+                    locks.release();
+                    continue;
+                }
+                bool erased = do_inplace_leaf_erase(info.target, info.c);
+                locks.release();
+                if (erased) {
                     size_.fetch_sub(1);
-                    reader_exit(slot);
+                    reader_exit(rec);
                     return {true, false};
                 }
                 continue;
@@ -64,8 +77,11 @@ std::pair<bool, bool> TKTRIE_CLASS::erase_locked(std::string_view kb) {
             erase_pre_alloc alloc = allocate_erase_speculative(info);
             
             {
-                std::lock_guard<mutex_t> lock(mutex_);
-                if (!validate_erase_path(info)) {
+                // Commits on disjoint subtrees proceed in parallel
+                commit_section commit(*this, rec);
+                commit_locks locks;
+                if (!lock_erase_path(info, locks)) {
+                    locks.release();
                     dealloc_erase_speculation(alloc);
                     continue;
                 }
@@ -100,19 +116,21 @@ std::pair<bool, bool> TKTRIE_CLASS::erase_locked(std::string_view kb) {
                         retire_node(info.collapse_child);
                         retired_any = true;
                     }
+                    locks.release();
                     size_.fetch_sub(1);
-                    reader_exit(slot);
+                    reader_exit(rec);
                     return {true, retired_any};
                 }
+                locks.release();
                 dealloc_erase_speculation(alloc);
                 continue;
             }
         }
         
         {
-            std::lock_guard<mutex_t> lock(mutex_);
+            exclusive_lock lock(*this);
             auto res = erase_impl(&root_, root_.load(), kb);
-            reader_exit(slot);
+            reader_exit(rec);
             return apply_erase_result(res);
         }
     }
@@ -190,8 +208,9 @@ typename TKTRIE_CLASS::erase_result TKTRIE_CLASS::erase_from_interior(
             return res;
         } else {
             if (!n->has_eos()) return res;
-            n->bump_version();
+            bool began = n->begin_write();
             n->clear_eos();
+            if (began) n->end_write();
             res.erased = true;
             return try_collapse_interior(n);
         }
@@ -258,6 +277,16 @@ typename TKTRIE_CLASS::erase_result TKTRIE_CLASS::try_collapse_after_child_remov
 
     int total_remaining = remaining + eos_count;
 
+    // Fixed-length roots stay an empty-skip interior: inline_skip holds at
+    // most FIXED_LEN-1 bytes, so a merged or recreated root would truncate
+    if constexpr (FIXED_LEN > 0) {
+        if (n == root_.load()) {
+            using ops = trie_ops<T, THREADED, Allocator, FIXED_LEN>;
+            ops::remove_child_inplace(n, removed_c);
+            return res;
+        }
+    }
+
     if (total_remaining == 0) {
         res.deleted_subtree = true;
         res.old_nodes.push_back(n);
@@ -279,6 +308,8 @@ typename TKTRIE_CLASS::erase_result TKTRIE_CLASS::try_collapse_after_child_remov
         }
         return res;
     }
+    // BINARY at its floor refuses removal; drop the edge in place (EOS keeps n alive)
+    if (!helper_res.success) ops::remove_child_inplace(n, removed_c);
 
     if (!eos_exists && remaining == 1) {
         auto [c, child] = n->first_child_info();
@@ -301,7 +332,7 @@ typename TKTRIE_CLASS::erase_result TKTRIE_CLASS::collapse_single_child(
     ptr_t merged;
     if (child->is_leaf()) {
         if (child->is_skip()) {
-            T val{};
+            held_t val{};
             child->as_skip()->value.try_read(val);
             merged = builder_.make_leaf_skip(new_skip, val);
         } else {
@@ -321,3 +352,5 @@ typename TKTRIE_CLASS::erase_result TKTRIE_CLASS::collapse_single_child(
 #undef TKTRIE_CLASS
 
 }  // namespace gteitelbaum
+
+#include "tktrie_combine.h"
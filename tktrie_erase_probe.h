@@ -73,13 +73,15 @@ typename TKTRIE_CLASS::erase_spec_info TKTRIE_CLASS::probe_interior_erase(
         
         int child_cnt = n->child_count();
         if (child_cnt == 0) {
-            info.op = erase_op::NOT_FOUND;
+            // EOS-only interior: unlink it from its parent like a skip leaf
+            info.op = erase_op::DELETE_SKIP_LEAF;
             return info;
         }
         if (child_cnt == 1) {
             auto [c, child] = n->first_child_info();
             if (child && !builder_t::is_sentinel(child) && !child->is_poisoned()) {
                 info.collapse_child = child;
+                info.collapse_version = child->version();
                 info.collapse_char = c;
                 info.child_skip = std::string(child->skip_str());
             }
@@ -97,12 +99,17 @@ typename TKTRIE_CLASS::erase_spec_info TKTRIE_CLASS::probe_erase(
     ptr_t n, std::string_view key) const noexcept {
     erase_spec_info info;
 
-    if (!n || n->is_poisoned() || builder_t::is_sentinel(n)) {
+    if (!n) {
         info.op = erase_op::NOT_FOUND;
         return info;
     }
 
+    // Recorded before the poison check so a retired root fails validation
     info.path[info.path_len++] = {n, n->version(), 0};
+    if (n->is_poisoned()) {
+        info.op = erase_op::NOT_FOUND;
+        return info;
+    }
 
     while (!n->is_leaf()) {
         std::string_view skip = n->skip_str();
@@ -118,6 +125,10 @@ typename TKTRIE_CLASS::erase_spec_info TKTRIE_CLASS::probe_erase(
         ptr_t child = n->get_child(c);
         
         if (!child || builder_t::is_sentinel(child)) { 
+            // The sentinel is poisoned: recording it fails validation
+            if (child && info.path_len < erase_spec_info::MAX_PATH) {
+                info.path[info.path_len++] = {child, child->version(), c};
+            }
             info.op = erase_op::NOT_FOUND; 
             return info; 
         }
@@ -125,14 +136,14 @@ typename TKTRIE_CLASS::erase_spec_info TKTRIE_CLASS::probe_erase(
         key.remove_prefix(1);
         n = child;
         
+        if (info.path_len < erase_spec_info::MAX_PATH) {
+            info.path[info.path_len++] = {n, n->version(), c};
+        }
+        
         if (n->is_poisoned()) {
             info.op = erase_op::NOT_FOUND;
             return info;
         }
-        
-        if (info.path_len < erase_spec_info::MAX_PATH) {
-            info.path[info.path_len++] = {n, n->version(), c};
-        }
     }
 
     return probe_leaf_erase(n, key, info);
@@ -169,7 +180,7 @@ typename TKTRIE_CLASS::erase_pre_alloc TKTRIE_CLASS::allocate_erase_speculative(
         
         if (child->is_leaf()) {
             if (child->is_skip()) {
-                T val{};
+                held_t val{};
                 child->as_skip()->value.try_read(val);
                 merged = builder_.make_leaf_skip(new_skip, val);
             } else {
@@ -195,21 +206,29 @@ typename TKTRIE_CLASS::erase_pre_alloc TKTRIE_CLASS::allocate_erase_speculative(
     return alloc;
 }
 
+// Locks every node the commit edits, clones or retires, each at its probed
+// version: the target, the parent whose slot or entry is rewritten, and a
+// child being merged up. Edits confined to the target lock only the target.
+// The ancestors above are checked unchanged, as for inserts (see
+// lock_speculative_path).
 TKTRIE_TEMPLATE
-bool TKTRIE_CLASS::validate_erase_path(const erase_spec_info& info) const noexcept {
-    [[assume(info.path_len >= 0 && info.path_len <= 64)]];
-    for (int i = 0; i < info.path_len; ++i) {
-        if (info.path[i].node->is_poisoned()) return false;
-        if (info.path[i].node->version() != info.path[i].version) return false;
-    }
-    if (info.target && (info.path_len == 0 || info.path[info.path_len-1].node != info.target)) {
-        if (info.target->is_poisoned()) return false;
-        if (info.target->version() != info.target_version) return false;
-    }
-    if (info.collapse_child && info.collapse_child->is_poisoned()) {
-        return false;
+bool TKTRIE_CLASS::lock_erase_path(const erase_spec_info& info, commit_locks& locks) noexcept {
+    if (!info.target) return false;
+    bool target_only = info.op == erase_op::IN_PLACE_LEAF ||
+                       (info.op == erase_op::DELETE_EOS_INTERIOR && !info.collapse_child);
+    int held = 1;
+    if (!target_only) {
+        // A truncated path no longer ends at the target, so its parent is unknown
+        if (info.path_len == 0 || info.path[info.path_len - 1].node != info.target) return false;
+        if (info.path_len > 1) {
+            const path_entry& parent = info.path[info.path_len - 2];
+            if (!locks.lock(parent.node, parent.version)) return false;
+            held = 2;
+        }
     }
-    return true;
+    if (!locks.lock(info.target, info.target_version)) return false;
+    if (info.collapse_child && !locks.lock(info.collapse_child, info.collapse_version)) return false;
+    return validate_probe_path(info.path.data(), info.path_len, erase_spec_info::MAX_PATH, held);
 }
 
 TKTRIE_TEMPLATE
@@ -246,14 +265,12 @@ bool TKTRIE_CLASS::commit_erase_speculative(
     
     case erase_op::DELETE_CHILD_NO_COLLAPSE: {
         ptr_t parent = info.target;
-        if (parent->version() != info.target_version) return false;
         ops::remove_child_inplace(parent, info.c);
         return true;
     }
     
     case erase_op::DELETE_EOS_INTERIOR: {
         ptr_t target = info.target;
-        if (target->version() != info.target_version) return false;
         
         if (alloc.replacement) {
             if (!slot || slot->load() != target) return false;
@@ -269,8 +286,9 @@ bool TKTRIE_CLASS::commit_erase_speculative(
             }
             slot->store(alloc.replacement);
         } else {
-            target->bump_version();
+            bool began = target->begin_write();
             target->clear_eos();
+            if (began) target->end_write();
         }
         return true;
     }
@@ -332,8 +350,7 @@ void TKTRIE_CLASS::dealloc_erase_speculation(erase_pre_alloc& alloc) {
 }
 
 TKTRIE_TEMPLATE
-bool TKTRIE_CLASS::do_inplace_leaf_erase(ptr_t leaf, unsigned char c, uint64_t expected_version) {
-    if (leaf->version() != expected_version) return false;
+bool TKTRIE_CLASS::do_inplace_leaf_erase(ptr_t leaf, unsigned char c) {
     if (!leaf->has_leaf_entry(c)) return false;
     using ops = trie_ops<T, THREADED, Allocator, FIXED_LEN>;
     return ops::remove_leaf_inplace(leaf, c);
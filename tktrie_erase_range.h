@@ -0,0 +1,229 @@
+#pragma once
+
+// This file contains the prefix and range erases
+// It should only be included from tktrie_bulk.h
+
+namespace gteitelbaum {
+
+#define TKTRIE_TEMPLATE template <typename Key, typename T, bool THREADED, typename Allocator>
+#define TKTRIE_CLASS tktrie<Key, T, THREADED, Allocator>
+
+// -----------------------------------------------------------------------------
+// Range erase
+// -----------------------------------------------------------------------------
+// The keys under a node are exactly those starting with its path (the bytes
+// above it plus its skip), so a node whose path lies wholly inside [lo, hi)
+// is unlinked from its parent as one subtree, without visiting its keys one
+// by one. Only the nodes along the two boundary paths are partly erased;
+// each is reshaped once, to the type its remaining entries need, or
+// collapsed. The whole erase is one writer critical section with one epoch
+// bump, and every detached node goes onto the retired list in one CAS, to be
+// freed lazily by reclamation like any other retired node.
+
+// Keys starting with p: none, some or all of them inside b
+TKTRIE_TEMPLATE
+typename TKTRIE_CLASS::range_cover TKTRIE_CLASS::cover_of(std::string_view p, const erase_bounds& b) noexcept {
+    if (p < b.lo && !b.lo.starts_with(p)) return range_cover::NONE;
+    if (!b.open && p >= b.hi) return range_cover::NONE;
+    if (p >= b.lo && (b.open || !b.hi.starts_with(p))) return range_cover::ALL;
+    return range_cover::SOME;
+}
+
+// Queues n and everything below it; returns how many keys they held
+TKTRIE_TEMPLATE
+size_t TKTRIE_CLASS::retire_subtree(ptr_t n, std::vector<ptr_t>& retired) {
+    retired.push_back(n);
+    if (n->is_skip()) return 1;
+    if (n->is_leaf()) return static_cast<size_t>(n->leaf_entry_count());
+    size_t keys = n->has_eos() ? 1 : 0;
+    for (int c = n->next_entry_char(-1); c >= 0; c = n->next_entry_char(c)) {
+        keys += retire_subtree(n->get_child(static_cast<unsigned char>(c)), retired);
+    }
+    return keys;
+}
+
+// Erases b's keys from the subtree n, whose path above its skip is acc.
+// Sets deleted_subtree if nothing is left, or new_node if n was replaced;
+// every node unlinked, including n, is queued on retired.
+TKTRIE_TEMPLATE
+typename TKTRIE_CLASS::erase_result TKTRIE_CLASS::erase_range_impl(
+    ptr_t n, std::string& acc, const erase_bounds& b, std::vector<ptr_t>& retired, size_t& erased) {
+    erase_result res;
+    size_t depth = acc.size();
+    acc.append(n->skip_str());
+    range_cover cover = n->is_skip() ? (b.contains(acc) ? range_cover::ALL : range_cover::NONE) : cover_of(acc, b);
+    if (cover != range_cover::SOME) {
+        if (cover == range_cover::ALL) {
+            erased += retire_subtree(n, retired);
+            res.erased = true;
+            res.deleted_subtree = true;
+        }
+        acc.resize(depth);
+        return res;
+    }
+
+    std::bitset<256> gone;
+    int left = 0;
+    bool leaf = n->is_leaf();
+    for (int c = n->next_entry_char(-1); c >= 0; c = n->next_entry_char(c)) {
+        unsigned char uc = static_cast<unsigned char>(c);
+        acc.push_back(static_cast<char>(uc));
+        if (leaf) {
+            if (b.contains(acc)) gone.set(uc);
+        } else {
+            ptr_t child = n->get_child(uc);
+            auto child_res = erase_range_impl(child, acc, b, retired, erased);
+            if (child_res.deleted_subtree) {
+                gone.set(uc);
+            } else if (child_res.new_node) {
+                atomic_ptr* slot = n->get_child_slot(uc);
+                n->bump_version();
+                if constexpr (THREADED) slot->store(get_retry_sentinel<T, THREADED, Allocator, FIXED_LEN>());
+                slot->store(child_res.new_node);
+            }
+        }
+        acc.pop_back();
+        left += !gone.test(uc);
+    }
+
+    bool eos = false;
+    if constexpr (FIXED_LEN == 0) {
+        eos = n->has_eos();
+        if (eos && b.contains(acc)) {
+            bool began = n->begin_write();
+            n->clear_eos();
+            if (began) n->end_write();
+            ++erased;
+            eos = false;
+        }
+    }
+    if (leaf) erased += gone.count();
+    res.erased = true;
+
+    // Fixed-length roots stay an empty-skip interior (see try_collapse_after_child_removal)
+    bool pinned_root = FIXED_LEN > 0 && depth == 0 && !leaf;
+    if (left + eos == 0 && !pinned_root) {
+        retired.push_back(n);
+        res.deleted_subtree = true;
+    } else if (leaf && left == 1) {
+        // A lone leaf entry becomes a SKIP leaf, as binary_to_skip does
+        int c = n->next_entry_char(-1);
+        while (gone.test(static_cast<unsigned char>(c))) c = n->next_entry_char(c);
+        held_t value{};
+        n->try_read_leaf_value(static_cast<unsigned char>(c), value);
+        acc.push_back(static_cast<char>(c));
+        res.new_node = builder_.make_leaf_skip(std::string_view(acc).substr(depth), value);
+        acc.pop_back();
+        retired.push_back(n);
+    } else if (!leaf && left == 1 && !eos && !pinned_root) {
+        int c = n->next_entry_char(-1);
+        while (gone.test(static_cast<unsigned char>(c))) c = n->next_entry_char(c);
+        unsigned char uc = static_cast<unsigned char>(c);
+        erase_result none;
+        erase_result merged = collapse_single_child(n, uc, n->get_child(uc), none);
+        res.new_node = merged.new_node;
+        for (auto* old : merged.old_nodes) retired.push_back(old);
+    } else if (gone.any()) {
+        // In place while the type's floor holds (as remove_entry_typed), else rebuilt once
+        int floor = n->is_binary() ? 0 : n->is_list() ? LIST_MIN : n->is_pop() ? POP_MIN : FULL_MIN;
+        if (left >= floor || pinned_root) {
+            using ops = trie_ops<T, THREADED, Allocator, FIXED_LEN>;
+            for (int c = n->next_entry_char(-1); c >= 0; c = n->next_entry_char(c)) {
+                if (!gone.test(static_cast<unsigned char>(c))) continue;
+                if (leaf) ops::remove_leaf_inplace(n, static_cast<unsigned char>(c));
+                else ops::remove_child_inplace(n, static_cast<unsigned char>(c));
+            }
+        } else {
+            res.new_node = leaf ? erase_range_rebuild<true>(n, left, gone) : erase_range_rebuild<false>(n, left, gone);
+            retired.push_back(n);
+        }
+    }
+    acc.resize(depth);
+    return res;
+}
+
+// n without its gone entries, in the node type count of them needs
+TKTRIE_TEMPLATE
+template <bool IS_LEAF>
+typename TKTRIE_CLASS::ptr_t TKTRIE_CLASS::erase_range_rebuild(ptr_t n, int count, const std::bitset<256>& gone) {
+    ptr_t rebuilt = bulk_node<IS_LEAF>(n->skip_str(), count, [&](auto* dst) {
+        for (int c = n->next_entry_char(-1); c >= 0; c = n->next_entry_char(c)) {
+            unsigned char uc = static_cast<unsigned char>(c);
+            if (gone.test(uc)) continue;
+            if constexpr (IS_LEAF) {
+                held_t value{};
+                n->try_read_leaf_value(uc, value);
+                dst->add_entry(uc, value);
+            } else {
+                dst->add_entry(uc, n->get_child(uc));
+            }
+        }
+    });
+    if constexpr (!IS_LEAF) {
+        batch_typed<false>(n, [&](auto* src) { trie_ops<T, THREADED, Allocator, FIXED_LEN>::copy_eos_to(src, rebuilt); });
+    }
+    return rebuilt;
+}
+
+TKTRIE_TEMPLATE
+size_t TKTRIE_CLASS::erase_bounded(const erase_bounds& b) {
+    std::vector<ptr_t> retired;
+    size_t erased = 0;
+    auto apply = [&]() {
+        ptr_t root = root_.load();
+        if (!root) return;
+        std::string acc;
+        auto res = erase_range_impl(root, acc, b, retired, erased);
+        if (res.deleted_subtree) {
+            if constexpr (THREADED) root_.store(get_retry_sentinel<T, THREADED, Allocator, FIXED_LEN>());
+            root_.store(nullptr);
+        } else if (res.new_node) {
+            if constexpr (THREADED) root_.store(get_retry_sentinel<T, THREADED, Allocator, FIXED_LEN>());
+            root_.store(res.new_node);
+        }
+        size_.fetch_sub(erased);
+        if constexpr (THREADED) {
+            if (erased) epoch_.fetch_add(1, std::memory_order_release);
+        }
+        ebr_retire_batch(retired);
+    };
+    if constexpr (THREADED) {
+        {
+            exclusive_lock lock(*this);
+            value_retire_guard values(*this);
+            apply();
+        }
+        maybe_reclaim(EBR_MIN_RETIRED);
+    } else {
+        std::lock_guard<mutex_t> lock(mutex_);
+        apply();
+    }
+    return erased;
+}
+
+TKTRIE_TEMPLATE
+size_t TKTRIE_CLASS::erase_prefix(std::string_view prefix) requires (FIXED_LEN == 0) {
+    std::string succ;
+    bool bounded = prefix_successor(prefix, succ);
+    return erase_bounded({prefix, succ, !bounded});
+}
+
+TKTRIE_TEMPLATE
+size_t TKTRIE_CLASS::erase_range(const Key& lo, const Key& hi) {
+    auto lo_kb = traits::to_bytes(lo);
+    auto hi_kb = traits::to_bytes(hi);
+    return erase_range_bytes(std::string_view(lo_kb.data(), lo_kb.size()), std::string_view(hi_kb.data(), hi_kb.size()));
+}
+
+TKTRIE_TEMPLATE
+size_t TKTRIE_CLASS::erase_range_bytes(std::string_view lo_v, std::string_view hi_v) {
+    if (!(lo_v < hi_v)) return 0;
+    return erase_bounded({lo_v, hi_v, false});
+}
+
+#undef TKTRIE_TEMPLATE
+#undef TKTRIE_CLASS
+
+}  // namespace gteitelbaum
+
+#include "tktrie_serialize.h"
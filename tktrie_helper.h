@@ -20,14 +20,15 @@ constexpr int node_max_count() {
         return 256;
 }
 
-template <typename T, typename PtrT, bool IS_LEAF>
-using entry_t = std::conditional_t<IS_LEAF, const T&, PtrT>;
+template <typename T, bool THREADED, typename Allocator, typename PtrT, bool IS_LEAF>
+using entry_t = std::conditional_t<IS_LEAF, const value_source<T, THREADED, Allocator>&, PtrT>;
 
 template <typename T, bool THREADED, typename Allocator, size_t FIXED_LEN>
 struct trie_ops {
     using base_t = node_base<T, THREADED, Allocator, FIXED_LEN>;
     using ptr_t = base_t*;
     using builder_t = node_builder<T, THREADED, Allocator, FIXED_LEN>;
+    using held_t = typename dataptr<T, THREADED, Allocator>::held_t;
     
     struct result {
         ptr_t new_node = nullptr;
@@ -39,7 +40,7 @@ struct trie_ops {
     template <typename SrcNode>
     static void copy_eos_to(SrcNode* src, ptr_t dst_base) {
         if constexpr (FIXED_LEN == 0) {
-            T eos_val;
+            held_t eos_val;
             if (src->eos().try_read(eos_val)) {
                 if (dst_base->is_binary()) {
                     dst_base->template as_binary<false>()->eos().set(eos_val);
@@ -90,7 +91,7 @@ struct trie_ops {
             for (int i = 0; i < cnt; ++i) {
                 unsigned char c = src->char_at(i);
                 if constexpr (IS_LEAF) {
-                    T val{};
+                    held_t val{};
                     src->value_at(i).try_read(val);
                     dst->add_entry(c, val);
                 } else {
@@ -101,7 +102,7 @@ struct trie_ops {
             int slot = 0;
             src->valid().for_each_set([&](unsigned char c) {
                 if constexpr (IS_LEAF) {
-                    T val{};
+                    held_t val{};
                     if constexpr (MAX == POP_MAX) {
                         src->element_at_slot(slot).try_read(val);
                     } else {
@@ -130,7 +131,7 @@ struct trie_ops {
                 unsigned char c = src->char_at(i);
                 if (c == skip_c) continue;
                 if constexpr (IS_LEAF) {
-                    T val{};
+                    held_t val{};
                     src->value_at(i).try_read(val);
                     dst->add_entry(c, val);
                 } else {
@@ -142,7 +143,7 @@ struct trie_ops {
             src->valid().for_each_set([&](unsigned char c) {
                 if (c != skip_c) {
                     if constexpr (IS_LEAF) {
-                        T val{};
+                        held_t val{};
                         if constexpr (MAX == POP_MAX) {
                             src->element_at_slot(slot).try_read(val);
                         } else {
@@ -165,7 +166,7 @@ struct trie_ops {
     template <bool SPECULATIVE, bool IS_LEAF, typename SrcNode, typename Alloc = void>
     static result upgrade(
         ptr_t src_base, SrcNode* src, unsigned char c,
-        entry_t<T, ptr_t, IS_LEAF> entry,
+        entry_t<T, THREADED, Allocator, ptr_t, IS_LEAF> entry,
         builder_t& builder, [[maybe_unused]] Alloc* alloc = nullptr)
     {
         result res;
@@ -209,7 +210,7 @@ struct trie_ops {
     template <bool SPECULATIVE, bool IS_LEAF, typename Alloc = void>
     static result upgrade(
         ptr_t node, unsigned char c,
-        entry_t<T, ptr_t, IS_LEAF> entry,
+        entry_t<T, THREADED, Allocator, ptr_t, IS_LEAF> entry,
         builder_t& builder, [[maybe_unused]] Alloc* alloc = nullptr)
     {
         uint64_t h = node->header();
@@ -233,7 +234,7 @@ struct trie_ops {
     template <bool SPECULATIVE, bool IS_LEAF, typename Alloc = void>
     static result add_entry(
         ptr_t node, unsigned char c,
-        entry_t<T, ptr_t, IS_LEAF> entry,
+        entry_t<T, THREADED, Allocator, ptr_t, IS_LEAF> entry,
         builder_t& builder, [[maybe_unused]] Alloc* alloc = nullptr)
     {
         uint64_t h = node->header();
@@ -256,7 +257,7 @@ struct trie_ops {
     template <bool SPECULATIVE, bool IS_LEAF, typename Node, typename Alloc>
     static result add_entry_typed(
         ptr_t node_base, Node* node, unsigned char c,
-        entry_t<T, ptr_t, IS_LEAF> entry,
+        entry_t<T, THREADED, Allocator, ptr_t, IS_LEAF> entry,
         builder_t& builder, [[maybe_unused]] Alloc* alloc)
     {
         result res;
@@ -266,9 +267,10 @@ struct trie_ops {
         constexpr int MAX = node_max_count<Node>();
         
         if (node->count() < MAX) {
-            node_base->bump_version();
+            bool began = node_base->begin_write();
             node->add_entry(c, entry);
             node->update_capacity_flags();
+            if (began) node_base->end_write();
             res.in_place = true;
             res.success = true;
             return res;
@@ -362,9 +364,10 @@ struct trie_ops {
             return downgrade<SPECULATIVE, IS_LEAF>(node_base, node, c, builder, alloc);
         }
         
-        node_base->bump_version();
+        bool began = node_base->begin_write();
         node->remove_entry(c);
         node->update_capacity_flags();
+        if (began) node_base->end_write();
         res.in_place = true;
         res.success = true;
         return res;
@@ -376,32 +379,36 @@ struct trie_ops {
         if (h & FLAG_BINARY) {
             auto* bn = node->template as_binary<true>();
             if (!bn->has(c)) return false;
-            node->bump_version();
+            bool began = node->begin_write();
             bn->remove_entry(c);
             bn->update_capacity_flags();
+            if (began) node->end_write();
             return true;
         }
         if (h & FLAG_LIST) [[likely]] {
             auto* ln = node->template as_list<true>();
             if (!ln->has(c)) return false;
-            node->bump_version();
+            bool began = node->begin_write();
             ln->remove_entry(c);
             ln->update_capacity_flags();
+            if (began) node->end_write();
             return true;
         }
         if (h & FLAG_POP) {
             auto* pn = node->template as_pop<true>();
             if (!pn->has(c)) return false;
-            node->bump_version();
+            bool began = node->begin_write();
             pn->remove_entry(c);
             pn->update_capacity_flags();
+            if (began) node->end_write();
             return true;
         }
         auto* fn = node->template as_full<true>();
         if (!fn->has(c)) return false;
-        node->bump_version();
+        bool began = node->begin_write();
         fn->remove_entry(c);
         fn->update_capacity_flags();
+        if (began) node->end_write();
         return true;
     }
     
@@ -411,32 +418,36 @@ struct trie_ops {
         if (h & FLAG_BINARY) {
             auto* bn = node->template as_binary<false>();
             if (!bn->has(c)) return false;
-            node->bump_version();
+            bool began = node->begin_write();
             bn->remove_entry(c);
             bn->update_capacity_flags();
+            if (began) node->end_write();
             return true;
         }
         if (h & FLAG_LIST) [[likely]] {
             auto* ln = node->template as_list<false>();
             if (!ln->has(c)) return false;
-            node->bump_version();
+            bool began = node->begin_write();
             ln->remove_entry(c);
             ln->update_capacity_flags();
+            if (began) node->end_write();
             return true;
         }
         if (h & FLAG_POP) {
             auto* pn = node->template as_pop<false>();
             if (!pn->has(c)) return false;
-            node->bump_version();
+            bool began = node->begin_write();
             pn->remove_entry(c);
             pn->update_capacity_flags();
+            if (began) node->end_write();
             return true;
         }
         auto* fn = node->template as_full<false>();
         if (!fn->has(c)) return false;
-        node->bump_version();
+        bool began = node->begin_write();
         fn->remove_entry(c);
         fn->update_capacity_flags();
+        if (began) node->end_write();
         return true;
     }
     
@@ -453,7 +464,7 @@ struct trie_ops {
         
         int other_idx = 1 - idx;
         unsigned char other_c = bn->char_at(other_idx);
-        T other_val{};
+        held_t other_val{};
         bn->value_at(other_idx).try_read(other_val);
         
         std::string new_skip(leaf->skip_str());
@@ -498,23 +509,25 @@ struct trie_ops {
         return n;
     }
     
+    // Copies rather than moves: the source stays reachable until its
+    // replacement is published, and speculative clones may be discarded
     static ptr_t clone_interior_with_skip(ptr_t node, std::string_view new_skip, builder_t& builder) {
         bool had_eos = node->has_eos();
         
         if (node->is_binary()) [[likely]] {
             ptr_t clone = builder.make_interior_binary(new_skip);
             if constexpr (FIXED_LEN == 0) {
-                node->template as_binary<false>()->move_interior_to(clone->template as_binary<false>());
+                node->template as_binary<false>()->copy_interior_to(clone->template as_binary<false>());
                 if (had_eos) clone->set_eos_flag();
             } else {
-                node->template as_binary<false>()->move_children_to(clone->template as_binary<false>());
+                node->template as_binary<false>()->copy_children_to(clone->template as_binary<false>());
             }
             clone->template as_binary<false>()->update_capacity_flags();
             return clone;
         }
         if (node->is_list()) {
             ptr_t clone = builder.make_interior_list(new_skip);
-            node->template as_list<false>()->move_interior_to(clone->template as_list<false>());
+            node->template as_list<false>()->copy_interior_to(clone->template as_list<false>());
             if constexpr (FIXED_LEN == 0) {
                 if (had_eos) clone->set_eos_flag();
             }
@@ -524,16 +537,16 @@ struct trie_ops {
         if (node->is_pop()) {
             ptr_t clone = builder.make_interior_pop(new_skip);
             if constexpr (FIXED_LEN == 0) {
-                node->template as_pop<false>()->move_interior_to(clone->template as_pop<false>());
+                node->template as_pop<false>()->copy_interior_to(clone->template as_pop<false>());
                 if (had_eos) clone->set_eos_flag();
             } else {
-                node->template as_pop<false>()->move_children_to(clone->template as_pop<false>());
+                node->template as_pop<false>()->copy_children_to(clone->template as_pop<false>());
             }
             clone->template as_pop<false>()->update_capacity_flags();
             return clone;
         }
         ptr_t clone = builder.make_interior_full(new_skip);
-        node->template as_full<false>()->move_interior_to(clone->template as_full<false>());
+        node->template as_full<false>()->copy_interior_to(clone->template as_full<false>());
         if constexpr (FIXED_LEN == 0) {
             if (had_eos) clone->set_eos_flag();
         }
@@ -559,7 +572,7 @@ struct trie_ops {
             interior = builder.make_interior_full(leaf_skip);
         }
         
-        leaf->for_each_leaf_entry([&builder, &interior](unsigned char c, const T& val) {
+        leaf->for_each_leaf_entry([&builder, &interior](unsigned char c, const held_t& val) {
             ptr_t child = builder.make_leaf_skip("", val);
             add_entry_to_interior(interior, c, child);
         });
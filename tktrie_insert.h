@@ -16,7 +16,7 @@ namespace gteitelbaum {
 
 TKTRIE_TEMPLATE
 typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::insert_impl(
-    atomic_ptr* slot, ptr_t n, std::string_view key, const T& value) {
+    atomic_ptr* slot, ptr_t n, std::string_view key, const source_t& value) {
     insert_result res;
 
     if (!n || n->is_poisoned() || builder_t::is_sentinel(n)) {
@@ -31,7 +31,7 @@ typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::insert_impl(
 
 TKTRIE_TEMPLATE
 typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::insert_into_leaf(
-    atomic_ptr*, ptr_t leaf, std::string_view key, const T& value) {
+    atomic_ptr*, ptr_t leaf, std::string_view key, const source_t& value) {
     insert_result res;
     std::string_view leaf_skip = leaf->skip_str();
 
@@ -58,7 +58,7 @@ typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::insert_into_leaf(
 
 TKTRIE_TEMPLATE
 typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::insert_into_interior(
-    atomic_ptr*, ptr_t n, std::string_view key, const T& value) {
+    atomic_ptr*, ptr_t n, std::string_view key, const source_t& value) {
     insert_result res;
     std::string_view skip = n->skip_str();
 
@@ -77,6 +77,7 @@ typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::insert_into_interior(
         atomic_ptr* child_slot = n->get_child_slot(c);
         auto child_res = insert_impl(child_slot, child, key, value);
         if (child_res.new_node && child_res.new_node != child) {
+            n->bump_version();
             if constexpr (THREADED) {
                 child_slot->store(get_retry_sentinel<T, THREADED, Allocator, FIXED_LEN>());
             }
@@ -92,13 +93,13 @@ typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::insert_into_interior(
 }
 
 TKTRIE_TEMPLATE
-typename TKTRIE_CLASS::ptr_t TKTRIE_CLASS::create_leaf_for_key(std::string_view key, const T& value) {
+typename TKTRIE_CLASS::ptr_t TKTRIE_CLASS::create_leaf_for_key(std::string_view key, const source_t& value) {
     return builder_.make_leaf_skip(key, value);
 }
 
 TKTRIE_TEMPLATE
 typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::split_leaf_skip(
-    ptr_t leaf, std::string_view key, const T& value, size_t m) {
+    ptr_t leaf, std::string_view key, const source_t& value, size_t m) {
     insert_result res;
     std::string_view old_skip = leaf->skip_str();
 
@@ -108,7 +109,7 @@ typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::split_leaf_skip(
 
     if (old_skip.size() == m + 1 && key.size() == m + 1) {
         ptr_t binary = builder_.make_leaf_binary(common);
-        T old_value;
+        held_t old_value;
         leaf->as_skip()->value.try_read(old_value);
         binary->template as_binary<true>()->add_entry(old_c, old_value);
         binary->template as_binary<true>()->add_entry(new_c, value);
@@ -120,7 +121,7 @@ typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::split_leaf_skip(
     }
 
     ptr_t interior = builder_.make_interior_binary(common);
-    T old_value;
+    held_t old_value;
     leaf->as_skip()->value.try_read(old_value);
     ptr_t old_child = builder_.make_leaf_skip(old_skip.substr(m + 1), old_value);
     ptr_t new_child = create_leaf_for_key(key.substr(m + 1), value);
@@ -136,11 +137,11 @@ typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::split_leaf_skip(
 
 TKTRIE_TEMPLATE
 typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::prefix_leaf_skip(
-    ptr_t leaf, std::string_view key, const T& value, size_t m) {
+    ptr_t leaf, std::string_view key, const source_t& value, size_t m) {
     insert_result res;
     std::string_view old_skip = leaf->skip_str();
 
-    T old_value;
+    held_t old_value;
     leaf->as_skip()->value.try_read(old_value);
     ptr_t child = builder_.make_leaf_skip(old_skip.substr(m + 1), old_value);
 
@@ -159,13 +160,13 @@ typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::prefix_leaf_skip(
 
 TKTRIE_TEMPLATE
 typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::extend_leaf_skip(
-    ptr_t leaf, std::string_view key, const T& value, size_t m) {
+    ptr_t leaf, std::string_view key, const source_t& value, size_t m) {
     insert_result res;
     std::string_view old_skip = leaf->skip_str();
 
     ptr_t interior = builder_.make_interior_binary(std::string(old_skip));
     if constexpr (FIXED_LEN == 0) {
-        T old_value;
+        held_t old_value;
         leaf->as_skip()->value.try_read(old_value);
         interior->set_eos(old_value);
     }
@@ -182,7 +183,7 @@ typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::extend_leaf_skip(
 
 TKTRIE_TEMPLATE
 typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::split_leaf_multi(
-    ptr_t leaf, std::string_view key, const T& value, size_t m) {
+    ptr_t leaf, std::string_view key, const source_t& value, size_t m) {
     insert_result res;
     std::string_view old_skip = leaf->skip_str();
 
@@ -205,7 +206,7 @@ typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::split_leaf_multi(
 
 TKTRIE_TEMPLATE
 typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::prefix_leaf_multi(
-    ptr_t leaf, std::string_view key, const T& value, size_t m) {
+    ptr_t leaf, std::string_view key, const source_t& value, size_t m) {
     insert_result res;
     std::string_view old_skip = leaf->skip_str();
 
@@ -231,7 +232,7 @@ typename TKTRIE_CLASS::ptr_t TKTRIE_CLASS::clone_leaf_with_skip(ptr_t leaf, std:
 }
 
 TKTRIE_TEMPLATE
-typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::add_eos_to_leaf_multi(ptr_t leaf, const T& value) {
+typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::add_eos_to_leaf_multi(ptr_t leaf, const source_t& value) {
     insert_result res;
     
     if constexpr (FIXED_LEN > 0) {
@@ -251,7 +252,7 @@ typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::add_eos_to_leaf_multi(ptr_t l
 
 TKTRIE_TEMPLATE
 typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::add_char_to_leaf(
-    ptr_t leaf, unsigned char c, const T& value) {
+    ptr_t leaf, unsigned char c, const source_t& value) {
     using ops = trie_ops<T, THREADED, Allocator, FIXED_LEN>;
     auto helper_res = ops::template add_entry<false, true>(leaf, c, value, builder_, static_cast<void*>(nullptr));
     
@@ -265,7 +266,7 @@ typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::add_char_to_leaf(
 
 TKTRIE_TEMPLATE
 typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::demote_leaf_multi(
-    ptr_t leaf, std::string_view key, const T& value) {
+    ptr_t leaf, std::string_view key, const source_t& value) {
     insert_result res;
     unsigned char first_c = static_cast<unsigned char>(key[0]);
     bool existing = leaf->has_leaf_entry(first_c);
@@ -296,7 +297,7 @@ typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::demote_leaf_multi(
 
 TKTRIE_TEMPLATE
 typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::split_interior(
-    ptr_t n, std::string_view key, const T& value, size_t m) {
+    ptr_t n, std::string_view key, const source_t& value, size_t m) {
     insert_result res;
     std::string_view old_skip = n->skip_str();
 
@@ -325,7 +326,7 @@ typename TKTRIE_CLASS::ptr_t TKTRIE_CLASS::clone_interior_with_skip(ptr_t n, std
 
 TKTRIE_TEMPLATE
 typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::prefix_interior(
-    ptr_t n, std::string_view key, const T& value, size_t m) {
+    ptr_t n, std::string_view key, const source_t& value, size_t m) {
     insert_result res;
     std::string_view old_skip = n->skip_str();
 
@@ -345,15 +346,16 @@ typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::prefix_interior(
 }
 
 TKTRIE_TEMPLATE
-typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::set_interior_eos(ptr_t n, const T& value) {
+typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::set_interior_eos(ptr_t n, const source_t& value) {
     insert_result res;
     
     if constexpr (FIXED_LEN > 0) {
         return res;
     } else {
         if (n->has_eos()) return res;
-        n->bump_version();
+        bool began = n->begin_write();
         n->set_eos(value);
+        if (began) n->end_write();
         res.in_place = true;
         res.inserted = true;
         return res;
@@ -362,7 +364,7 @@ typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::set_interior_eos(ptr_t n, con
 
 TKTRIE_TEMPLATE
 typename TKTRIE_CLASS::insert_result TKTRIE_CLASS::add_child_to_interior(
-    ptr_t n, unsigned char c, std::string_view remaining, const T& value) {
+    ptr_t n, unsigned char c, std::string_view remaining, const source_t& value) {
     using ops = trie_ops<T, THREADED, Allocator, FIXED_LEN>;
     ptr_t child = create_leaf_for_key(remaining, value);
     auto helper_res = ops::template add_entry<false, false>(n, c, child, builder_, static_cast<void*>(nullptr));
@@ -165,7 +165,7 @@ typename TKTRIE_CLASS::speculative_info TKTRIE_CLASS::probe_speculative(
 
 TKTRIE_TEMPLATE
 typename TKTRIE_CLASS::pre_alloc TKTRIE_CLASS::allocate_speculative(
-    const speculative_info& info, const T& value) {
+    const speculative_info& info, const source_t& value) {
     pre_alloc alloc;
     std::string_view key = info.remaining_key;
     std::string_view skip = info.target_skip;
@@ -181,7 +181,7 @@ typename TKTRIE_CLASS::pre_alloc TKTRIE_CLASS::allocate_speculative(
         break;
     }
     case spec_op::SPLIT_LEAF_SKIP: {
-        T old_value{};
+        held_t old_value{};
         info.target->as_skip()->value.try_read(old_value);
         
         std::string common(skip.substr(0, m));
@@ -206,7 +206,7 @@ typename TKTRIE_CLASS::pre_alloc TKTRIE_CLASS::allocate_speculative(
         break;
     }
     case spec_op::PREFIX_LEAF_SKIP: {
-        T old_value{};
+        held_t old_value{};
         info.target->as_skip()->value.try_read(old_value);
         
         unsigned char old_c = static_cast<unsigned char>(skip[m]);
@@ -228,7 +228,7 @@ typename TKTRIE_CLASS::pre_alloc TKTRIE_CLASS::allocate_speculative(
         break;
     }
     case spec_op::EXTEND_LEAF_SKIP: {
-        T old_value{};
+        held_t old_value{};
         info.target->as_skip()->value.try_read(old_value);
         
         unsigned char new_c = static_cast<unsigned char>(key[m]);
@@ -362,16 +362,26 @@ typename TKTRIE_CLASS::pre_alloc TKTRIE_CLASS::allocate_speculative(
     return alloc;
 }
 
+// Locks the parent whose slot is rewritten and the node being replaced, each
+// at its probed version; an in-place edit locks only the target. Ancestors
+// above those are not locked: replacing one clones the parent's pointer, and
+// collapsing one locks the parent itself. They must still be at their probed
+// versions, though, or the probe may have followed a pointer torn by an
+// in-place edit to a node that is not on this key's path.
 TKTRIE_TEMPLATE
-bool TKTRIE_CLASS::validate_path(const speculative_info& info) const noexcept {
-    [[assume(info.path_len >= 0 && info.path_len <= 64)]];
-    for (int i = 0; i < info.path_len; ++i) {
-        if (info.path[i].node->version() != info.path[i].version) return false;
+bool TKTRIE_CLASS::lock_speculative_path(const speculative_info& info, commit_locks& locks) noexcept {
+    if (!info.target) return true;
+    // A truncated path no longer ends at the target, so its parent is unknown
+    if (info.path_len == 0 || info.path[info.path_len - 1].node != info.target) return false;
+    bool target_only = info.op == spec_op::IN_PLACE_LEAF || info.op == spec_op::IN_PLACE_INTERIOR;
+    int held = 1;
+    if (!target_only && info.path_len > 1) {
+        const path_entry& parent = info.path[info.path_len - 2];
+        if (!locks.lock(parent.node, parent.version)) return false;
+        held = 2;
     }
-    if (info.target && (info.path_len == 0 || info.path[info.path_len-1].node != info.target)) {
-        if (info.target->version() != info.target_version) return false;
-    }
-    return true;
+    if (!locks.lock(info.target, info.target_version)) return false;
+    return validate_probe_path(info.path.data(), info.path_len, speculative_info::MAX_PATH, held);
 }
 
 TKTRIE_TEMPLATE
@@ -402,17 +412,19 @@ void TKTRIE_CLASS::commit_to_slot(atomic_ptr* slot, ptr_t new_node,
 
 TKTRIE_TEMPLATE
 bool TKTRIE_CLASS::commit_speculative(
-    speculative_info& info, pre_alloc& alloc, [[maybe_unused]] const T& value) {
+    speculative_info& info, pre_alloc& alloc, [[maybe_unused]] const source_t& value) {
     
     switch (info.op) {
-    case spec_op::EMPTY_TREE:
+    case spec_op::EMPTY_TREE: {
         if (root_.load() != nullptr) return false;
         [[assume(alloc.count >= 0 && alloc.count <= 8)]];
         for (int i = 0; i < alloc.count; ++i) {
             if (alloc.nodes[i]) alloc.nodes[i]->unpoison();
         }
-        root_.store(alloc.root_replacement);
-        return true;
+        // No node to lock: concurrent first inserts race on the root slot
+        ptr_t expected = nullptr;
+        return root_.compare_exchange(expected, alloc.root_replacement);
+    }
 
     case spec_op::SPLIT_LEAF_SKIP:
     case spec_op::PREFIX_LEAF_SKIP:
@@ -463,7 +475,7 @@ void TKTRIE_CLASS::dealloc_speculation(pre_alloc& alloc) {
 
 TKTRIE_TEMPLATE
 std::pair<typename TKTRIE_CLASS::iterator, bool> TKTRIE_CLASS::insert_locked(
-    const Key& key, std::string_view kb, const T& value, bool* retired_any) {
+    const Key& key, std::string_view kb, const source_t& value, bool* retired_any) {
     if (retired_any) *retired_any = false;
     
     if constexpr (!THREADED) {
@@ -483,15 +495,14 @@ std::pair<typename TKTRIE_CLASS::iterator, bool> TKTRIE_CLASS::insert_locked(
         for (auto* old : res.old_nodes) retire_node(old);
         size_.fetch_add(1);
 
-        return {iterator(this, kb, value), true};
+        return {iterator(this, kb, value.held()), true};
     } else {
         using ops = trie_ops<T, THREADED, Allocator, FIXED_LEN>;
         
-        if (retired_count_.load(std::memory_order_relaxed) >= EBR_MIN_RETIRED) {
-            ebr_cleanup();
-        }
+        maybe_reclaim(EBR_MIN_RETIRED);
         
-        size_t slot = reader_enter();
+        value_retire_guard values(*this);
+        auto* rec = reader_enter();
         
         constexpr int MAX_RETRIES = 7;
         
@@ -505,28 +516,37 @@ std::pair<typename TKTRIE_CLASS::iterator, bool> TKTRIE_CLASS::insert_locked(
             }
 
             if (spec.op == spec_op::EXISTS) {
+                if (!validate_probe_path(spec.path.data(), spec.path_len, speculative_info::MAX_PATH)) continue;
                 stat_success(retry);
-                reader_exit(slot);
-                return {iterator(this, kb, value), false};
+                iterator it(this, kb, value.held());
+                reader_exit(rec);
+                return {it, false};
             }
 
+            // Single-node edits: lock only the target at its probed version,
+            // edit, unlock. Nothing is retired, so epoch_ isn't touched either.
             if (spec.op == spec_op::IN_PLACE_LEAF) {
-                std::lock_guard<mutex_t> lock(mutex_);
-                if (!validate_path(spec)) continue;
-                
-                if (spec.target->has_leaf_entry(spec.c)) continue;
-                if (spec.target->at_ceil()) continue;
-                
-                epoch_.fetch_add(1, std::memory_order_release);
-                auto add_res = ops::template add_entry<false, true>(spec.target, spec.c, value, builder_);
-                if (!add_res.success || !add_res.in_place) {
-                    continue;
+                bool added = false;
+                {
+                    commit_section commit(*this, rec);
+                    commit_locks locks;
+                    ptr_t n = spec.target;
+                    if (lock_speculative_path(spec, locks) &&
+                        !n->has_leaf_entry(spec.c) && !n->at_ceil()) {
+                        auto add_res = ops::template add_entry<false, true>(n, spec.c, value, builder_);
+                        added = add_res.success && add_res.in_place;
+                    }
+                    // Counted before the section ends, so an exclusive holder
+                    // sees size_ agree with the tree
+                    if (added) size_.fetch_add(1);
+                    locks.release();
                 }
+                if (!added) continue;
                 
-                size_.fetch_add(1);
                 stat_success(retry);
-                reader_exit(slot);
-                return {iterator(this, kb, value), true};
+                iterator it(this, kb, value.held());
+                reader_exit(rec);
+                return {it, true};
             }
 
             if (spec.op == spec_op::IN_PLACE_INTERIOR) {
@@ -534,41 +554,50 @@ std::pair<typename TKTRIE_CLASS::iterator, bool> TKTRIE_CLASS::insert_locked(
                     if constexpr (FIXED_LEN > 0) {
                         continue;
                     } else {
-                        std::lock_guard<mutex_t> lock(mutex_);
-                        if (!validate_path(spec)) continue;
+                        bool added = false;
+                        {
+                            commit_section commit(*this, rec);
+                            commit_locks locks;
+                            ptr_t n = spec.target;
+                            if (lock_speculative_path(spec, locks) && !n->has_eos()) {
+                                n->set_eos(value);
+                                size_.fetch_add(1);
+                                added = true;
+                            }
+                            locks.release();
+                        }
+                        if (!added) continue;
                         
-                        ptr_t n = spec.target;
-                        if (n->has_eos()) continue;
-                        
-                        epoch_.fetch_add(1, std::memory_order_release);
-                        n->bump_version();
-                        n->set_eos(value);
-                        size_.fetch_add(1);
                         stat_success(retry);
-                        reader_exit(slot);
-                        return {iterator(this, kb, value), true};
+                        iterator it(this, kb, value.held());
+                        reader_exit(rec);
+                        return {it, true};
                     }
                 } else {
                     ptr_t child = create_leaf_for_key(spec.remaining_key, value);
-                    std::lock_guard<mutex_t> lock(mutex_);
-                    if (!validate_path(spec)) { builder_.dealloc_node(child); continue; }
-                    
-                    ptr_t n = spec.target;
-                    
-                    if (n->has_child(spec.c)) { builder_.dealloc_node(child); continue; }
-                    if (n->at_ceil()) { builder_.dealloc_node(child); continue; }
-                    
-                    epoch_.fetch_add(1, std::memory_order_release);
-                    auto add_res = ops::template add_entry<false, false>(n, spec.c, child, builder_);
-                    if (!add_res.success || !add_res.in_place) {
+                    bool added = false;
+                    {
+                        commit_section commit(*this, rec);
+                        commit_locks locks;
+                        ptr_t n = spec.target;
+                        if (lock_speculative_path(spec, locks) &&
+                            !n->has_child(spec.c) && !n->at_ceil()) {
+                            auto add_res = ops::template add_entry<false, false>(n, spec.c, child, builder_);
+                            added = add_res.success && add_res.in_place;
+                        }
+                        if (added) size_.fetch_add(1);
+                        locks.release();
+                    }
+                    if (!added) {
+                        value.reclaim();
                         builder_.dealloc_node(child);
                         continue;
                     }
                     
-                    size_.fetch_add(1);
                     stat_success(retry);
-                    reader_exit(slot);
-                    return {iterator(this, kb, value), true};
+                    iterator it(this, kb, value.held());
+                    reader_exit(rec);
+                    return {it, true};
                 }
             }
 
@@ -580,8 +609,12 @@ std::pair<typename TKTRIE_CLASS::iterator, bool> TKTRIE_CLASS::insert_locked(
             pre_alloc alloc = allocate_speculative(spec, value);
             
             if (alloc.root_replacement) {
-                std::lock_guard<mutex_t> lock(mutex_);
-                if (!validate_path(spec)) {
+                // Commits on disjoint subtrees proceed in parallel
+                commit_section commit(*this, rec);
+                commit_locks locks;
+                if (!lock_speculative_path(spec, locks)) {
+                    locks.release();
+                    value.reclaim();
                     dealloc_speculation(alloc);
                     continue;
                 }
@@ -592,11 +625,15 @@ std::pair<typename TKTRIE_CLASS::iterator, bool> TKTRIE_CLASS::insert_locked(
                         retire_node(spec.target);
                         if (retired_any) *retired_any = true;
                     }
+                    locks.release();
                     size_.fetch_add(1);
                     stat_success(retry);
-                    reader_exit(slot);
-                    return {iterator(this, kb, value), true};
+                    iterator it(this, kb, value.held());
+                    reader_exit(rec);
+                    return {it, true};
                 }
+                locks.release();
+                value.reclaim();
                 dealloc_speculation(alloc);
                 continue;
             }
@@ -604,7 +641,7 @@ std::pair<typename TKTRIE_CLASS::iterator, bool> TKTRIE_CLASS::insert_locked(
         
         stat_fallback();
         {
-            std::lock_guard<mutex_t> lock(mutex_);
+            exclusive_lock lock(*this);
             
             ptr_t root = root_.load();
             auto res = insert_impl(&root_, root, kb, value);
@@ -612,8 +649,9 @@ std::pair<typename TKTRIE_CLASS::iterator, bool> TKTRIE_CLASS::insert_locked(
             if (!res.inserted) {
                 if (retired_any && !res.old_nodes.empty()) *retired_any = true;
                 for (auto* old : res.old_nodes) retire_node(old);
-                reader_exit(slot);
-                return {iterator(this, kb, value), false};
+                iterator it(this, kb, value.held());
+                reader_exit(rec);
+                return {it, false};
             }
             
             epoch_.fetch_add(1, std::memory_order_release);
@@ -624,8 +662,9 @@ std::pair<typename TKTRIE_CLASS::iterator, bool> TKTRIE_CLASS::insert_locked(
             if (retired_any && !res.old_nodes.empty()) *retired_any = true;
             for (auto* old : res.old_nodes) retire_node(old);
             size_.fetch_add(1);
-            reader_exit(slot);
-            return {iterator(this, kb, value), true};
+            iterator it(this, kb, value.held());
+            reader_exit(rec);
+            return {it, true};
         }
     }
 }
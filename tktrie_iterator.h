@@ -8,25 +8,41 @@
 // Iterator is a snapshot containing:
 //   - parent_: pointer to trie (const or non-const based on CONST)
 //   - key_bytes_: cached key in byte form
-//   - value_: cached value
+//   - value_: cached value (a counted reference to the box of a move-only T)
 //
 // Iterators remain valid even if their key is deleted from the trie.
-// ++ and -- find next/prev key relative to cached key.
+// ++ and -- find next/prev key relative to cached key. Over a tktrie they
+// also keep a cursor (the path to the cached key) and step along it, so a
+// full scan costs O(n) rather than a re-walk from the root per key; the
+// cursor re-seeks from the cached key once the trie changed under it.
+//
+// A forward iterator may carry a bound (prefix_range, equal_range): it then
+// also compares equal to any iterator whose key is at or past the bound, so
+// a loop to it stops there however the trie changes meanwhile.
 //
 // Template parameters:
 //   CONST = false: can call erase()/insert() via parent
 //   CONST = true:  read-only
 //   REVERSE = false: ++ moves toward larger keys
 //   REVERSE = true:  ++ moves toward smaller keys
+//   Trie: parent type; anything with the find_*_bytes helpers (e.g. sharded_tktrie)
+
+// Tries that offer a cursor (tktrie) get one per iterator; others (sharded_tktrie)
+// re-find from the cached key on each step
+struct no_cursor {};
+
+template <typename Trie>
+struct iterator_cursor { using type = no_cursor; };
 
-// Forward declaration
 template <typename Key, typename T, bool THREADED, typename Allocator>
-class tktrie;
+struct iterator_cursor<tktrie<Key, T, THREADED, Allocator>> {
+    using type = typename tktrie<Key, T, THREADED, Allocator>::cursor;
+};
 
-template <typename Key, typename T, bool THREADED, typename Allocator, bool CONST, bool REVERSE>
+template <typename Key, typename T, bool THREADED, typename Allocator, bool CONST, bool REVERSE, typename Trie>
 class tktrie_iterator_impl {
 public:
-    using trie_t = tktrie<Key, T, THREADED, Allocator>;
+    using trie_t = Trie;
     using traits = tktrie_traits<Key>;
     static constexpr size_t FIXED_LEN = traits::FIXED_LEN;
     
@@ -41,11 +57,58 @@ public:
     using reference = const value_type&;
 
 private:
+    template <typename, typename, bool, typename, bool, bool, typename>
+    friend class tktrie_iterator_impl;
+
+    using cursor_t = typename iterator_cursor<Trie>::type;
+    using held_t = typename dataptr<T, THREADED, Allocator>::held_t;
+    
+    // operator*'s pair, built on first use; copies start empty (pair<const
+    // Key, T> can't be assigned, and the copy may move on anyway)
+    struct deref_cache {
+        std::optional<value_type> pair;
+        deref_cache() = default;
+        deref_cache(const deref_cache&) noexcept {}
+        deref_cache& operator=(const deref_cache&) noexcept {
+            pair.reset();
+            return *this;
+        }
+    };
+    static constexpr bool HAS_CURSOR = !std::is_same_v<cursor_t, no_cursor>;
+
     // Core data: parent trie, cached key, cached value
     trie_ptr_t parent_ = nullptr;
     std::string key_bytes_;  // Cached key in byte form
-    T value_{};              // Cached value
+    held_t value_{};         // Cached value
     bool valid_ = false;     // false = end() iterator
+    bool bounded_ = false;   // Keys >= bound_ compare equal to this iterator
+    std::string bound_;
+    mutable deref_cache deref_;
+    [[no_unique_address]] cursor_t cursor_{};  // Path to key_bytes_, if HAS_CURSOR
+
+    // At or past o's bound (an iterator off the end is past every bound)
+    bool reached(const tktrie_iterator_impl& o) const {
+        return o.bounded_ && (!valid_ || key_bytes_ >= o.bound_);
+    }
+
+    // One step toward larger (FORWARD) or smaller keys
+    void step(bool forward) {
+        deref_.pair.reset();
+        if (!parent_) { valid_ = false; return; }
+        if constexpr (HAS_CURSOR) {
+            valid_ = parent_->cursor_step(cursor_, forward, key_bytes_, value_);
+        } else {
+            std::string kb;
+            held_t v{};
+            bool found = forward ? parent_->find_greater_bytes(key_bytes_, kb, v)
+                                 : parent_->find_less_bytes(key_bytes_, kb, v);
+            if (found) {
+                key_bytes_ = std::move(kb);
+                value_ = std::move(v);
+            }
+            valid_ = found;
+        }
+    }
 
 public:
     tktrie_iterator_impl() = default;
@@ -54,28 +117,54 @@ public:
     explicit tktrie_iterator_impl(trie_ptr_t t) : parent_(t), valid_(false) {}
     
     // Constructor with cached key/value (for find(), begin(), etc.)
-    tktrie_iterator_impl(trie_ptr_t t, std::string_view kb, const T& v)
-        : parent_(t), key_bytes_(kb), value_(v), valid_(true) {}
+    tktrie_iterator_impl(trie_ptr_t t, std::string_view kb, held_t v)
+        : parent_(t), key_bytes_(kb), value_(std::move(v)), valid_(true) {}
+
+    // O's key and value under another parent (how sharded_tktrie wraps the
+    // iterators of its shards)
+    template <bool C2, bool R2, typename T2>
+    tktrie_iterator_impl(trie_ptr_t t, const tktrie_iterator_impl<Key, T, THREADED, Allocator, C2, R2, T2>& o)
+        : parent_(t), key_bytes_(o.key_bytes_), value_(o.value_), valid_(o.valid_) {}
     
     // -------------------------------------------------------------------------
     // Factory methods
     // -------------------------------------------------------------------------
     static tktrie_iterator_impl make_begin(trie_ptr_t t) {
+        if constexpr (HAS_CURSOR) {
+            tktrie_iterator_impl it(t);
+            it.valid_ = t->cursor_first(it.cursor_, !REVERSE, it.key_bytes_, it.value_);
+            return it;
+        }
         std::string kb;
-        T v{};
+        held_t v{};
         bool found;
         if constexpr (REVERSE) {
             found = t->find_last_bytes(kb, v);
         } else {
             found = t->find_first_bytes(kb, v);
         }
-        if (found) return tktrie_iterator_impl(t, kb, v);
+        if (found) return tktrie_iterator_impl(t, kb, std::move(v));
         return tktrie_iterator_impl(t);
     }
     
+    // First key after (REVERSE: before) target, or at it unless STRICT
+    static tktrie_iterator_impl make_seek(trie_ptr_t t, std::string_view target, bool strict)
+        requires HAS_CURSOR {
+        tktrie_iterator_impl it(t);
+        it.valid_ = t->cursor_seek(it.cursor_, target, !REVERSE, strict, it.key_bytes_, it.value_);
+        return it;
+    }
+    
     static tktrie_iterator_impl make_end(trie_ptr_t t) {
         return tktrie_iterator_impl(t);
     }
+    
+    // Adds a bound to it: keys >= bound compare equal to the result
+    static tktrie_iterator_impl make_bounded(tktrie_iterator_impl it, std::string bound) requires (!REVERSE) {
+        it.bounded_ = true;
+        it.bound_ = std::move(bound);
+        return it;
+    }
 
     // -------------------------------------------------------------------------
     // Access cached data
@@ -92,16 +181,26 @@ public:
     bool valid() const { return valid_; }
     explicit operator bool() const { return valid_; }
     
+    // The (key, value) pair, built from the cached key and value on first use
+    // (a copy, so not for a move-only T: use key() and value())
+    reference operator*() const requires std::is_copy_constructible_v<T> {
+        if (!deref_.pair) deref_.pair.emplace(key(), value_);
+        return *deref_.pair;
+    }
+    pointer operator->() const requires std::is_copy_constructible_v<T> { return &**this; }
+    
     // Access parent trie
     trie_ptr_t parent() const { return parent_; }
     
-    // Access raw key bytes (for internal use by trie)
-    const std::string& key_bytes() const { return key_bytes_; }
+    // The key's encoded bytes, without building a Key (for string keys, the
+    // key itself); valid until the iterator moves or is destroyed
+    std::string_view key_bytes() const noexcept { return key_bytes_; }
 
     // -------------------------------------------------------------------------
     // Comparison
     // -------------------------------------------------------------------------
     bool operator==(const tktrie_iterator_impl& o) const {
+        if (reached(o) || o.reached(*this)) return true;
         if (!valid_ && !o.valid_) return true;
         if (valid_ != o.valid_) return false;
         return key_bytes_ == o.key_bytes_;
@@ -115,23 +214,7 @@ public:
     // Reverse:  ++ finds next smaller key, -- finds next larger key
     // -------------------------------------------------------------------------
     tktrie_iterator_impl& operator++() {
-        if (!parent_) { valid_ = false; return *this; }
-        
-        std::string kb;
-        T v{};
-        bool found;
-        if constexpr (REVERSE) {
-            found = parent_->find_less_bytes(key_bytes_, kb, v);
-        } else {
-            found = parent_->find_greater_bytes(key_bytes_, kb, v);
-        }
-        if (found) {
-            key_bytes_ = std::move(kb);
-            value_ = std::move(v);
-            valid_ = true;
-        } else {
-            valid_ = false;
-        }
+        step(!REVERSE);
         return *this;
     }
     
@@ -142,23 +225,7 @@ public:
     }
     
     tktrie_iterator_impl& operator--() {
-        if (!parent_) { valid_ = false; return *this; }
-        
-        std::string kb;
-        T v{};
-        bool found;
-        if constexpr (REVERSE) {
-            found = parent_->find_greater_bytes(key_bytes_, kb, v);
-        } else {
-            found = parent_->find_less_bytes(key_bytes_, kb, v);
-        }
-        if (found) {
-            key_bytes_ = std::move(kb);
-            value_ = std::move(v);
-            valid_ = true;
-        } else {
-            valid_ = false;
-        }
+        step(REVERSE);
         return *this;
     }
     
@@ -192,13 +259,14 @@ public:
     // -------------------------------------------------------------------------
     // Conversion: non-const -> const
     // -------------------------------------------------------------------------
-    operator tktrie_iterator_impl<Key, T, THREADED, Allocator, true, REVERSE>() const 
+    operator tktrie_iterator_impl<Key, T, THREADED, Allocator, true, REVERSE, Trie>() const 
         requires (!CONST) 
     {
-        if (valid_) {
-            return tktrie_iterator_impl<Key, T, THREADED, Allocator, true, REVERSE>(
-                parent_, key_bytes_, value_);
+        using const_t = tktrie_iterator_impl<Key, T, THREADED, Allocator, true, REVERSE, Trie>;
+        const_t it = valid_ ? const_t(parent_, key_bytes_, value_) : const_t(parent_);
+        if constexpr (!REVERSE) {
+            if (bounded_) return const_t::make_bounded(std::move(it), bound_);
         }
-        return tktrie_iterator_impl<Key, T, THREADED, Allocator, true, REVERSE>(parent_);
+        return it;
     }
 };
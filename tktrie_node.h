@@ -6,6 +6,7 @@
 #include <string>
 #include "tktrie_defines.h"
 #include "tktrie_dataptr.h"
+#include "tktrie_slab.h"
 
 namespace gteitelbaum {
 
@@ -97,6 +98,9 @@ struct atomic_node_ptr {
     ptr_t load() const noexcept { return ptr_.load(std::memory_order_acquire); }
     void store(ptr_t p) noexcept { ptr_.store(p, std::memory_order_release); }
     ptr_t exchange(ptr_t p) noexcept { return ptr_.exchange(p, std::memory_order_acq_rel); }
+    bool compare_exchange(ptr_t& expected, ptr_t desired) noexcept {
+        return ptr_.compare_exchange_strong(expected, desired, std::memory_order_acq_rel);
+    }
 };
 
 // =============================================================================
@@ -110,6 +114,7 @@ struct node_base {
     using atomic_ptr = atomic_node_ptr<T, THREADED, Allocator, FIXED_LEN>;
     using data_t = dataptr<T, THREADED, Allocator, false>;
     using eos_data_t = dataptr<T, THREADED, Allocator, true>;
+    using source_t = value_source<T, THREADED, Allocator>;
     using skip_t = skip_string<FIXED_LEN>;
     
     atomic_storage<uint64_t, THREADED> header_;
@@ -122,11 +127,35 @@ struct node_base {
     
     uint64_t version() const noexcept { return get_version(header()); }
     void bump_version() noexcept { header_.store(gteitelbaum::bump_version(header_.load())); }
+    // Bracket in-place edits readers may see: the version is odd in between.
+    // Returns false (and changes nothing) if the caller already holds the node
+    // via try_lock_version; only call end_write() after a true return.
+    bool begin_write() noexcept {
+        uint64_t h = header_.load();
+        if (h & VERSION_WRITING) return false;
+        header_.store(step_version(h));
+        if constexpr (THREADED) std::atomic_thread_fence(std::memory_order_release);
+        return true;
+    }
+    void end_write() noexcept { header_.store(step_version(header_.load())); }
+    // Writer node lock: odd version = held. Fails unless the node is live, idle
+    // and still at the version the caller probed, so locking also validates.
+    bool try_lock_version(uint64_t expected) noexcept {
+        uint64_t h = header_.load();
+        if ((h & (FLAG_POISON | VERSION_WRITING)) || get_version(h) != expected) return false;
+        return header_.compare_exchange(h, step_version(h));
+    }
+    void unlock_version() noexcept { end_write(); }
     void poison() noexcept {
         uint64_t h = header_.load();
         header_.store(gteitelbaum::bump_version(h) | FLAG_POISON);
     }
     void unpoison() noexcept { header_.store(header_.load() & ~FLAG_POISON); }
+    // Retired nodes stay poisoned; their version bits hold the retire epoch
+    void mark_retired(uint64_t epoch) noexcept {
+        header_.store((header_.load() & FLAGS_MASK) | FLAG_POISON | (epoch & VERSION_MASK));
+    }
+    uint64_t retired_epoch() const noexcept { return get_version(header()); }
     bool is_poisoned() const noexcept { return is_poisoned_header(header()); }
     
     bool is_leaf() const noexcept { return gteitelbaum::is_leaf(header()); }
@@ -218,6 +247,19 @@ struct node_base {
         }
     }
     
+    // Entry (child or leaf value) chars either side of a position, for
+    // cursors; -1 if none. Start from an end with after = -1 / before = 256.
+    int next_entry_char(int after) const noexcept {
+        uint64_t h = header();
+        if (h & FLAG_LEAF) return next_char_in<true>(h, after);
+        return next_char_in<false>(h, after);
+    }
+    int prev_entry_char(int before) const noexcept {
+        uint64_t h = header();
+        if (h & FLAG_LEAF) return prev_char_in<true>(h, before);
+        return prev_char_in<false>(h, before);
+    }
+    
     int child_count() const noexcept {
         uint64_t h = header();
         if ((h & (FLAG_BINARY | FLAG_LIST)) != 0) [[likely]] {
@@ -278,7 +320,9 @@ struct node_base {
         else return eos_flag();
     }
     
-    bool try_read_eos(T& out) const noexcept {
+    // OUT is T (copy) or const T* (zero-copy, see dataptr::try_read)
+    template <typename Out>
+    bool try_read_eos(Out& out) const noexcept {
         if constexpr (FIXED_LEN > 0) {
             (void)out;
             return false;
@@ -295,7 +339,7 @@ struct node_base {
         }
     }
     
-    void set_eos(const T& value) {
+    void set_eos(const source_t& value) {
         if constexpr (FIXED_LEN > 0) {
             (void)value;
         } else {
@@ -337,7 +381,8 @@ struct node_base {
         }
     }
     
-    bool try_read_leaf_value(unsigned char c, T& out) const noexcept {
+    template <typename Out>
+    bool try_read_leaf_value(unsigned char c, Out& out) const noexcept {
         uint64_t h = header();
         if ((h & (FLAG_BINARY | FLAG_LIST)) != 0) [[likely]] {
             if (h & FLAG_BINARY) [[likely]] {
@@ -361,6 +406,79 @@ struct node_base {
         }
     }
     
+    // The dataptr a lookup ending at this node reads: EOS for an interior, the
+    // value of a SKIP leaf, else leaf entry c. Calls fn(slot) if it's there.
+    template <typename Fn>
+    bool with_value_slot(unsigned char c, Fn&& fn) {
+        uint64_t h = header();
+        if (!(h & FLAG_LEAF)) {
+            if constexpr (FIXED_LEN > 0) {
+                return false;
+            } else {
+                if (!eos_flag()) return false;
+                if ((h & (FLAG_BINARY | FLAG_LIST)) != 0) [[likely]] {
+                    if (h & FLAG_BINARY) [[likely]] fn(as_binary<false>()->eos());
+                    else fn(as_list<false>()->eos());
+                } else {
+                    if (h & FLAG_POP) [[likely]] fn(as_pop<false>()->eos());
+                    else fn(as_full<false>()->eos());
+                }
+                return true;
+            }
+        }
+        if (h & FLAG_SKIP) {
+            fn(as_skip()->value);
+            return true;
+        }
+        if ((h & (FLAG_BINARY | FLAG_LIST)) != 0) [[likely]] {
+            if (h & FLAG_BINARY) [[likely]] {
+                auto* bn = as_binary<true>();
+                int idx = bn->find(c);
+                if (idx < 0) return false;
+                fn(bn->value_at(idx));
+            } else {
+                auto* ln = as_list<true>();
+                int idx = ln->find(c);
+                if (idx < 0) return false;
+                fn(ln->value_at(idx));
+            }
+        } else {
+            if (h & FLAG_POP) [[likely]] {
+                auto* pn = as_pop<true>();
+                int slot = pn->find(c);
+                if (slot < 0) return false;
+                fn(pn->element_at_slot(slot));
+            } else {
+                auto* fn_node = as_full<true>();
+                if (!fn_node->has(c)) return false;
+                fn(fn_node->value_at(c));
+            }
+        }
+        return true;
+    }
+    
+    template <bool IS_LEAF>
+    int next_char_in(uint64_t h, int after) const noexcept {
+        if ((h & (FLAG_BINARY | FLAG_LIST)) != 0) [[likely]] {
+            if (h & FLAG_BINARY) [[likely]] return as_binary<IS_LEAF>()->next_char(after);
+            else return as_list<IS_LEAF>()->next_char(after);
+        } else {
+            if (h & FLAG_POP) [[likely]] return as_pop<IS_LEAF>()->next_char(after);
+            else return as_full<IS_LEAF>()->next_char(after);
+        }
+    }
+    
+    template <bool IS_LEAF>
+    int prev_char_in(uint64_t h, int before) const noexcept {
+        if ((h & (FLAG_BINARY | FLAG_LIST)) != 0) [[likely]] {
+            if (h & FLAG_BINARY) [[likely]] return as_binary<IS_LEAF>()->prev_char(before);
+            else return as_list<IS_LEAF>()->prev_char(before);
+        } else {
+            if (h & FLAG_POP) [[likely]] return as_pop<IS_LEAF>()->prev_char(before);
+            else return as_full<IS_LEAF>()->prev_char(before);
+        }
+    }
+    
     template <typename Fn>
     void for_each_leaf_entry(Fn&& fn) const {
         uint64_t h = header();
@@ -368,7 +486,7 @@ struct node_base {
             if (h & FLAG_BINARY) [[likely]] {
                 auto* bn = as_binary<true>();
                 for (int i = 0; i < bn->count(); ++i) {
-                    T val{};
+                    typename data_t::held_t val{};
                     bn->value_at(i).try_read(val);
                     fn(bn->char_at(i), val);
                 }
@@ -376,7 +494,7 @@ struct node_base {
                 auto* ln = as_list<true>();
                 int cnt = ln->count();
                 for (int i = 0; i < cnt; ++i) {
-                    T val{};
+                    typename data_t::held_t val{};
                     ln->value_at(i).try_read(val);
                     fn(ln->char_at(i), val);
                 }
@@ -386,7 +504,7 @@ struct node_base {
                 auto* pn = as_pop<true>();
                 int slot = 0;
                 pn->valid().for_each_set([pn, &fn, &slot](unsigned char c) {
-                    T val{};
+                    typename data_t::held_t val{};
                     pn->element_at_slot(slot).try_read(val);
                     fn(c, val);
                     ++slot;
@@ -394,7 +512,7 @@ struct node_base {
             } else {
                 auto* fn_node = as_full<true>();
                 fn_node->valid().for_each_set([fn_node, &fn](unsigned char c) {
-                    T val{};
+                    typename data_t::held_t val{};
                     fn_node->read_value(c, val);
                     fn(c, val);
                 });
@@ -1,6 +1,7 @@
 #pragma once
 
 // This file contains retry sentinel storage and node_builder class
+// Nodes are allocated from per-builder slab pools (see tktrie_slab.h)
 // It should only be included from tktrie_node_types.h
 
 namespace gteitelbaum {
@@ -65,27 +66,87 @@ public:
         return is_retry_sentinel(n);
     }
     
-    static void delete_node(ptr_t n) {
+    explicit node_builder(const Allocator& alloc = Allocator())
+        : skip_slab_(sizeof(skip_t) + RETIRE_LINK_BYTES, alloc),
+          leaf_binary_slab_(sizeof(leaf_binary_t) + RETIRE_LINK_BYTES, alloc),
+          interior_binary_slab_(sizeof(interior_binary_t) + RETIRE_LINK_BYTES, alloc),
+          leaf_list_slab_(sizeof(leaf_list_t) + RETIRE_LINK_BYTES, alloc),
+          interior_list_slab_(sizeof(interior_list_t) + RETIRE_LINK_BYTES, alloc),
+          leaf_pop_slab_(sizeof(leaf_pop_t) + RETIRE_LINK_BYTES, alloc),
+          interior_pop_slab_(sizeof(interior_pop_t) + RETIRE_LINK_BYTES, alloc),
+          leaf_full_slab_(sizeof(leaf_full_t) + RETIRE_LINK_BYTES, alloc),
+          interior_full_slab_(sizeof(interior_full_t) + RETIRE_LINK_BYTES, alloc) {}
+    ~node_builder() = default;
+    node_builder(const node_builder&) = delete;
+    node_builder& operator=(const node_builder&) = delete;
+    
+    // Exchange node pools. Caller guarantees no concurrent access to either.
+    void swap(node_builder& o) noexcept {
+        skip_slab_.swap(o.skip_slab_);
+        leaf_binary_slab_.swap(o.leaf_binary_slab_);
+        interior_binary_slab_.swap(o.interior_binary_slab_);
+        leaf_list_slab_.swap(o.leaf_list_slab_);
+        interior_list_slab_.swap(o.interior_list_slab_);
+        leaf_pop_slab_.swap(o.leaf_pop_slab_);
+        interior_pop_slab_.swap(o.interior_pop_slab_);
+        leaf_full_slab_.swap(o.leaf_full_slab_);
+        interior_full_slab_.swap(o.interior_full_slab_);
+    }
+    
+    // Returns every pool's chunks to the allocator. Caller guarantees no live nodes.
+    void release() noexcept {
+        skip_slab_.release();
+        leaf_binary_slab_.release();
+        interior_binary_slab_.release();
+        leaf_list_slab_.release();
+        interior_list_slab_.release();
+        leaf_pop_slab_.release();
+        interior_pop_slab_.release();
+        leaf_full_slab_.release();
+        interior_full_slab_.release();
+    }
+    
+    Allocator get_allocator() const { return skip_slab_.get_allocator(); }
+    
+    // -------------------------------------------------------------------------
+    // Retire linkage: THREADED blocks carry one pointer past the node object,
+    // so a retired node is listed without touching fields readers may still use
+    // -------------------------------------------------------------------------
+    static constexpr size_t RETIRE_LINK_BYTES = THREADED ? sizeof(ptr_t) : 0;
+    
+    static size_t node_size(ptr_t n) noexcept {
+        if (n->is_skip()) return sizeof(skip_t);
+        if (n->is_binary()) return n->is_leaf() ? sizeof(leaf_binary_t) : sizeof(interior_binary_t);
+        if (n->is_list()) return n->is_leaf() ? sizeof(leaf_list_t) : sizeof(interior_list_t);
+        if (n->is_pop()) return n->is_leaf() ? sizeof(leaf_pop_t) : sizeof(interior_pop_t);
+        return n->is_leaf() ? sizeof(leaf_full_t) : sizeof(interior_full_t);
+    }
+    
+    static ptr_t& retire_next(ptr_t n) noexcept requires THREADED {
+        return *std::launder(reinterpret_cast<ptr_t*>(reinterpret_cast<char*>(n) + node_size(n)));
+    }
+    
+    void delete_node(ptr_t n) {
         if (!n || is_sentinel(n)) return;
         if (n->is_skip()) {
-            delete n->as_skip();
+            free_node(n->as_skip());
         } else if (n->is_binary()) {
-            if (n->is_leaf()) delete n->template as_binary<true>();
-            else delete n->template as_binary<false>();
+            if (n->is_leaf()) free_node(n->template as_binary<true>());
+            else free_node(n->template as_binary<false>());
         } else if (n->is_list()) [[likely]] {
-            if (n->is_leaf()) delete n->template as_list<true>();
-            else delete n->template as_list<false>();
+            if (n->is_leaf()) free_node(n->template as_list<true>());
+            else free_node(n->template as_list<false>());
         } else if (n->is_pop()) {
-            if (n->is_leaf()) delete n->template as_pop<true>();
-            else delete n->template as_pop<false>();
+            if (n->is_leaf()) free_node(n->template as_pop<true>());
+            else free_node(n->template as_pop<false>());
         } else {
-            if (n->is_leaf()) delete n->template as_full<true>();
-            else delete n->template as_full<false>();
+            if (n->is_leaf()) free_node(n->template as_full<true>());
+            else free_node(n->template as_full<false>());
         }
     }
     
-    ptr_t make_leaf_skip(std::string_view sk, const T& value) {
-        auto* n = new skip_t();
+    ptr_t make_leaf_skip(std::string_view sk, const typename base_t::source_t& value) {
+        auto* n = alloc_node<skip_t>();
         bool skip_used = !sk.empty();
         n->set_header(make_header(true, FLAG_SKIP, skip_used, true, false));
         n->skip.assign(sk);
@@ -94,7 +155,7 @@ public:
     }
     
     ptr_t make_leaf_binary(std::string_view sk) {
-        auto* n = new leaf_binary_t();
+        auto* n = alloc_node<leaf_binary_t>();
         bool skip_used = !sk.empty();
         n->set_header(make_header(true, FLAG_BINARY, skip_used, true, false));
         n->skip.assign(sk);
@@ -102,7 +163,7 @@ public:
     }
     
     ptr_t make_leaf_list(std::string_view sk) {
-        auto* n = new leaf_list_t();
+        auto* n = alloc_node<leaf_list_t>();
         bool skip_used = !sk.empty();
         n->set_header(make_header(true, FLAG_LIST, skip_used, false, false));
         n->skip.assign(sk);
@@ -110,7 +171,7 @@ public:
     }
     
     ptr_t make_leaf_pop(std::string_view sk) {
-        auto* n = new leaf_pop_t();
+        auto* n = alloc_node<leaf_pop_t>();
         bool skip_used = !sk.empty();
         n->set_header(make_header(true, FLAG_POP, skip_used, false, false));
         n->skip.assign(sk);
@@ -118,7 +179,7 @@ public:
     }
     
     ptr_t make_leaf_full(std::string_view sk) {
-        auto* n = new leaf_full_t();
+        auto* n = alloc_node<leaf_full_t>();
         bool skip_used = !sk.empty();
         n->set_header(make_header(true, FLAG_FULL, skip_used, false, false));
         n->skip.assign(sk);
@@ -126,7 +187,7 @@ public:
     }
     
     ptr_t make_interior_binary(std::string_view sk) {
-        auto* n = new interior_binary_t();
+        auto* n = alloc_node<interior_binary_t>();
         bool skip_used = !sk.empty();
         n->set_header(make_header(false, FLAG_BINARY, skip_used, true, false));
         n->skip.assign(sk);
@@ -134,7 +195,7 @@ public:
     }
     
     ptr_t make_interior_list(std::string_view sk) {
-        auto* n = new interior_list_t();
+        auto* n = alloc_node<interior_list_t>();
         bool skip_used = !sk.empty();
         n->set_header(make_header(false, FLAG_LIST, skip_used, false, false));
         n->skip.assign(sk);
@@ -142,7 +203,7 @@ public:
     }
     
     ptr_t make_interior_pop(std::string_view sk) {
-        auto* n = new interior_pop_t();
+        auto* n = alloc_node<interior_pop_t>();
         bool skip_used = !sk.empty();
         n->set_header(make_header(false, FLAG_POP, skip_used, false, false));
         n->skip.assign(sk);
@@ -150,7 +211,7 @@ public:
     }
     
     ptr_t make_interior_full(std::string_view sk) {
-        auto* n = new interior_full_t();
+        auto* n = alloc_node<interior_full_t>();
         bool skip_used = !sk.empty();
         n->set_header(make_header(false, FLAG_FULL, skip_used, false, false));
         n->skip.assign(sk);
@@ -224,7 +285,7 @@ public:
         if (src->is_leaf()) {
             if (src->is_skip()) {
                 auto* s = src->as_skip();
-                auto* d = new skip_t();
+                auto* d = alloc_node<skip_t>();
                 d->set_header(s->header());
                 d->skip = s->skip;
                 d->value.deep_copy_from(s->value);
@@ -232,7 +293,7 @@ public:
             }
             if (src->is_binary()) {
                 auto* s = src->template as_binary<true>();
-                auto* d = new leaf_binary_t();
+                auto* d = alloc_node<leaf_binary_t>();
                 d->set_header(s->header());
                 d->skip = s->skip;
                 s->copy_values_to(d);
@@ -240,7 +301,7 @@ public:
             }
             if (src->is_list()) [[likely]] {
                 auto* s = src->template as_list<true>();
-                auto* d = new leaf_list_t();
+                auto* d = alloc_node<leaf_list_t>();
                 d->set_header(s->header());
                 d->skip = s->skip;
                 s->copy_values_to(d);
@@ -248,14 +309,14 @@ public:
             }
             if (src->is_pop()) {
                 auto* s = src->template as_pop<true>();
-                auto* d = new leaf_pop_t();
+                auto* d = alloc_node<leaf_pop_t>();
                 d->set_header(s->header());
                 d->skip = s->skip;
                 s->copy_values_to(d);
                 return d;
             }
             auto* s = src->template as_full<true>();
-            auto* d = new leaf_full_t();
+            auto* d = alloc_node<leaf_full_t>();
             d->set_header(s->header());
             d->skip = s->skip;
             s->copy_values_to(d);
@@ -264,7 +325,7 @@ public:
         
         if (src->is_binary()) {
             auto* s = src->template as_binary<false>();
-            auto* d = new interior_binary_t();
+            auto* d = alloc_node<interior_binary_t>();
             d->set_header(s->header());
             d->skip = s->skip;
             s->copy_interior_to(d);
@@ -277,7 +338,7 @@ public:
         }
         if (src->is_list()) [[likely]] {
             auto* s = src->template as_list<false>();
-            auto* d = new interior_list_t();
+            auto* d = alloc_node<interior_list_t>();
             d->set_header(s->header());
             d->skip = s->skip;
             s->copy_interior_to(d);
@@ -290,7 +351,7 @@ public:
         }
         if (src->is_pop()) {
             auto* s = src->template as_pop<false>();
-            auto* d = new interior_pop_t();
+            auto* d = alloc_node<interior_pop_t>();
             d->set_header(s->header());
             d->skip = s->skip;
             s->copy_interior_to(d);
@@ -301,7 +362,7 @@ public:
             return d;
         }
         auto* s = src->template as_full<false>();
-        auto* d = new interior_full_t();
+        auto* d = alloc_node<interior_full_t>();
         d->set_header(s->header());
         d->skip = s->skip;
         s->copy_interior_to(d);
@@ -311,6 +372,53 @@ public:
         });
         return d;
     }
+    
+private:
+    // -------------------------------------------------------------------------
+    // Per-type slab pools (one size class per node type and leaf/interior flavor)
+    // -------------------------------------------------------------------------
+    using slab_t = slab_class<Allocator, THREADED>;
+    
+    slab_t skip_slab_;
+    slab_t leaf_binary_slab_;
+    slab_t interior_binary_slab_;
+    slab_t leaf_list_slab_;
+    slab_t interior_list_slab_;
+    slab_t leaf_pop_slab_;
+    slab_t interior_pop_slab_;
+    slab_t leaf_full_slab_;
+    slab_t interior_full_slab_;
+    
+    template <typename N>
+    slab_t& slab_for() noexcept {
+        if constexpr (std::is_same_v<N, skip_t>) return skip_slab_;
+        else if constexpr (std::is_same_v<N, leaf_binary_t>) return leaf_binary_slab_;
+        else if constexpr (std::is_same_v<N, interior_binary_t>) return interior_binary_slab_;
+        else if constexpr (std::is_same_v<N, leaf_list_t>) return leaf_list_slab_;
+        else if constexpr (std::is_same_v<N, interior_list_t>) return interior_list_slab_;
+        else if constexpr (std::is_same_v<N, leaf_pop_t>) return leaf_pop_slab_;
+        else if constexpr (std::is_same_v<N, interior_pop_t>) return interior_pop_slab_;
+        else if constexpr (std::is_same_v<N, leaf_full_t>) return leaf_full_slab_;
+        else return interior_full_slab_;
+    }
+    
+    template <typename N>
+    N* alloc_node() {
+        static_assert(alignof(N) <= SLAB_LINE_SIZE);
+        slab_t& slab = slab_for<N>();
+        void* p = slab.allocate();
+        N* n;
+        try { n = ktrie_construct_at(static_cast<N*>(p)); }
+        catch (...) { slab.deallocate(p); throw; }
+        if constexpr (THREADED) ::new (static_cast<void*>(reinterpret_cast<char*>(p) + sizeof(N))) ptr_t(nullptr);
+        return n;
+    }
+    
+    template <typename N>
+    void free_node(N* n) noexcept {
+        ktrie_destroy_at(n);
+        slab_for<N>().deallocate(n);
+    }
 };
 
 }  // namespace gteitelbaum
@@ -36,6 +36,7 @@ public:
     using atomic_ptr = typename base_t::atomic_ptr;
     using data_t = typename base_t::data_t;
     using eos_data_t = typename base_t::eos_data_t;
+    using source_t = typename base_t::source_t;
     
     static constexpr int MAX_ENTRIES = 2;
     static constexpr bool HAS_EOS = !IS_LEAF && (FIXED_LEN == 0);
@@ -59,16 +60,31 @@ public:
     int count() const noexcept { return count_; }
     
     bool has(unsigned char c) const noexcept { 
-        return (chars_[0] == c) + mult_ * (chars_[1] == c);
+        return find(c) >= 0;
     }
     
     // Branchless find using mult_: returns -1 (not found), 0, or 1
+    // count_ guards chars_[0]: an EOS-only interior can be left with no children
     int find(unsigned char c) const noexcept {
-        return -1 + (chars_[0] == c) + mult_ * (chars_[1] == c);
+        return -1 + ((chars_[0] == c) & (count_ != 0)) + mult_ * (chars_[1] == c);
     }
     
     unsigned char first_char() const noexcept { return chars_[0]; }
     
+    // Neighbouring entry chars for cursors: -1 if none (see bitmap256::next_set)
+    int next_char(int after) const noexcept {
+        for (int i = 0; i < count_; ++i) {
+            if (chars_[i] > after) return chars_[i];
+        }
+        return -1;
+    }
+    int prev_char(int before) const noexcept {
+        for (int i = count_; i-- > 0;) {
+            if (chars_[i] < before) return chars_[i];
+        }
+        return -1;
+    }
+    
     void update_capacity_flags() noexcept {
         if (count_ <= BINARY_MIN) this->set_floor(); else this->clear_floor();
         if (count_ >= BINARY_MAX) this->set_ceil(); else this->clear_ceil();
@@ -87,12 +103,13 @@ public:
     // -------------------------------------------------------------------------
     // Leaf interface (values)
     // -------------------------------------------------------------------------
-    bool read_value(int idx, T& out) const noexcept requires IS_LEAF {
+    template <typename Out>
+    bool read_value(int idx, Out& out) const noexcept requires IS_LEAF {
         return elements_[idx].try_read(out);
     }
     
     // Unified add_entry for leaf nodes
-    void add_entry(unsigned char c, const T& value) requires IS_LEAF {
+    void add_entry(unsigned char c, const source_t& value) requires IS_LEAF {
         if (count_ == 0) {
             chars_[0] = c;
             elements_[0].set(value);
@@ -243,6 +260,7 @@ public:
     using atomic_ptr = typename base_t::atomic_ptr;
     using data_t = typename base_t::data_t;
     using eos_data_t = typename base_t::eos_data_t;
+    using source_t = typename base_t::source_t;
     
     static constexpr int MAX_ENTRIES = 7;
     static constexpr bool HAS_EOS = !IS_LEAF && (FIXED_LEN == 0);
@@ -263,6 +281,20 @@ public:
     int find(unsigned char c) const noexcept { return chars_.find(c); }
     unsigned char char_at(int i) const noexcept { return chars_.char_at(i); }
     
+    int next_char(int after) const noexcept {
+        int cnt = chars_.count();
+        for (int i = 0; i < cnt; ++i) {
+            if (chars_.char_at(i) > after) return chars_.char_at(i);
+        }
+        return -1;
+    }
+    int prev_char(int before) const noexcept {
+        for (int i = chars_.count(); i-- > 0;) {
+            if (chars_.char_at(i) < before) return chars_.char_at(i);
+        }
+        return -1;
+    }
+    
     const small_list<THREADED>& chars() const noexcept { return chars_; }
     
     void update_capacity_flags() noexcept {
@@ -278,12 +310,13 @@ public:
     eos_data_t& eos() noexcept requires HAS_EOS { return eos_; }
     const eos_data_t& eos() const noexcept requires HAS_EOS { return eos_; }
     
-    bool read_value(int idx, T& out) const noexcept requires IS_LEAF {
+    template <typename Out>
+    bool read_value(int idx, Out& out) const noexcept requires IS_LEAF {
         [[assume(idx >= 0 && idx < 7)]];
         return elements_[idx].try_read(out);
     }
     
-    void set_value(unsigned char c, const T& val) requires IS_LEAF {
+    void set_value(unsigned char c, const source_t& val) requires IS_LEAF {
         int idx = chars_.find(c);
         if (idx >= 0) {
             elements_[idx].set(val);
@@ -298,7 +331,7 @@ public:
         }
     }
     
-    int add_entry(unsigned char c, const T& val) requires IS_LEAF {
+    int add_entry(unsigned char c, const source_t& val) requires IS_LEAF {
         int cnt = chars_.count();
         int idx = chars_.add_sorted(c);
         // Shift elements to match char order
@@ -441,6 +474,7 @@ public:
     using atomic_ptr = typename base_t::atomic_ptr;
     using data_t = typename base_t::data_t;
     using eos_data_t = typename base_t::eos_data_t;
+    using source_t = typename base_t::source_t;
     
     static constexpr int MAX_ENTRIES = POP_MAX;
     static constexpr bool HAS_EOS = !IS_LEAF && (FIXED_LEN == 0);
@@ -461,6 +495,8 @@ public:
     int find(unsigned char c) const noexcept { return valid_.test_slot(c); }
     
     unsigned char first_char() const noexcept { return valid_.first(); }
+    int next_char(int after) const noexcept { return valid_.next_set(after); }
+    int prev_char(int before) const noexcept { return valid_.prev_set(before); }
     
     element_t& element_at_slot(int slot) noexcept { return elements_[slot]; }
     const element_t& element_at_slot(int slot) const noexcept { return elements_[slot]; }
@@ -480,13 +516,14 @@ public:
     eos_data_t& eos() noexcept requires HAS_EOS { return eos_; }
     const eos_data_t& eos() const noexcept requires HAS_EOS { return eos_; }
     
-    bool read_value(unsigned char c, T& out) const noexcept requires IS_LEAF {
+    template <typename Out>
+    bool read_value(unsigned char c, Out& out) const noexcept requires IS_LEAF {
         int slot = valid_.test_slot(c);
         if (slot < 0) return false;
         return elements_[slot].try_read(out);
     }
     
-    void add_entry(unsigned char c, const T& val) requires IS_LEAF {
+    void add_entry(unsigned char c, const source_t& val) requires IS_LEAF {
         int slot = valid_.shift_up_for_insert(c, elements_, count());
         elements_[slot].set(val);
         valid_.set(c);
@@ -582,6 +619,7 @@ public:
     using atomic_ptr = typename base_t::atomic_ptr;
     using data_t = typename base_t::data_t;
     using eos_data_t = typename base_t::eos_data_t;
+    using source_t = typename base_t::source_t;
     
     static constexpr bool HAS_EOS = !IS_LEAF && (FIXED_LEN == 0);
     
@@ -598,6 +636,8 @@ public:
     
     int count() const noexcept { return valid_.count(); }
     bool has(unsigned char c) const noexcept { return valid_.test(c); }
+    int next_char(int after) const noexcept { return valid_.next_set(after); }
+    int prev_char(int before) const noexcept { return valid_.prev_set(before); }
     
     const bitmap256<THREADED>& valid() const noexcept { return valid_; }
     
@@ -614,21 +654,24 @@ public:
     eos_data_t& eos() noexcept requires HAS_EOS { return eos_; }
     const eos_data_t& eos() const noexcept requires HAS_EOS { return eos_; }
     
-    bool read_value(unsigned char c, T& out) const noexcept requires IS_LEAF {
+    template <typename Out>
+    bool read_value(unsigned char c, Out& out) const noexcept requires IS_LEAF {
         return elements_[c].try_read(out);
     }
     
-    void set_value(unsigned char c, const T& val) requires IS_LEAF {
+    data_t& value_at(unsigned char c) noexcept requires IS_LEAF { return elements_[c]; }
+    
+    void set_value(unsigned char c, const source_t& val) requires IS_LEAF {
         elements_[c].set(val);
         valid_.template atomic_set<THREADED>(c);
     }
     
-    void add_entry(unsigned char c, const T& val) requires IS_LEAF {
+    void add_entry(unsigned char c, const source_t& val) requires IS_LEAF {
         elements_[c].set(val);
         valid_.set(c);
     }
     
-    void add_entry_atomic(unsigned char c, const T& val) requires IS_LEAF {
+    void add_entry_atomic(unsigned char c, const source_t& val) requires IS_LEAF {
         elements_[c].set(val);
         valid_.template atomic_set<THREADED>(c);
     }
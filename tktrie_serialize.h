@@ -0,0 +1,345 @@
+#pragma once
+
+// This file contains save() and load()
+// It should only be included from tktrie_erase_range.h
+
+#include <istream>
+#include <ostream>
+
+namespace gteitelbaum {
+
+// -----------------------------------------------------------------------------
+// Byte streams for save/load and value codecs
+// -----------------------------------------------------------------------------
+// Both go straight to the stream's buffer (sputc/sbumpc), so nothing is read
+// past the saved trie and the stream's own buffering does the batching.
+
+class tktrie_writer {
+    std::streambuf* sb_;
+    bool ok_;
+
+public:
+    explicit tktrie_writer(std::ostream& out) : sb_(out.rdbuf()), ok_(sb_ != nullptr && out.good()) {}
+
+    void put(const void* data, size_t n) {
+        if (ok_) ok_ = sb_->sputn(static_cast<const char*>(data), static_cast<std::streamsize>(n)) ==
+                       static_cast<std::streamsize>(n);
+    }
+    void put_byte(uint8_t b) {
+        if (ok_) ok_ = sb_->sputc(static_cast<char>(b)) != std::streambuf::traits_type::eof();
+    }
+    // LEB128: 7 bits per byte, low first, high bit set on all but the last
+    void put_varint(uint64_t v) {
+        while (v >= 0x80) {
+            put_byte(static_cast<uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        put_byte(static_cast<uint8_t>(v));
+    }
+    bool ok() const noexcept { return ok_; }
+};
+
+class tktrie_reader {
+    std::streambuf* sb_;
+    bool ok_;
+
+public:
+    explicit tktrie_reader(std::istream& in) : sb_(in.rdbuf()), ok_(sb_ != nullptr && in.good()) {}
+
+    bool get(void* data, size_t n) {
+        if (ok_) ok_ = sb_->sgetn(static_cast<char*>(data), static_cast<std::streamsize>(n)) ==
+                       static_cast<std::streamsize>(n);
+        return ok_;
+    }
+    bool get_byte(uint8_t& b) {
+        if (!ok_) return false;
+        int c = sb_->sbumpc();
+        if (c == std::streambuf::traits_type::eof()) return ok_ = false;
+        b = static_cast<uint8_t>(c);
+        return true;
+    }
+    bool get_varint(uint64_t& v) {
+        v = 0;
+        uint8_t b;
+        for (int shift = 0; shift < 64 && get_byte(b); shift += 7) {
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return ok_ = false;
+    }
+    // n bytes into s, grown as they arrive: a corrupt length fails at the
+    // stream's end instead of allocating it up front
+    bool get_string(std::string& s, uint64_t n) {
+        static constexpr uint64_t CHUNK = 4096;
+        s.clear();
+        while (ok_ && s.size() < n) {
+            size_t at = s.size();
+            s.resize(at + static_cast<size_t>(std::min(n - at, CHUNK)));
+            get(s.data() + at, s.size() - at);
+        }
+        return ok_;
+    }
+    void fail() noexcept { ok_ = false; }
+    bool ok() const noexcept { return ok_; }
+};
+
+// Trivially copyable values are stored as their bytes (so a stream is only
+// portable between machines of one endianness); strings as a varint length
+// and their bytes. Other value types need a tktrie_codec specialization or
+// a codec object passed to save/load with the same two members.
+template <typename T> requires std::is_trivially_copyable_v<T>
+struct tktrie_codec<T> {
+    static void write(tktrie_writer& w, const T& v) { w.put(&v, sizeof(T)); }
+    static bool read(tktrie_reader& r, T& v) { return r.get(&v, sizeof(T)); }
+};
+
+template <>
+struct tktrie_codec<std::string> {
+    static void write(tktrie_writer& w, const std::string& v) {
+        w.put_varint(v.size());
+        w.put(v.data(), v.size());
+    }
+    static bool read(tktrie_reader& r, std::string& v) {
+        uint64_t n;
+        return r.get_varint(n) && r.get_string(v, n);
+    }
+};
+
+#define TKTRIE_TEMPLATE template <typename Key, typename T, bool THREADED, typename Allocator>
+#define TKTRIE_CLASS tktrie<Key, T, THREADED, Allocator>
+
+// -----------------------------------------------------------------------------
+// Save / load
+// -----------------------------------------------------------------------------
+// The stream is a header (magic, format version, FIXED_LEN, size) and then
+// the nodes depth-first, each as:
+//   tag       SAVE_LEAF | SAVE_SKIP | SAVE_EOS
+//   skip      varint length, bytes
+//   SKIP leaf: its value; otherwise
+//   count     varint, the number of entries
+//   chars     count bytes ascending if count <= POP_MAX (as a small_list or
+//             pop node lists them), else a 32-byte bitmap256
+//   EOS value, if SAVE_EOS
+//   leaf: one value per char; interior: one child node per char
+// An empty trie with no root is the single tag SAVE_NONE. The node type is
+// not stored: load picks it from count, so every node is allocated once at
+// its final size, children before their parent, in one pass over the stream.
+
+TKTRIE_TEMPLATE
+template <typename Codec>
+void TKTRIE_CLASS::save_node(tktrie_writer& w, ptr_t n, Codec& codec) const {
+    auto value_of = [](const pin_t& pin) -> const T& {
+        if constexpr (data_t::PINNABLE) return *pin;
+        else return pin;
+    };
+    pin_t pin{};
+    bool skip_leaf = n->is_skip();
+    bool leaf = n->is_leaf();
+    bool eos = n->has_eos();
+    w.put_byte(static_cast<uint8_t>((leaf ? SAVE_LEAF : 0) | (skip_leaf ? SAVE_SKIP : 0) | (eos ? SAVE_EOS : 0)));
+    std::string_view skip = n->skip_str();
+    w.put_varint(skip.size());
+    w.put(skip.data(), skip.size());
+    if (skip_leaf) {
+        n->as_skip()->value.try_read(pin);
+        codec.write(w, value_of(pin));
+        return;
+    }
+
+    int count = leaf ? n->leaf_entry_count() : n->child_count();
+    w.put_varint(static_cast<uint64_t>(count));
+    if (count <= POP_MAX) {
+        for (int c = n->next_entry_char(-1); c >= 0; c = n->next_entry_char(c)) w.put_byte(static_cast<uint8_t>(c));
+    } else {
+        uint8_t bits[32] = {};
+        for (int c = n->next_entry_char(-1); c >= 0; c = n->next_entry_char(c)) bits[c >> 3] |= uint8_t(1) << (c & 7);
+        w.put(bits, sizeof(bits));
+    }
+    if (eos) {
+        n->try_read_eos(pin);
+        codec.write(w, value_of(pin));
+    }
+    for (int c = n->next_entry_char(-1); c >= 0 && w.ok(); c = n->next_entry_char(c)) {
+        unsigned char uc = static_cast<unsigned char>(c);
+        if (leaf) {
+            n->try_read_leaf_value(uc, pin);
+            codec.write(w, value_of(pin));
+        } else {
+            save_node(w, n->get_child(uc), codec);
+        }
+    }
+}
+
+// The subtree at depth key bytes, or nullptr (with r failed) if the stream
+// is short or its shape cannot be this trie's; counts the keys read
+TKTRIE_TEMPLATE
+template <typename Codec>
+typename TKTRIE_CLASS::ptr_t TKTRIE_CLASS::load_node(tktrie_reader& r, Codec& codec, size_t depth, size_t& keys) {
+    uint8_t tag;
+    uint64_t skip_len;
+    std::string skip;
+    if (!r.get_byte(tag) || !r.get_varint(skip_len)) return nullptr;
+    bool leaf = tag & SAVE_LEAF, skip_leaf = tag & SAVE_SKIP, eos = tag & SAVE_EOS;
+    bool shape_ok = (tag & ~(SAVE_LEAF | SAVE_SKIP | SAVE_EOS)) == 0 && (!skip_leaf || leaf) && !(eos && leaf);
+    if constexpr (FIXED_LEN > 0) {
+        // Every key ends exactly FIXED_LEN bytes down; the root is an
+        // interior node with no skip
+        size_t end = depth + skip_len + (skip_leaf ? 0 : 1);
+        if (depth == 0) shape_ok = shape_ok && !leaf && skip_len == 0;
+        shape_ok = shape_ok && !eos && skip_len < FIXED_LEN && (leaf ? end == FIXED_LEN : end <= FIXED_LEN);
+    }
+    if (!shape_ok) {
+        r.fail();
+        return nullptr;
+    }
+    if (!r.get_string(skip, skip_len)) return nullptr;
+
+    T value{};
+    if (skip_leaf) {
+        if (!codec.read(r, value)) return nullptr;
+        ++keys;
+        return builder_.make_leaf_skip(skip, value);
+    }
+
+    uint64_t count;
+    unsigned char chars[256];
+    if (!r.get_varint(count)) return nullptr;
+    // Erases can leave an interior node holding only its EOS value
+    bool pinned_root = FIXED_LEN > 0 && depth == 0;
+    if (count > 256 || (count == 0 && !pinned_root && !eos)) {
+        r.fail();
+        return nullptr;
+    }
+    if (count <= POP_MAX) {
+        if (!r.get(chars, count)) return nullptr;
+        for (uint64_t i = 1; i < count; ++i) {
+            if (chars[i] <= chars[i - 1]) r.fail();
+        }
+    } else {
+        uint8_t bits[32];
+        if (!r.get(bits, sizeof(bits))) return nullptr;
+        uint64_t found = 0;
+        for (int c = 0; c < 256; ++c) {
+            if (bits[c >> 3] & (1 << (c & 7))) chars[found++] = static_cast<unsigned char>(c);
+        }
+        if (found != count) r.fail();
+    }
+    T eos_value{};
+    if (eos && r.ok()) codec.read(r, eos_value);
+    if (!r.ok()) return nullptr;
+
+    int n = static_cast<int>(count);
+    size_t below = depth + skip.size() + 1;
+    ptr_t node;
+    if (leaf) {
+        node = bulk_node<true>(skip, n, [&](auto* dst) {
+            for (int i = 0; i < n && codec.read(r, value); ++i) dst->add_entry(chars[i], value);
+        });
+        keys += static_cast<size_t>(n);
+    } else {
+        auto fill = [&](auto* dst) {
+            for (int i = 0; i < n && r.ok(); ++i) {
+                if (ptr_t child = load_node(r, codec, below, keys)) dst->add_entry(chars[i], child);
+            }
+        };
+        // As bulk_root: the fixed-length root is at least a list
+        if (pinned_root && n <= LIST_MAX) {
+            node = builder_.make_interior_list("");
+            fill(node->template as_list<false>());
+            node->template as_list<false>()->update_capacity_flags();
+        } else {
+            node = bulk_node<false>(skip, n, fill);
+        }
+        if (eos) {
+            node->set_eos(eos_value);
+            ++keys;
+        }
+    }
+    if (!r.ok()) {
+        builder_.dealloc_node(node);
+        return nullptr;
+    }
+    return node;
+}
+
+TKTRIE_TEMPLATE
+template <typename Codec>
+bool TKTRIE_CLASS::save(std::ostream& out, Codec codec) const {
+    tktrie_writer w(out);
+    auto write = [&]() {
+        w.put(SAVE_MAGIC, sizeof(SAVE_MAGIC));
+        w.put_byte(SAVE_VERSION);
+        w.put_varint(FIXED_LEN);
+        w.put_varint(size_.load());
+        ptr_t root = root_.load();
+        if (root && (FIXED_LEN > 0 || size_.load() > 0)) save_node(w, root, codec);
+        else w.put_byte(SAVE_NONE);
+    };
+    if constexpr (THREADED) {
+        exclusive_lock lock(*this);
+        write();
+    } else {
+        std::lock_guard<mutex_t> lock(mutex_);
+        write();
+    }
+    if (!w.ok()) out.setstate(std::ios::badbit);
+    return w.ok();
+}
+
+TKTRIE_TEMPLATE
+template <typename Codec>
+bool TKTRIE_CLASS::load(std::istream& in, Codec codec) {
+    tktrie_reader r(in);
+    char magic[sizeof(SAVE_MAGIC)];
+    uint8_t version = 0, tag = 0;
+    uint64_t fixed_len = 0, size = 0;
+    size_t keys = 0;
+    ptr_t built = nullptr;
+    if (r.get(magic, sizeof(magic)) && r.get_byte(version) && r.get_varint(fixed_len) && r.get_varint(size)) {
+        if (std::memcmp(magic, SAVE_MAGIC, sizeof(magic)) != 0 || version != SAVE_VERSION || fixed_len != FIXED_LEN) {
+            r.fail();
+        } else if (FIXED_LEN == 0 && size == 0) {
+            // A string trie with no keys has no root
+            if (r.get_byte(tag) && tag != SAVE_NONE) r.fail();
+        } else {
+            built = load_node(r, codec, 0, keys);
+            if (built && keys != size) r.fail();
+        }
+    }
+    if (!r.ok()) {
+        if (built) builder_.dealloc_node(built);
+        in.setstate(std::ios::failbit);
+        return false;
+    }
+
+    // Swap the built tree in and retire the old one whole, as erase_range
+    // does, so readers still walking it are safe
+    std::vector<ptr_t> retired;
+    auto publish = [&]() {
+        ptr_t old = root_.load();
+        if constexpr (THREADED) {
+            epoch_.fetch_add(1, std::memory_order_release);
+            root_.store(get_retry_sentinel<T, THREADED, Allocator, FIXED_LEN>());
+        }
+        root_.store(built);
+        size_.store(keys);
+        if (old && !builder_t::is_sentinel(old)) retire_subtree(old, retired);
+        ebr_retire_batch(retired);
+    };
+    if constexpr (THREADED) {
+        {
+            exclusive_lock lock(*this);
+            publish();
+        }
+        maybe_reclaim(EBR_MIN_RETIRED);
+    } else {
+        std::lock_guard<mutex_t> lock(mutex_);
+        publish();
+    }
+    return true;
+}
+
+#undef TKTRIE_TEMPLATE
+#undef TKTRIE_CLASS
+
+}  // namespace gteitelbaum
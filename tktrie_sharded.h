@@ -0,0 +1,298 @@
+#pragma once
+
+// This file contains the sharded_tktrie wrapper
+// It should only be included from tktrie.h
+
+#include <array>
+
+namespace gteitelbaum {
+
+// =============================================================================
+// SHARDED_TKTRIE - fixed fan-out of independent tries by leading key byte
+// =============================================================================
+// Shard i owns keys whose first encoded byte falls in [i*W, (i+1)*W), with
+// W = 256 / SHARDS. Each shard is a full tktrie with its own mutex_, epoch_
+// and EBR registry, so writers to different shards share no cache lines.
+// Ranges are contiguous, so ordered iteration walks shards in index order.
+//
+// Keys spread across shards only as far as their leading byte varies: signed
+// integers near zero, or strings with a common first character, all land in
+// one shard.
+
+template <typename Key, typename T, size_t SHARDS = 16, bool THREADED = true,
+          typename Allocator = std::allocator<uint64_t>>
+class sharded_tktrie {
+    static_assert(SHARDS >= 1 && SHARDS <= 256 && 256 % SHARDS == 0,
+                  "SHARDS must divide the 256 leading-byte values");
+
+public:
+    using trie_t = tktrie<Key, T, THREADED, Allocator>;
+    using traits = tktrie_traits<Key>;
+    using held_t = typename trie_t::held_t;
+    using iterator = tktrie_iterator_impl<Key, T, THREADED, Allocator, false, false, sharded_tktrie>;
+    using reverse_iterator = tktrie_iterator_impl<Key, T, THREADED, Allocator, false, true, sharded_tktrie>;
+    using const_iterator = tktrie_iterator_impl<Key, T, THREADED, Allocator, true, false, sharded_tktrie>;
+    using const_reverse_iterator = tktrie_iterator_impl<Key, T, THREADED, Allocator, true, true, sharded_tktrie>;
+
+private:
+    static constexpr size_t BYTES_PER_SHARD = 256 / SHARDS;
+
+    struct alignas(64) shard {
+        trie_t trie;
+    };
+    std::array<shard, SHARDS> shards_;
+
+    static size_t shard_of(std::string_view kb) noexcept {
+        if (kb.empty()) return 0;
+        return static_cast<unsigned char>(kb[0]) / BYTES_PER_SHARD;
+    }
+
+    template <typename It, typename Parent, typename ShardIt>
+    static It rewrap(Parent* self, const ShardIt& it) {
+        return It(self, it);
+    }
+
+    // key is a Key or, for string tries, a key view (see trie_key_view)
+    template <typename K>
+    static size_t shard_index(const K& key) noexcept {
+        if constexpr (std::is_same_v<K, Key>) {
+            auto kb = traits::to_bytes(key);
+            return shard_of(std::string_view(kb.data(), kb.size()));
+        } else {
+            return shard_of(trie_key_bytes(key));
+        }
+    }
+
+    // Bound within key's shard, else the first key of a later shard
+    template <typename It, typename Parent, typename K>
+    static It bound(Parent* self, const K& key, bool strict) {
+        size_t i = shard_index(key);
+        const trie_t& t = self->shards_[i].trie;
+        auto it = strict ? t.upper_bound(key) : t.lower_bound(key);
+        if (it.valid()) return rewrap<It>(self, it);
+        for (++i; i < SHARDS; ++i) {
+            auto first = self->shards_[i].trie.begin();
+            if (first.valid()) return rewrap<It>(self, first);
+        }
+        return It(self);
+    }
+
+    // [lo, hi) spans the shards from lo's to hi's
+    template <typename K1, typename K2, typename Fn>
+    size_t scan_shards(const K1& lo, const K2& hi, Fn& fn, size_t limit) const {
+        size_t last = shard_index(hi);
+        size_t n = 0;
+        for (size_t i = shard_index(lo); i <= last && n < limit; ++i) {
+            n += shards_[i].trie.scan(lo, hi, fn, limit - n);
+        }
+        return n;
+    }
+    template <typename K1, typename K2>
+    size_t erase_range_shards(const K1& lo, const K2& hi) {
+        size_t last = shard_index(hi);
+        size_t n = 0;
+        for (size_t i = shard_index(lo); i <= last; ++i) n += shards_[i].trie.erase_range(lo, hi);
+        return n;
+    }
+
+public:
+    sharded_tktrie() = default;
+
+    static constexpr size_t shard_count() noexcept { return SHARDS; }
+    trie_t& shard_at(size_t i) noexcept { return shards_[i].trie; }
+    const trie_t& shard_at(size_t i) const noexcept { return shards_[i].trie; }
+
+    trie_t& shard_for(const Key& key) noexcept { return shards_[shard_index(key)].trie; }
+    const trie_t& shard_for(const Key& key) const noexcept {
+        return const_cast<sharded_tktrie*>(this)->shard_for(key);
+    }
+
+    size_t size() const noexcept {
+        size_t n = 0;
+        for (const auto& s : shards_) n += s.trie.size();
+        return n;
+    }
+    bool empty() const noexcept {
+        for (const auto& s : shards_) {
+            if (!s.trie.empty()) return false;
+        }
+        return true;
+    }
+    void clear() {
+        for (auto& s : shards_) s.trie.clear();
+    }
+    void reclaim_retired() noexcept {
+        for (auto& s : shards_) s.trie.reclaim_retired();
+    }
+    // Each BACKGROUND shard runs its own reclaimer thread
+    void set_reclaim_policy(reclaim_policy p) {
+        for (auto& s : shards_) s.trie.set_reclaim_policy(p);
+    }
+    void poll() {
+        for (auto& s : shards_) s.trie.poll();
+    }
+
+    bool contains(const Key& key) const { return shard_for(key).contains(key); }
+    bool erase(const Key& key) { return shard_for(key).erase(key); }
+
+    std::pair<iterator, bool> insert(const std::pair<const Key, T>& kv) {
+        auto [it, inserted] = shard_for(kv.first).insert(kv);
+        return {rewrap<iterator>(this, it), inserted};
+    }
+    std::pair<iterator, bool> insert(std::pair<const Key, T>&& kv) {
+        auto [it, inserted] = shard_for(kv.first).insert(std::move(kv));
+        return {rewrap<iterator>(this, it), inserted};
+    }
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        std::pair<const Key, T> kv(std::forward<Args>(args)...);
+        return insert(std::move(kv));
+    }
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        auto [it, inserted] = shard_for(key).try_emplace(key, std::forward<Args>(args)...);
+        return {rewrap<iterator>(this, it), inserted};
+    }
+
+    std::pair<iterator, bool> insert_or_assign(const Key& key, const T& value) {
+        auto [it, inserted] = shard_for(key).insert_or_assign(key, value);
+        return {rewrap<iterator>(this, it), inserted};
+    }
+    template <typename Fn>
+    bool upsert(const Key& key, Fn&& fn) { return shard_for(key).upsert(key, std::forward<Fn>(fn)); }
+
+    // Each shard holds a contiguous run of keys: only one can hold a prefix's
+    template <typename Fn>
+    void for_each_with_prefix(std::string_view prefix, Fn&& fn) const requires (traits::FIXED_LEN == 0) {
+        if (!prefix.empty()) {
+            shards_[shard_of(prefix)].trie.for_each_with_prefix(prefix, fn);
+            return;
+        }
+        for (const auto& s : shards_) s.trie.for_each_with_prefix(prefix, fn);
+    }
+
+    // A key's non-empty prefixes share its first byte, so its shard; "" is in shard 0
+    iterator longest_prefix_match(std::string_view key) requires (traits::FIXED_LEN == 0) {
+        auto it = shards_[shard_of(key)].trie.longest_prefix_match(key);
+        if (!it.valid() && shard_of(key) != 0) it = shards_[0].trie.longest_prefix_match(std::string_view());
+        return rewrap<iterator>(this, it);
+    }
+    const_iterator longest_prefix_match(std::string_view key) const requires (traits::FIXED_LEN == 0) {
+        auto it = shards_[shard_of(key)].trie.longest_prefix_match(key);
+        if (!it.valid() && shard_of(key) != 0) it = shards_[0].trie.longest_prefix_match(std::string_view());
+        return rewrap<const_iterator>(this, it);
+    }
+
+    size_t erase_prefix(std::string_view prefix) requires (traits::FIXED_LEN == 0) {
+        if (!prefix.empty()) return shards_[shard_of(prefix)].trie.erase_prefix(prefix);
+        size_t n = 0;
+        for (auto& s : shards_) n += s.trie.erase_prefix(prefix);
+        return n;
+    }
+    size_t erase_range(const Key& lo, const Key& hi) { return erase_range_shards(lo, hi); }
+
+    iterator lower_bound(const Key& key) { return bound<iterator>(this, key, false); }
+    const_iterator lower_bound(const Key& key) const { return bound<const_iterator>(this, key, false); }
+    iterator upper_bound(const Key& key) { return bound<iterator>(this, key, true); }
+    const_iterator upper_bound(const Key& key) const { return bound<const_iterator>(this, key, true); }
+
+    template <typename Fn>
+    size_t scan(const Key& lo, const Key& hi, Fn&& fn, size_t limit = SIZE_MAX) const {
+        return scan_shards(lo, hi, fn, limit);
+    }
+
+    iterator find(const Key& key) { return rewrap<iterator>(this, shard_for(key).find(key)); }
+    const_iterator find(const Key& key) const {
+        return rewrap<const_iterator>(this, shard_for(key).find(key));
+    }
+
+    // Key-view lookups and erases (string tries), as tktrie's
+    template <trie_key_view<Key> K> requires (traits::FIXED_LEN == 0)
+    bool contains(const K& key) const { return shards_[shard_index(key)].trie.contains(key); }
+    template <trie_key_view<Key> K> requires (traits::FIXED_LEN == 0)
+    bool erase(const K& key) { return shards_[shard_index(key)].trie.erase(key); }
+    template <trie_key_view<Key> K> requires (traits::FIXED_LEN == 0)
+    iterator find(const K& key) { return rewrap<iterator>(this, shards_[shard_index(key)].trie.find(key)); }
+    template <trie_key_view<Key> K> requires (traits::FIXED_LEN == 0)
+    const_iterator find(const K& key) const {
+        return rewrap<const_iterator>(this, shards_[shard_index(key)].trie.find(key));
+    }
+    template <trie_key_view<Key> K> requires (traits::FIXED_LEN == 0)
+    iterator lower_bound(const K& key) { return bound<iterator>(this, key, false); }
+    template <trie_key_view<Key> K> requires (traits::FIXED_LEN == 0)
+    const_iterator lower_bound(const K& key) const { return bound<const_iterator>(this, key, false); }
+    template <trie_key_view<Key> K> requires (traits::FIXED_LEN == 0)
+    iterator upper_bound(const K& key) { return bound<iterator>(this, key, true); }
+    template <trie_key_view<Key> K> requires (traits::FIXED_LEN == 0)
+    const_iterator upper_bound(const K& key) const { return bound<const_iterator>(this, key, true); }
+    template <trie_key_view<Key> K1, trie_key_view<Key> K2, typename Fn> requires (traits::FIXED_LEN == 0)
+    size_t scan(const K1& lo, const K2& hi, Fn&& fn, size_t limit = SIZE_MAX) const {
+        return scan_shards(lo, hi, fn, limit);
+    }
+    template <trie_key_view<Key> K1, trie_key_view<Key> K2> requires (traits::FIXED_LEN == 0)
+    size_t erase_range(const K1& lo, const K2& hi) { return erase_range_shards(lo, hi); }
+
+    iterator begin() { return iterator::make_begin(this); }
+    iterator end() noexcept { return iterator::make_end(this); }
+    const_iterator begin() const { return const_iterator::make_begin(this); }
+    const_iterator end() const noexcept { return const_iterator::make_end(this); }
+    const_iterator cbegin() const { return const_iterator::make_begin(this); }
+    const_iterator cend() const noexcept { return const_iterator::make_end(this); }
+
+    reverse_iterator rbegin() { return reverse_iterator::make_begin(this); }
+    reverse_iterator rend() noexcept { return reverse_iterator::make_end(this); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator::make_begin(this); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator::make_end(this); }
+    const_reverse_iterator crbegin() const { return const_reverse_iterator::make_begin(this); }
+    const_reverse_iterator crend() const noexcept { return const_reverse_iterator::make_end(this); }
+
+    // -------------------------------------------------------------------------
+    // Iterator helpers: same contract as tktrie's, stitched across shards
+    // -------------------------------------------------------------------------
+    bool find_first_bytes(std::string& out_key, held_t& out_value) const {
+        for (size_t i = 0; i < SHARDS; ++i) {
+            if (shards_[i].trie.find_first_bytes(out_key, out_value)) return true;
+        }
+        return false;
+    }
+
+    bool find_last_bytes(std::string& out_key, held_t& out_value) const {
+        for (size_t i = SHARDS; i-- > 0;) {
+            if (shards_[i].trie.find_last_bytes(out_key, out_value)) return true;
+        }
+        return false;
+    }
+
+    bool find_greater_bytes(const std::string& key, std::string& out_key, held_t& out_value) const {
+        size_t i = shard_of(key);
+        if (shards_[i].trie.find_greater_bytes(key, out_key, out_value)) return true;
+        for (++i; i < SHARDS; ++i) {
+            if (shards_[i].trie.find_first_bytes(out_key, out_value)) return true;
+        }
+        return false;
+    }
+
+    bool find_less_bytes(const std::string& key, std::string& out_key, held_t& out_value) const {
+        size_t i = shard_of(key);
+        if (shards_[i].trie.find_less_bytes(key, out_key, out_value)) return true;
+        while (i-- > 0) {
+            if (shards_[i].trie.find_last_bytes(out_key, out_value)) return true;
+        }
+        return false;
+    }
+};
+
+// =============================================================================
+// TYPE ALIASES
+// =============================================================================
+
+template <typename T, size_t SHARDS = 16, typename Allocator = std::allocator<uint64_t>>
+using sharded_string_trie = sharded_tktrie<std::string, T, SHARDS, true, Allocator>;
+
+template <typename T, size_t SHARDS = 16, typename Allocator = std::allocator<uint64_t>>
+using sharded_int32_trie = sharded_tktrie<int32_t, T, SHARDS, true, Allocator>;
+
+template <typename T, size_t SHARDS = 16, typename Allocator = std::allocator<uint64_t>>
+using sharded_int64_trie = sharded_tktrie<int64_t, T, SHARDS, true, Allocator>;
+
+}  // namespace gteitelbaum
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "tktrie_defines.h"
+
+namespace gteitelbaum {
+
+// =============================================================================
+// SLAB CONSTANTS
+// =============================================================================
+
+static constexpr size_t SLAB_LINE_SIZE = 64;        // Block alignment (cache line)
+static constexpr size_t SLAB_CHUNK_BYTES = 16384;   // Target chunk size per refill
+static constexpr size_t SLAB_CACHE_BATCH = 32;      // Blocks per thread cache refill/flush
+
+struct alignas(SLAB_LINE_SIZE) slab_line {
+    unsigned char bytes[SLAB_LINE_SIZE];
+};
+
+struct slab_free_block { slab_free_block* next; };
+
+// =============================================================================
+// SLAB_DEPOT - the chunks and shared free list of one block size
+// =============================================================================
+// Chunks are obtained from the rebound Allocator and carved by pointer bump.
+// Freed blocks go onto an intrusive free list and are handed out first.
+// The first line of each chunk holds the chunk header (chunk list link).
+//
+// The stamp names the depot's current set of chunks: it is drawn from a
+// global counter, so it is never reused, and release() draws a new one.
+// Thread caches key their blocks by stamp and drop blocks of a stale one.
+
+template <typename Allocator, bool THREADED>
+class slab_depot {
+    using line_alloc_t = typename std::allocator_traits<Allocator>::template rebind_alloc<slab_line>;
+    using line_alloc_traits = std::allocator_traits<line_alloc_t>;
+    using mutex_t = std::conditional_t<THREADED, std::mutex, empty_mutex>;
+
+    struct chunk_header { chunk_header* next; size_t lines; };
+
+    slab_free_block* free_ = nullptr;
+    slab_line* bump_ = nullptr;
+    slab_line* bump_end_ = nullptr;
+    chunk_header* chunks_ = nullptr;
+    size_t block_lines_;
+    std::atomic<uint64_t> stamp_;
+    mutex_t mutex_;
+    [[no_unique_address]] line_alloc_t alloc_;
+
+    static uint64_t next_stamp() noexcept {
+        static std::atomic<uint64_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    void grow() {
+        size_t blocks = SLAB_CHUNK_BYTES / (block_lines_ * SLAB_LINE_SIZE);
+        if (blocks == 0) blocks = 1;
+        size_t lines = 1 + blocks * block_lines_;
+        slab_line* mem = line_alloc_traits::allocate(alloc_, lines);
+        chunks_ = ::new (static_cast<void*>(mem)) chunk_header{chunks_, lines};
+        bump_ = mem + 1;
+        bump_end_ = mem + lines;
+    }
+
+    // Caller holds mutex_
+    void* pop() {
+        if (free_) {
+            slab_free_block* b = free_;
+            free_ = b->next;
+            return b;
+        }
+        if (bump_ == bump_end_) grow();
+        void* p = bump_;
+        bump_ += block_lines_;
+        return p;
+    }
+
+public:
+    slab_depot(size_t block_bytes, const Allocator& alloc)
+        : block_lines_((block_bytes + SLAB_LINE_SIZE - 1) / SLAB_LINE_SIZE),
+          stamp_(next_stamp()), alloc_(alloc) {}
+
+    ~slab_depot() { release(); }
+
+    slab_depot(const slab_depot&) = delete;
+    slab_depot& operator=(const slab_depot&) = delete;
+
+    uint64_t stamp() const noexcept { return stamp_.load(std::memory_order_acquire); }
+    Allocator get_allocator() const { return Allocator(alloc_); }
+
+    void* allocate() {
+        std::lock_guard<mutex_t> lock(mutex_);
+        return pop();
+    }
+
+    void deallocate(void* p) noexcept {
+        std::lock_guard<mutex_t> lock(mutex_);
+        free_ = ::new (p) slab_free_block{free_};
+    }
+
+    // Up to N blocks as a list, at least one (throws if none can be had)
+    slab_free_block* take(size_t n, size_t& count) {
+        std::lock_guard<mutex_t> lock(mutex_);
+        slab_free_block* head = nullptr;
+        for (count = 0; count < n; ++count) {
+            void* p;
+            try {
+                p = pop();
+            } catch (...) {
+                if (count == 0) throw;
+                break;
+            }
+            head = ::new (p) slab_free_block{head};
+        }
+        return head;
+    }
+
+    // Takes back LIST from a cache filled under STAMP. A list from before the
+    // last release() lies in freed chunks, so it is dropped without a look.
+    void put(uint64_t stamp, slab_free_block* list) noexcept {
+        std::lock_guard<mutex_t> lock(mutex_);
+        if (stamp != stamp_.load(std::memory_order_relaxed)) return;
+        slab_free_block* last = list;
+        while (last->next) last = last->next;
+        last->next = free_;
+        free_ = list;
+    }
+
+    // Returns every chunk to the allocator. Caller guarantees no live blocks.
+    void release() noexcept {
+        std::lock_guard<mutex_t> lock(mutex_);
+        while (chunks_) {
+            chunk_header* c = chunks_;
+            chunks_ = c->next;
+            line_alloc_traits::deallocate(alloc_, reinterpret_cast<slab_line*>(c), c->lines);
+        }
+        free_ = nullptr;
+        bump_ = bump_end_ = nullptr;
+        stamp_.store(next_stamp(), std::memory_order_release);
+    }
+};
+
+// =============================================================================
+// SLAB_THREAD_CACHE - per-thread block lists in front of THREADED depots
+// =============================================================================
+// Direct-mapped by depot stamp. An entry holds a few blocks of one depot and
+// a shared_ptr to it, so a thread that outlives the trie can still flush its
+// entries (which the depot drops once released). Allocation refills a whole
+// batch from the depot under its mutex; deallocation pushes locally and
+// flushes a batch back once two have gathered, so blocks freed by one thread
+// (the reclaimer, say) return to the others.
+
+template <typename Depot>
+class slab_thread_cache {
+    static constexpr size_t WAYS = 32;  // Room for each node type of a few tries
+
+    struct entry {
+        uint64_t stamp = 0;
+        std::shared_ptr<Depot> depot;
+        slab_free_block* head = nullptr;
+        size_t count = 0;
+    };
+    std::array<entry, WAYS> entries_{};
+
+    // Returns all but KEEP of E's blocks to its depot. KEEP > 0 walks the
+    // list, so only for an entry whose depot is in use (not released).
+    static void flush(entry& e, size_t keep) noexcept {
+        if (e.count <= keep) return;
+        slab_free_block** link = &e.head;
+        for (size_t i = 0; i < keep; ++i) link = &(*link)->next;
+        slab_free_block* list = *link;
+        *link = nullptr;
+        e.count = keep;
+        e.depot->put(e.stamp, list);
+    }
+
+    entry& lookup(const std::shared_ptr<Depot>& d) noexcept {
+        uint64_t stamp = d->stamp();
+        entry& e = entries_[stamp % WAYS];
+        if (e.stamp == stamp) [[likely]] return e;
+        if (e.depot) flush(e, 0);
+        e.stamp = stamp;
+        e.depot = d;
+        e.head = nullptr;
+        e.count = 0;
+        return e;
+    }
+
+public:
+    slab_thread_cache() = default;
+    slab_thread_cache(const slab_thread_cache&) = delete;
+    slab_thread_cache& operator=(const slab_thread_cache&) = delete;
+
+    ~slab_thread_cache() {
+        for (entry& e : entries_) {
+            if (e.depot) flush(e, 0);
+        }
+    }
+
+    static slab_thread_cache& local() noexcept {
+        thread_local slab_thread_cache cache;
+        return cache;
+    }
+
+    void* allocate(const std::shared_ptr<Depot>& d) {
+        entry& e = lookup(d);
+        if (!e.head) e.head = d->take(SLAB_CACHE_BATCH, e.count);
+        slab_free_block* b = e.head;
+        e.head = b->next;
+        --e.count;
+        return b;
+    }
+
+    void deallocate(const std::shared_ptr<Depot>& d, void* p) noexcept {
+        entry& e = lookup(d);
+        e.head = ::new (p) slab_free_block{e.head};
+        if (++e.count >= 2 * SLAB_CACHE_BATCH) flush(e, SLAB_CACHE_BATCH);
+    }
+};
+
+// =============================================================================
+// SLAB_CLASS - pool of fixed-size, cache-line-aligned blocks
+// =============================================================================
+// Owns one depot. THREADED pools go through the calling thread's cache, so
+// the depot mutex is taken once per batch rather than once per block.
+
+template <typename Allocator, bool THREADED>
+class slab_class {
+    using depot_t = slab_depot<Allocator, THREADED>;
+    using cache_t = slab_thread_cache<depot_t>;
+
+    std::shared_ptr<depot_t> depot_;
+
+public:
+    slab_class(size_t block_bytes, const Allocator& alloc)
+        : depot_(std::make_shared<depot_t>(block_bytes, alloc)) {}
+
+    // Thread caches may keep the depot itself alive, but not its chunks
+    ~slab_class() { release(); }
+
+    slab_class(const slab_class&) = delete;
+    slab_class& operator=(const slab_class&) = delete;
+
+    Allocator get_allocator() const { return depot_->get_allocator(); }
+
+    void* allocate() {
+        if constexpr (THREADED) {
+            return cache_t::local().allocate(depot_);
+        } else {
+            return depot_->allocate();
+        }
+    }
+
+    void deallocate(void* p) noexcept {
+        if constexpr (THREADED) {
+            cache_t::local().deallocate(depot_, p);
+        } else {
+            depot_->deallocate(p);
+        }
+    }
+
+    // Returns every chunk to the allocator. Caller guarantees no live blocks;
+    // blocks still held by thread caches are dropped, not reused.
+    void release() noexcept { depot_->release(); }
+
+    // Exchange pools (block sizes are identical). Not thread-safe.
+    void swap(slab_class& o) noexcept { depot_.swap(o.depot_); }
+};
+
+}  // namespace gteitelbaum